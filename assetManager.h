@@ -2,6 +2,7 @@
 #include "robot.h"
 #include "ship.h"
 #include "goods.h"
+#include "goodsStore.h"
 #include "map.h"
 #include "berth.h"
 #include "params.h"
@@ -46,7 +47,7 @@ public:
     // 暴露给外部的接口
     // 判断是否要进行购买，购买多少
     virtual std::vector<PurchaseDecision> makePurchaseDecision(const Map &gameMap,
-                                                               const std::vector<Goods> &goods,
+                                                               const GoodsStore &goods,
                                                                const std::vector<Robot> &robots,
                                                                const std::vector<Ship> &ships,
                                                                const std::vector<Berth> &berths,
@@ -0,0 +1,162 @@
+#include "auctionRobotScheduler.h"
+#include <algorithm>
+#include <unordered_map>
+
+AuctionRobotScheduler::AuctionRobotScheduler(std::vector<std::vector<Berth>> &_clusters, std::vector<int> &_berthCluster)
+    : GreedyRobotScheduler(_clusters, _berthCluster)
+{
+}
+
+void AuctionRobotScheduler::setParameter(const Params &params)
+{
+    GreedyRobotScheduler::setParameter(params);
+    AuctionCandidateNum = params.AuctionCandidateNum;
+    AuctionEpsilon = params.AuctionEpsilon;
+    AuctionPriceDecay = params.AuctionPriceDecay;
+    AuctionMaxBids = params.AuctionMaxBids;
+}
+
+void AuctionRobotScheduler::scheduleRobots(const Map &map,
+                                           std::vector<Robot> &robots,
+                                           GoodsStore &goods,
+                                           std::vector<Berth> &berths,
+                                           const int currentFrame)
+{
+    prepareScheduling(map, robots, goods, berths, currentFrame);
+
+    // 上一帧的价格衰减后作为本帧初值
+    if (goodsPrice.size() < goods.size())
+        goodsPrice.resize(goods.size(), 0);
+    for (GoodsID id : goods.availableGoods())
+        goodsPrice[id] *= AuctionPriceDecay;
+
+    // 收集需要取货的机器人并生成候选货物
+    std::vector<int> bidders;
+    std::vector<std::vector<Bid>> candidates;
+    for (Robot &robot : robots)
+    {
+        if (robot.status == DEATH)
+            continue;
+        if (shouldFetchGoods(robot))
+        {
+            bidders.push_back(robot.id);
+            candidates.push_back(buildCandidates(map, robot, goods, berths));
+        }
+        else if (shouldMoveToBerth(robot))
+        {
+            findBerthForRobot(robot, goods, berths, map);
+        }
+    }
+    if (bidders.empty())
+        return;
+
+    std::vector<GoodsID> result = runAuction(candidates);
+    for (int i = 0; i < bidders.size(); ++i)
+    {
+        Robot &robot = robots[bidders[i]];
+        if (result[i] != -1)
+        {
+            assignGoodToRobot(robot, goods[result[i]], goods);
+        }
+    }
+    // 拍卖未分配到的机器人（候选之外或出价次数用完）退回到贪心选择
+    for (int i = 0; i < bidders.size() && !FrameDeadline::instance().expired(DeadlineStage::ROBOT_SCHEDULE); ++i)
+        if (result[i] == -1)
+            findGoodsForRobot(map, robots[bidders[i]], goods, berths, currentFrame);
+}
+
+std::vector<AuctionRobotScheduler::Bid>
+AuctionRobotScheduler::buildCandidates(const Map &map,
+                                       const Robot &robot,
+                                       GoodsStore &goods,
+                                       const std::vector<Berth> &berths)
+{
+    FrameVector<std::reference_wrapper<Goods>> availableGoods = getAvailableGoods(goods, robot);
+    FrameVector<int> cost_robot2good = Cost_RobotToGood(robot, availableGoods, berths, map);
+    FrameVector<int> cost_good2berth = Cost_GoodToBerth(availableGoods, goods);
+    FrameVector<float> profits = getProfits(availableGoods, goods, cost_robot2good, cost_good2berth);
+
+    // 与贪心调度相同的可行性条件
+    std::vector<Bid> bids;
+    for (int j = 0; j < availableGoods.size(); ++j)
+    {
+        if (profits[j] <= 0)
+            continue;
+        const Goods &good = availableGoods[j].get();
+        long long timeToBerths = cost_good2berth[j];
+        if (assignedBerthID != -1)
+            timeToBerths = map.berthDistanceMap.get(assignedBerthID, good.pos.x, good.pos.y);
+        if (timeToBerths == INT_MAX || cost_robot2good[j] == INT_MAX)
+            continue;
+        if (isPartitionScheduled(robot) && berthCluster->at(good.distsToBerths[0].first) != assignment[robot.id])
+            continue;
+        if (good.status != 0 || goods.ttl(good.id) + 10 < cost_robot2good[j])
+            continue;
+        bids.push_back({good.id, profits[j]});
+    }
+
+    // 只保留收益最高的若干个候选，控制拍卖规模
+    auto moreProfit = [](const Bid &a, const Bid &b)
+    { return a.profit > b.profit; };
+    if (bids.size() > AuctionCandidateNum)
+    {
+        std::nth_element(bids.begin(), bids.begin() + AuctionCandidateNum, bids.end(), moreProfit);
+        bids.resize(AuctionCandidateNum);
+    }
+    return bids;
+}
+
+std::vector<GoodsID> AuctionRobotScheduler::runAuction(const std::vector<std::vector<Bid>> &candidates)
+{
+    // 正向拍卖：未分配的机器人对净收益（收益 - 价格）最高的货物出价，
+    // 加价幅度为最优与次优净收益之差加 eps，被抢走货物的机器人重新加入队列
+    // 每个机器人都有一个收益为 0 的虚拟选项，净收益不为正时放弃分配
+    std::vector<GoodsID> result(candidates.size(), -1);
+    std::unordered_map<GoodsID, int> owner;
+    std::vector<int> unassigned;
+    for (int i = candidates.size() - 1; i >= 0; --i)
+        if (!candidates[i].empty())
+            unassigned.push_back(i);
+
+    int bidCount = 0;
+    // 超时后停止出价，已有的分配作为结果
+    const FrameDeadline &deadline = FrameDeadline::instance();
+    while (!unassigned.empty() && bidCount < AuctionMaxBids && !deadline.expired(DeadlineStage::ROBOT_SCHEDULE))
+    {
+        int bidder = unassigned.back();
+        unassigned.pop_back();
+
+        GoodsID best = -1;
+        float bestValue = 0, secondValue = 0; // 虚拟选项的净收益为 0
+        for (const Bid &bid : candidates[bidder])
+        {
+            float value = bid.profit - goodsPrice[bid.goodsId];
+            if (value > bestValue)
+            {
+                secondValue = bestValue;
+                bestValue = value;
+                best = bid.goodsId;
+            }
+            else if (value > secondValue)
+                secondValue = value;
+        }
+        if (best == -1)
+            continue;
+
+        ++bidCount;
+        goodsPrice[best] += bestValue - secondValue + AuctionEpsilon;
+        auto it = owner.find(best);
+        if (it != owner.end())
+        {
+            result[it->second] = -1;
+            unassigned.push_back(it->second);
+            it->second = bidder;
+        }
+        else
+            owner.emplace(best, bidder);
+        result[bidder] = best;
+    }
+    if (!unassigned.empty())
+        LOGI("拍卖达到出价上限或超时，未分配机器人数：", unassigned.size());
+    return result;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "greedyRobotScheduler.h"
+
+// 批量拍卖调度：每帧把所有需要取货的机器人和候选货物放在一起求解指派，
+// 避免按机器人顺序贪心时前面的机器人抢走后面机器人更近的货物
+// 货物价格跨帧保留并衰减，作为下一帧拍卖的热启动
+class AuctionRobotScheduler : public GreedyRobotScheduler
+{
+public:
+    void scheduleRobots(const Map &map,
+                        std::vector<Robot> &robots,
+                        GoodsStore &goods,
+                        std::vector<Berth> &berths,
+                        const int currentFrame) override;
+    void setParameter(const Params &params) override;
+    SchedulerName getSchedulerName() override
+    {
+        return SchedulerName::Auction_ROBOT_SCHEDULER;
+    }
+
+    AuctionRobotScheduler(std::vector<std::vector<Berth>> &_clusters, std::vector<int> &_berthCluster);
+
+private:
+    // 机器人的一个候选货物
+    struct Bid
+    {
+        GoodsID goodsId;
+        float profit;
+    };
+
+    int AuctionCandidateNum;  // 每个机器人保留的候选货物数
+    float AuctionEpsilon;     // 每次出价的最小加价
+    float AuctionPriceDecay;  // 货物价格每帧的衰减系数
+    int AuctionMaxBids;       // 每帧最多出价次数
+
+    std::vector<float> goodsPrice; // 货物价格，下标为货物 ID
+
+private:
+    // 为机器人生成候选货物，按收益取前 AuctionCandidateNum 个
+    std::vector<Bid> buildCandidates(const Map &map,
+                                     const Robot &robot,
+                                     GoodsStore &goods,
+                                     const std::vector<Berth> &berths);
+    // 求解指派，返回每个机器人分配到的货物，-1 表示未分配
+    std::vector<GoodsID> runAuction(const std::vector<std::vector<Bid>> &candidates);
+};
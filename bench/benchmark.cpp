@@ -0,0 +1,213 @@
+// 离线基准测试：不经过判题器，在进程内用内存输入逐帧驱动 GameManager
+// benchmark game <map> [frames] [seed]          整局回放，输出帧耗时、各阶段耗时、内存分配次数和得分
+// benchmark micro <map> [seed] [warmupFrames]   先回放若干帧得到真实局面，再对寻路、BFS 和冲突检测做微基准
+// benchmark artifact <map> <dir>               离线生成预计算快照，并对比计算和读取快照的耗时
+// benchmark tune <map> <space> [candidates] [frames] [jobs] [output]   并行搜索参数，见 parameterTuner.h
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include "../gameManager.h"
+#include "../pathFinder.h"
+#include "../profiler.h"
+#include "../frameArena.h"
+#include "../mapArtifacts.h"
+#include "replay.h"
+#include "parameterTuner.h"
+
+// 统计全局 operator new 的调用次数，工作线程中的分配也计入
+static std::atomic<uint64_t> allocationCount{0};
+
+void *operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void *operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+uint64_t allocationTotal() { return allocationCount.load(std::memory_order_relaxed); }
+
+using Clock = Replay::Clock;
+
+static void printHistogram(const char *name, const MicrosHistogram &h)
+{
+    std::printf("%-18s p50=%u p99=%u max=%u mean=%.1f\n", name, h.percentile(0.5), h.percentile(0.99), h.max(), h.mean());
+}
+
+static int runGame(const std::string &mapPath, int frames, unsigned seed)
+{
+    Replay replay(seed);
+    if (!replay.initialize(mapPath))
+        return 1;
+    auto start = Clock::now();
+    for (int frame = 1; frame <= frames; ++frame)
+        replay.step(frame);
+    double wall = Replay::microsSince(start) / 1e6;
+
+    std::printf("map=%s frames=%d seed=%u\n", mapPath.c_str(), frames, seed);
+    std::printf("init: %.1f ms, %llu allocations\n", replay.initMicros / 1e3, static_cast<unsigned long long>(replay.initAllocations));
+    printHistogram("frame (us)", replay.frameMicros);
+    printHistogram("allocations", replay.frameAllocations);
+    std::printf("total allocations=%llu, frames over budget=%d, wall=%.2f s\n",
+                static_cast<unsigned long long>(replay.totalAllocations), replay.overBudgetFrames, wall);
+#ifdef DEBUG
+    std::printf("%s", FrameProfiler::instance().report().c_str());
+#endif
+    std::printf("score=%d money=%d robots=%d ships=%d\n", replay.judge.getScore(), replay.judge.getMoney(),
+                replay.judge.robotNum(), replay.judge.shipNum());
+    return 0;
+}
+
+// 重复运行 body，输出每次的平均耗时和平均分配次数
+template <typename Body>
+static void measure(const char *name, int iterations, Body body)
+{
+    uint64_t allocBegin = allocationTotal();
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i)
+        body(i);
+    double micros = static_cast<double>(Replay::microsSince(start));
+    std::printf("%-32s %8d runs %10.2f us/run %8.2f allocs/run\n", name, iterations, micros / iterations,
+                static_cast<double>(allocationTotal() - allocBegin) / iterations);
+}
+
+template <typename Finder>
+static void measurePathfinder(const char *name, const Map &map, const std::vector<std::pair<Point2d, Point2d>> &queries)
+{
+    Finder finder;
+    int found = 0;
+    measure(name, static_cast<int>(queries.size()), [&](int i)
+            { found += std::holds_alternative<Path<Point2d>>(finder.findPath(queries[i].first, queries[i].second, map)); });
+    std::printf("%-32s found %d/%zu\n", "", found, queries.size());
+}
+
+static int runMicro(const std::string &mapPath, unsigned seed, int warmupFrames)
+{
+    Replay replay(seed);
+    if (!replay.initialize(mapPath))
+        return 1;
+    for (int frame = 1; frame <= warmupFrames; ++frame)
+        replay.step(frame);
+    GameManager &game = replay.game;
+    Map &map = game.gameMap;
+    std::printf("map=%s seed=%u warmup=%d robots=%zu ships=%zu\n", mapPath.c_str(), seed, warmupFrames,
+                game.robots.size(), game.ships.size());
+
+    // 冲突检测依赖上一帧留下的机器人 nextPos 和临时障碍，先测
+    measure("detectNextFrameConflict", 2000, [&](int)
+            {
+                FrameArena::beginFrame();
+                auto events = game.robotController->detectNextFrameConflict(map, game.singleLaneManager);
+                (void)events; });
+    map.clearTemporaryObstacles();
+
+    std::mt19937 rng(seed);
+    std::vector<Point2d> land;
+    for (int i = 0; i < MAPROWS; ++i)
+        for (int j = 0; j < MAPCOLS; ++j)
+            if (map.passable(Point2d(i, j)))
+                land.emplace_back(i, j);
+    if (land.empty())
+    {
+        std::printf("地图没有陆地，跳过寻路和 BFS\n");
+        return 0;
+    }
+    std::uniform_int_distribution<size_t> pick(0, land.size() - 1);
+    std::vector<std::pair<Point2d, Point2d>> queries;
+    for (int i = 0; i < 300; ++i)
+        queries.emplace_back(land[pick(rng)], land[pick(rng)]);
+
+    measurePathfinder<AStarPathfinder<Point2d, Map>>("AStarPathfinder", map, queries);
+    measurePathfinder<GridAStarPathfinder<Point2d, Map>>("GridAStarPathfinder<DaryHeap>", map, queries);
+    measurePathfinder<GridAStarPathfinder<Point2d, Map, BucketQueue>>("GridAStarPathfinder<Bucket>", map, queries);
+
+    std::vector<uint16_t> field(MAPROWS * MAPCOLS);
+    std::vector<int> queue;
+    measure("computeLandDistanceField", 500, [&](int i)
+            { map.computeLandDistanceField(queries[i % queries.size()].first, field.data(), queue); });
+
+    // 与初始化相同的泊位区域，重算结果不变
+    std::vector<std::pair<BerthID, std::vector<Point2d>>> berthAreas;
+    for (const Berth &berth : game.berths)
+    {
+        std::vector<Point2d> positions;
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                positions.push_back(berth.pos + Point2d(i, j));
+        berthAreas.emplace_back(berth.id, std::move(positions));
+    }
+    if (!berthAreas.empty())
+        measure("computeAllBerthDistanceFields", 20, [&](int)
+                { map.computeAllBerthDistanceFields(berthAreas); });
+    return 0;
+}
+
+static int runArtifact(const std::string &mapPath, const std::string &directory)
+{
+    Replay replay(1);
+    if (!replay.load(mapPath))
+        return 1;
+    MapArtifactStore store(directory);
+    const uint64_t hash = MapArtifactStore::mapHash(replay.game.gameMap, replay.game.berths);
+    if (!store.save(hash, replay.game.gameMap))
+    {
+        std::fprintf(stderr, "无法写入 %s\n", store.path(hash).c_str());
+        return 1;
+    }
+    std::printf("已写入 %s，计算耗时 %.1f ms（含读图和单行路）\n", store.path(hash).c_str(), replay.initMicros / 1e3);
+
+    // 读回校验：恢复出的距离场与计算结果逐字节一致
+    Map restored(MAPROWS, MAPCOLS);
+    restored.readOnlyGrid = replay.game.gameMap.readOnlyGrid;
+    auto start = Clock::now();
+    if (!store.load(hash, restored))
+    {
+        std::fprintf(stderr, "读取快照失败\n");
+        return 1;
+    }
+    uint64_t micros = Replay::microsSince(start);
+    const Map &computed = replay.game.gameMap;
+    bool same = restored.berthDistanceMap.size() == computed.berthDistanceMap.size() &&
+                restored.maritimeBerthDistanceMap.size() == computed.maritimeBerthDistanceMap.size() &&
+                std::equal(computed.berthDistanceMap.data(), computed.berthDistanceMap.data() + computed.berthDistanceMap.size(),
+                           restored.berthDistanceMap.data()) &&
+                std::equal(computed.maritimeBerthDistanceMap.data(),
+                           computed.maritimeBerthDistanceMap.data() + computed.maritimeBerthDistanceMap.size(),
+                           restored.maritimeBerthDistanceMap.data());
+    std::printf("读取快照耗时 %llu us，距离场%s\n", static_cast<unsigned long long>(micros), same ? "一致" : "不一致");
+    return same ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr, "usage: %s game <map> [frames] [seed]\n       %s micro <map> [seed] [warmupFrames]\n"
+                             "       %s artifact <map> <dir>\n"
+                             "       %s tune <map> <space> [candidates] [frames] [jobs] [output]\n",
+                     argv[0], argv[0], argv[0], argv[0]);
+        return 1;
+    }
+    const std::string mode = argv[1], mapPath = argv[2];
+    if (mode == "game")
+        return runGame(mapPath, argc > 3 ? std::atoi(argv[3]) : 15000, argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 1);
+    if (mode == "micro")
+        return runMicro(mapPath, argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1, argc > 4 ? std::atoi(argv[4]) : 1000);
+    if (mode == "artifact" && argc > 3)
+        return runArtifact(mapPath, argv[3]);
+    if (mode == "tune" && argc > 3)
+        return runTuner(argc, argv);
+    std::fprintf(stderr, "未知模式 %s\n", mode.c_str());
+    return 1;
+}
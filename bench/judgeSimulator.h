@@ -0,0 +1,355 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <array>
+#include <random>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <deque>
+#include <algorithm>
+#include <string_view>
+
+// 离线判题器：按随机种子确定性地生成货物，执行选手程序输出的指令并计分
+// 只模拟与得分相关的规则（购买、移动、取放货、船舶移动和装卸、交货），不模拟碰撞惩罚和恢复状态
+class JudgeSimulator
+{
+public:
+    static constexpr int N = 200;
+    static constexpr int ROBOT_PRICE = 2000;
+    static constexpr int SHIP_PRICE = 8000;
+    static constexpr int GOODS_LIFETIME = 1000;
+
+    JudgeSimulator(unsigned seed, int shipCapacity = 60) : rng(seed), goodsRng(seed), capacity(shipCapacity) {}
+
+    // 重新设置货物生成的种子，地图和泊位装载速度不变，用于同一张地图上的多局对比
+    void reseedGoods(unsigned seed) { goodsRng.seed(seed); }
+
+    // 读取地图文件的前 200 行，行数或列数不足时用障碍补齐
+    bool loadMap(const std::string &path)
+    {
+        std::ifstream file(path);
+        if (!file)
+            return false;
+        std::string line;
+        while (grid.size() < N && std::getline(file, line))
+        {
+            while (!line.empty() && (line.back() == '\r' || line.back() == '\n'))
+                line.pop_back();
+            if (line.empty())
+                continue;
+            line.resize(N, '#');
+            grid.push_back(line);
+        }
+        grid.resize(N, std::string(N, '#'));
+        findBerths();
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                if (grid[i][j] == '.')
+                    spawnCells.push_back(i * N + j);
+        return true;
+    }
+
+    // 初始化输入：地图、泊位、船舶容量
+    std::string initInput()
+    {
+        std::ostringstream oss;
+        for (const std::string &row : grid)
+            oss << row << "\n";
+        oss << berths.size() << "\n";
+        for (size_t k = 0; k < berths.size(); ++k)
+            oss << k << " " << berths[k].x << " " << berths[k].y << " " << berths[k].velocity << "\n";
+        oss << capacity << "\nOK\n";
+        return oss.str();
+    }
+
+    // 生成第 frame 帧的货物并返回该帧输入
+    std::string frameInput(int frame)
+    {
+        std::vector<std::array<int, 3>> spawned;
+        if (!spawnCells.empty())
+        {
+            int num = std::uniform_int_distribution<int>(0, 2)(goodsRng);
+            for (int i = 0; i < num; ++i)
+            {
+                int cell = spawnCells[std::uniform_int_distribution<size_t>(0, spawnCells.size() - 1)(goodsRng)];
+                if (goods.count(cell))
+                    continue;
+                int value = std::uniform_int_distribution<int>(10, 180)(goodsRng);
+                goods[cell] = {value, frame};
+                spawned.push_back({cell / N, cell % N, value});
+            }
+        }
+        for (auto it = goods.begin(); it != goods.end();)
+            it = frame - it->second.second >= GOODS_LIFETIME ? goods.erase(it) : std::next(it);
+
+        std::ostringstream oss;
+        oss << frame << " " << money << "\n" << spawned.size() << "\n";
+        for (const auto &g : spawned)
+            oss << g[0] << " " << g[1] << " " << g[2] << "\n";
+        oss << robots.size() << "\n";
+        for (size_t k = 0; k < robots.size(); ++k)
+            oss << k << " " << robots[k].carrying << " " << robots[k].x << " " << robots[k].y << "\n";
+        oss << ships.size() << "\n";
+        for (size_t k = 0; k < ships.size(); ++k)
+            oss << k << " " << ships[k].cargo.size() << " " << ships[k].x << " " << ships[k].y << " "
+                << ships[k].dir << " " << ships[k].state << "\n";
+        oss << "OK\n";
+        return oss.str();
+    }
+
+    // 执行一帧的输出（不含 OK），随后结算泊位装货和交货
+    void applyCommands(const std::string &output)
+    {
+        std::istringstream iss(output);
+        std::string cmd;
+        std::vector<int> occupied;
+        for (const Robot &r : robots)
+            occupied.push_back(r.x * N + r.y);
+        while (iss >> cmd && cmd != "OK")
+        {
+            if (cmd == "lbot")
+            {
+                int x, y, type;
+                iss >> x >> y >> type;
+                if (money >= ROBOT_PRICE)
+                    robots.push_back({x, y}), money -= ROBOT_PRICE;
+            }
+            else if (cmd == "lboat")
+            {
+                int x, y;
+                iss >> x >> y;
+                if (money >= SHIP_PRICE)
+                    ships.push_back({x, y}), money -= SHIP_PRICE;
+            }
+            else if (cmd == "move")
+            {
+                int id, d;
+                iss >> id >> d;
+                if (!validRobot(id) || d < 0 || d > 3)
+                    continue;
+                Robot &r = robots[id];
+                int nx = r.x + ROBOT_DIRS[d][0], ny = r.y + ROBOT_DIRS[d][1];
+                if (!inside(nx, ny) || !isLand(grid[nx][ny]))
+                    continue;
+                auto occ = std::find(occupied.begin(), occupied.end(), nx * N + ny);
+                if (occ != occupied.end() && !isMainRoad(grid[nx][ny]))
+                    continue;
+                auto self = std::find(occupied.begin(), occupied.end(), r.x * N + r.y);
+                if (self != occupied.end())
+                    *self = nx * N + ny;
+                r.x = nx, r.y = ny;
+            }
+            else if (cmd == "get")
+            {
+                int id;
+                iss >> id;
+                if (!validRobot(id))
+                    continue;
+                Robot &r = robots[id];
+                auto it = goods.find(r.x * N + r.y);
+                if (r.carrying == 0 && it != goods.end())
+                {
+                    r.value = it->second.first;
+                    r.carrying = 1;
+                    goods.erase(it);
+                }
+            }
+            else if (cmd == "pull")
+            {
+                int id;
+                iss >> id;
+                if (!validRobot(id))
+                    continue;
+                Robot &r = robots[id];
+                int berth = berthOf[r.x * N + r.y];
+                if (r.carrying == 1 && berth >= 0)
+                {
+                    berths[berth].stock.push_back(r.value);
+                    r.carrying = 0;
+                    r.value = 0;
+                }
+            }
+            else if (cmd == "ship")
+            {
+                int id;
+                iss >> id;
+                if (!validShip(id))
+                    continue;
+                Ship &s = ships[id];
+                int nx = s.x + SHIP_FORWARD[s.dir][0], ny = s.y + SHIP_FORWARD[s.dir][1];
+                if (shipFits(nx, ny, s.dir))
+                    s.x = nx, s.y = ny, s.state = 0;
+            }
+            else if (cmd == "rot")
+            {
+                int id, clockwise;
+                iss >> id >> clockwise;
+                if (!validShip(id))
+                    continue;
+                Ship &s = ships[id];
+                const auto &rot = clockwise == 0 ? SHIP_CW[s.dir] : SHIP_ACW[s.dir];
+                int nx = s.x + rot[1], ny = s.y + rot[2];
+                if (shipFits(nx, ny, rot[0]))
+                    s.x = nx, s.y = ny, s.dir = rot[0], s.state = 0;
+            }
+            else if (cmd == "berth")
+            {
+                int id;
+                iss >> id;
+                if (!validShip(id))
+                    continue;
+                Ship &s = ships[id];
+                for (size_t b = 0; b < berths.size(); ++b)
+                    if (std::abs(berths[b].x - s.x) + std::abs(berths[b].y - s.y) <= 4)
+                    {
+                        s.x = berths[b].x, s.y = berths[b].y, s.state = 2, s.berth = static_cast<int>(b);
+                        break;
+                    }
+            }
+            else if (cmd == "dept")
+            {
+                int id;
+                iss >> id;
+                if (validShip(id))
+                    ships[id].state = 0, ships[id].berth = -1;
+            }
+        }
+
+        for (Ship &s : ships)
+        {
+            if (s.state == 2 && s.berth >= 0)
+            {
+                Berth &b = berths[s.berth];
+                for (int i = 0; i < b.velocity && !b.stock.empty() && static_cast<int>(s.cargo.size()) < capacity; ++i)
+                {
+                    s.cargo.push_back(b.stock.front());
+                    b.stock.pop_front();
+                }
+            }
+            if (!s.cargo.empty() && s.state == 0 && touchesDelivery(s))
+            {
+                for (int value : s.cargo)
+                    money += value, score += value;
+                s.cargo.clear();
+            }
+        }
+    }
+
+    // 复赛规则需要机器人购买点、船舶购买点、交货点和泊位，初赛地图没有这些格子
+    bool playable() const
+    {
+        auto has = [this](char c)
+        { return std::any_of(grid.begin(), grid.end(), [c](const std::string &row)
+                             { return row.find(c) != std::string::npos; }); };
+        return has('R') && has('S') && has('T') && !berths.empty();
+    }
+
+    inline int getScore() const { return score; }
+    inline int getMoney() const { return money; }
+    inline int robotNum() const { return static_cast<int>(robots.size()); }
+    inline int shipNum() const { return static_cast<int>(ships.size()); }
+    inline const std::vector<std::string> &getGrid() const { return grid; }
+
+private:
+    struct Robot
+    {
+        int x, y;
+        int carrying = 0, value = 0;
+    };
+    struct Ship
+    {
+        int x, y;
+        int dir = 0, state = 0, berth = -1;
+        std::vector<int> cargo;
+    };
+    struct Berth
+    {
+        int x, y, velocity;
+        std::deque<int> stock;
+    };
+
+    // 与判题器一致的方向：0 右、1 左、2 上、3 下
+    static constexpr int ROBOT_DIRS[4][2] = {{0, 1}, {0, -1}, {-1, 0}, {1, 0}};
+    static constexpr int SHIP_FORWARD[4][2] = {{0, 1}, {0, -1}, {-1, 0}, {1, 0}};
+    // 旋转后的方向和核心点偏移
+    static constexpr int SHIP_CW[4][3] = {{3, 0, 2}, {2, 0, -2}, {0, -2, 0}, {1, 2, 0}};
+    static constexpr int SHIP_ACW[4][3] = {{2, 1, 1}, {3, -1, -1}, {1, -1, 1}, {0, 1, -1}};
+    // 船体 2x3 相对核心点的范围 {dx0, dy0, dx1, dy1}
+    static constexpr int SHIP_FOOT[4][4] = {{0, 0, 1, 2}, {-1, -2, 0, 0}, {-2, 0, 0, 1}, {0, -1, 2, 0}};
+
+    static inline bool inside(int x, int y) { return x >= 0 && x < N && y >= 0 && y < N; }
+    static inline bool isLand(char c) { return std::string_view(".>RBCc").find(c) != std::string_view::npos; }
+    static inline bool isSea(char c) { return std::string_view("*~SBKCcT").find(c) != std::string_view::npos; }
+    static inline bool isMainRoad(char c) { return std::string_view(">RBc").find(c) != std::string_view::npos; }
+    inline bool validRobot(int id) const { return id >= 0 && id < static_cast<int>(robots.size()); }
+    inline bool validShip(int id) const { return id >= 0 && id < static_cast<int>(ships.size()); }
+
+    bool shipFits(int x, int y, int dir) const
+    {
+        const int *f = SHIP_FOOT[dir];
+        for (int i = x + f[0]; i <= x + f[2]; ++i)
+            for (int j = y + f[1]; j <= y + f[3]; ++j)
+                if (!inside(i, j) || !isSea(grid[i][j]))
+                    return false;
+        return true;
+    }
+
+    bool touchesDelivery(const Ship &s) const
+    {
+        const int *f = SHIP_FOOT[s.dir];
+        for (int i = s.x + f[0]; i <= s.x + f[2]; ++i)
+            for (int j = s.y + f[1]; j <= s.y + f[3]; ++j)
+                if (inside(i, j) && grid[i][j] == 'T')
+                    return true;
+        return false;
+    }
+
+    // 泊位为 'B' 的四连通块，核心点取块内字典序最小的格子，装载速度随机
+    void findBerths()
+    {
+        berthOf.assign(N * N, -1);
+        std::vector<int> stack;
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+            {
+                if (grid[i][j] != 'B' || berthOf[i * N + j] >= 0)
+                    continue;
+                const int id = static_cast<int>(berths.size());
+                int corner = i * N + j;
+                berthOf[corner] = id;
+                stack.assign(1, corner);
+                while (!stack.empty())
+                {
+                    int cell = stack.back();
+                    stack.pop_back();
+                    corner = std::min(corner, cell);
+                    for (const auto &d : ROBOT_DIRS)
+                    {
+                        int nx = cell / N + d[0], ny = cell % N + d[1];
+                        if (inside(nx, ny) && grid[nx][ny] == 'B' && berthOf[nx * N + ny] < 0)
+                        {
+                            berthOf[nx * N + ny] = id;
+                            stack.push_back(nx * N + ny);
+                        }
+                    }
+                }
+                berths.push_back({corner / N, corner % N, std::uniform_int_distribution<int>(1, 5)(rng)});
+            }
+    }
+
+private:
+    std::mt19937 rng;      // 泊位装载速度
+    std::mt19937 goodsRng; // 货物生成
+    int capacity;
+    int money = 25000;
+    int score = 0;
+    std::vector<std::string> grid;
+    std::vector<int> spawnCells;
+    std::vector<int> berthOf; // 每个格子所属泊位，不是泊位为 -1
+    std::vector<Berth> berths;
+    std::vector<Robot> robots;
+    std::vector<Ship> ships;
+    std::map<int, std::pair<int, int>> goods; // 格子 -> (价值, 生成帧)
+};
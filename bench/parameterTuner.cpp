@@ -0,0 +1,270 @@
+#include "parameterTuner.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <set>
+#include <thread>
+#include <numeric>
+#include <algorithm>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+bool ParameterSpace::read(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream iss(line);
+        std::string key, value;
+        if (!(iss >> key) || key[0] == '#')
+            continue;
+        std::vector<std::string> values;
+        while (iss >> value)
+            values.push_back(value);
+        if (!values.empty())
+            dimensions.emplace_back(key, std::move(values));
+    }
+    return !dimensions.empty();
+}
+
+uint64_t ParameterSpace::combinations(uint64_t limit) const
+{
+    uint64_t total = 1;
+    for (const auto &[key, values] : dimensions)
+    {
+        if (total > limit / values.size())
+            return limit;
+        total *= values.size();
+    }
+    return std::min(total, limit);
+}
+
+bool ParameterTuner::prepare()
+{
+    space = ParameterSpace();
+    if (!space.read(options.spacePath))
+    {
+        std::fprintf(stderr, "无法读取参数空间 %s\n", options.spacePath.c_str());
+        return false;
+    }
+    base = std::make_unique<Replay>(options.seed);
+    if (!base->load(options.mapPath))
+        return false;
+    std::printf("预计算完成: %.1f ms\n", base->initMicros / 1e3);
+    return true;
+}
+
+std::vector<ParameterSet> ParameterTuner::sampleCandidates() const
+{
+    // 混合进制编号到参数组合
+    auto decode = [this](uint64_t index)
+    {
+        ParameterSet parameters;
+        for (const auto &[key, values] : space.dimensions)
+        {
+            parameters.emplace_back(key, values[index % values.size()]);
+            index /= values.size();
+        }
+        return parameters;
+    };
+    // 第一个组合是地图默认值，作为对照，与其他组合一起参与淘汰
+    std::vector<ParameterSet> result(1);
+    const uint64_t wanted = static_cast<uint64_t>(std::max(1, options.candidates));
+    const uint64_t total = space.combinations(UINT64_MAX);
+    if (total <= wanted)
+    {
+        for (uint64_t i = 0; i < total; ++i)
+            result.push_back(decode(i));
+        return result;
+    }
+    std::mt19937_64 rng(options.seed);
+    std::uniform_int_distribution<uint64_t> pick(0, total - 1);
+    std::set<uint64_t> chosen;
+    while (chosen.size() < wanted)
+        chosen.insert(pick(rng));
+    for (uint64_t index : chosen)
+        result.push_back(decode(index));
+    return result;
+}
+
+#ifndef _WIN32
+void ParameterTuner::evaluate(const std::vector<std::pair<int, int>> &games)
+{
+    struct Running
+    {
+        pid_t pid;
+        int fd;
+        int candidate, game;
+    };
+    std::vector<Running> running;
+    size_t next = 0;
+    std::fflush(stdout);
+    while (next < games.size() || !running.empty())
+    {
+        while (next < games.size() && static_cast<int>(running.size()) < options.jobs)
+        {
+            const auto [candidate, game] = games[next++];
+            int fds[2];
+            if (pipe(fds) != 0)
+            {
+                std::perror("pipe");
+                scores[candidate][game] = 0;
+                continue;
+            }
+            pid_t pid = fork();
+            if (pid == 0)
+            {
+                close(fds[0]);
+                int score = play(candidates[candidate], options.seed + game);
+                ssize_t written = write(fds[1], &score, sizeof(score));
+                _exit(written == sizeof(score) ? 0 : 1);
+            }
+            close(fds[1]);
+            if (pid < 0)
+            {
+                std::perror("fork");
+                close(fds[0]);
+                scores[candidate][game] = 0;
+                continue;
+            }
+            running.push_back({pid, fds[0], candidate, game});
+        }
+
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        auto it = std::find_if(running.begin(), running.end(), [pid](const Running &r)
+                               { return r.pid == pid; });
+        if (it == running.end())
+            continue;
+        int score = 0;
+        if (read(it->fd, &score, sizeof(score)) != sizeof(score))
+        {
+            std::fprintf(stderr, "组合 %d 第 %d 局异常退出，记 0 分\n", it->candidate, it->game);
+            score = 0;
+        }
+        close(it->fd);
+        scores[it->candidate][it->game] = score;
+        running.erase(it);
+    }
+}
+#else
+void ParameterTuner::evaluate(const std::vector<std::pair<int, int>> &games)
+{
+    // 没有 fork 时部件不能重复创建，不支持
+    for (const auto &[candidate, game] : games)
+        scores[candidate][game] = 0;
+}
+#endif
+
+int ParameterTuner::play(const ParameterSet &parameters, unsigned seed)
+{
+    base->judge.reseedGoods(seed);
+    for (const auto &[key, value] : parameters)
+        base->game.paramReader.setParam(key, value);
+    // 每局单线程运行，并行度由同时运行的局数提供
+    base->game.paramReader.setParam("ParallelFramePipeline", "0");
+    base->game.paramReader.setParam("ParallelRobotPathfinding", "0");
+    base->configure();
+    for (int frame = 1; frame <= options.frames; ++frame)
+        base->step(frame);
+    return base->judge.getScore();
+}
+
+double ParameterTuner::meanScore(int candidate, int games) const
+{
+    double total = 0;
+    for (int i = 0; i < games; ++i)
+        total += scores[candidate][i];
+    return total / games;
+}
+
+bool ParameterTuner::writeBest(const ParameterSet &parameters) const
+{
+    std::ofstream file(options.outputPath);
+    if (!file)
+        return false;
+    for (const auto &[key, value] : parameters)
+        file << key << " " << value << "\n";
+    return true;
+}
+
+int ParameterTuner::run()
+{
+#ifdef _WIN32
+    std::fprintf(stderr, "参数搜索依赖 fork，只支持 Linux\n");
+    return 1;
+#endif
+    if (!prepare())
+        return 1;
+    if (options.jobs <= 0)
+        options.jobs = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    options.eta = std::max(2, options.eta);
+    options.initialSeeds = std::max(1, options.initialSeeds);
+    options.maxSeeds = std::max(options.initialSeeds, options.maxSeeds);
+
+    candidates = sampleCandidates();
+    scores.assign(candidates.size(), std::vector<int>(options.maxSeeds, -1));
+    std::vector<int> alive(candidates.size());
+    std::iota(alive.begin(), alive.end(), 0);
+
+    auto start = Replay::Clock::now();
+    int seeds = options.initialSeeds;
+    for (int rung = 0;; ++rung)
+    {
+        std::vector<std::pair<int, int>> games;
+        for (int candidate : alive)
+            for (int game = 0; game < seeds; ++game)
+                if (scores[candidate][game] < 0)
+                    games.emplace_back(candidate, game);
+        evaluate(games);
+        std::stable_sort(alive.begin(), alive.end(), [&](int a, int b)
+                         { return meanScore(a, seeds) > meanScore(b, seeds); });
+        std::printf("第 %d 轮: %zu 组 x %d 局, 最高平均分 %.0f (组合 %d), 已用 %.1f s\n", rung, alive.size(), seeds,
+                    meanScore(alive[0], seeds), alive[0], Replay::microsSince(start) / 1e6);
+        for (size_t i = 0; i < std::min<size_t>(alive.size(), 5); ++i)
+            std::printf("  组合 %d: %.0f\n", alive[i], meanScore(alive[i], seeds));
+        if (scores[0][seeds - 1] >= 0)
+            std::printf("  默认参数平均分 %.0f\n", meanScore(0, seeds));
+        std::fflush(stdout);
+        if (alive.size() <= 1)
+            break;
+        alive.resize((alive.size() + options.eta - 1) / options.eta);
+        seeds = std::min(options.maxSeeds, seeds * options.eta);
+    }
+
+    const ParameterSet &best = candidates[alive[0]];
+    std::printf("最优组合 %d，平均分 %.0f:\n", alive[0], meanScore(alive[0], seeds));
+    for (const auto &[key, value] : best)
+        std::printf("  %s %s\n", key.c_str(), value.c_str());
+    if (!writeBest(best))
+    {
+        std::fprintf(stderr, "无法写入 %s\n", options.outputPath.c_str());
+        return 1;
+    }
+    std::printf("已写入 %s\n", options.outputPath.c_str());
+    return 0;
+}
+
+int runTuner(int argc, char **argv)
+{
+    // benchmark tune <map> <space> [candidates] [frames] [jobs] [output]
+    TunerOptions options;
+    options.mapPath = argv[2];
+    options.spacePath = argv[3];
+    if (argc > 4)
+        options.candidates = std::atoi(argv[4]);
+    if (argc > 5)
+        options.frames = std::atoi(argv[5]);
+    if (argc > 6)
+        options.jobs = std::atoi(argv[6]);
+    if (argc > 7)
+        options.outputPath = argv[7];
+    return ParameterTuner(options).run();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+#include "replay.h"
+
+// 参数空间，文件格式与 param/param_now.txt 相同，每行 "参数名 候选值1 候选值2 ..."，# 开头的行忽略
+struct ParameterSpace
+{
+    std::vector<std::pair<std::string, std::vector<std::string>>> dimensions;
+
+    bool read(const std::string &path);
+    // 所有候选值组合的数目，超过 limit 时返回 limit
+    uint64_t combinations(uint64_t limit) const;
+};
+
+// 一组参数取值，按参数名覆盖地图默认值，空表示全部使用默认值
+using ParameterSet = std::vector<std::pair<std::string, std::string>>;
+
+struct TunerOptions
+{
+    std::string mapPath;
+    std::string spacePath;
+    std::string outputPath = "param_best.txt"; // 最优参数的输出文件，可直接被 ParamReader::readParams 读取
+    int candidates = 32; // 参与评估的组合数，空间更小时全部评估
+    int frames = 15000;  // 每局帧数
+    int jobs = 0;        // 同时运行的局数，0 为核数
+    int initialSeeds = 1; // 第一轮每个组合的局数
+    int maxSeeds = 8;    // 最后一轮每个组合的局数上限
+    int eta = 2;         // 每轮保留 1/eta 的组合，局数乘以 eta
+    unsigned seed = 1;   // 抽样组合和货物生成的种子
+};
+
+// 进程内参数搜索：只读一次地图、只做一次距离场和航线预计算，之后每局在 fork 出的子进程中按候选参数创建部件并回放
+// 子进程与父进程共享预计算结果所在的内存页，局与局之间互不影响，可以用满所有核
+// 搜索采用 successive halving：所有组合先各跑少量局，按平均分保留前 1/eta，存活者再用 eta 倍的局数评估，直到只剩一个
+class ParameterTuner
+{
+public:
+    explicit ParameterTuner(const TunerOptions &options) : options(options) {}
+
+    // 运行搜索，返回进程退出码
+    int run();
+
+private:
+    // 在子进程中需要的局面：地图已加载、预计算完成、部件尚未创建
+    bool prepare();
+    std::vector<ParameterSet> sampleCandidates() const;
+    // 评估 (组合, 局号) 列表，结果写入 scores
+    void evaluate(const std::vector<std::pair<int, int>> &games);
+    // 在子进程中运行一局并返回得分
+    int play(const ParameterSet &parameters, unsigned seed);
+    double meanScore(int candidate, int games) const;
+    bool writeBest(const ParameterSet &parameters) const;
+
+private:
+    TunerOptions options;
+    ParameterSpace space;
+    std::unique_ptr<Replay> base;
+    std::vector<ParameterSet> candidates;
+    std::vector<std::vector<int>> scores; // [组合][局号]，未评估为 -1
+};
+
+// benchmark tune 的入口
+int runTuner(int argc, char **argv);
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdio>
+#include <chrono>
+#include <string>
+#include "../gameManager.h"
+#include "../profiler.h"
+#include "judgeSimulator.h"
+
+// 进程启动以来全局 operator new 的调用次数，定义在 benchmark.cpp
+uint64_t allocationTotal();
+
+// 进程内的一局游戏：判题器模拟和选手程序共用一个进程，输入输出都在内存中
+// 初始化分两步：load 读入地图并完成与参数无关的预计算，configure 按 game.paramReader 中的参数创建各部件
+class Replay
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr uint32_t FRAME_BUDGET_MICROS = 15000; // 判题器一帧的时间
+
+    explicit Replay(unsigned seed) : judge(seed) {}
+
+    bool load(const std::string &mapPath)
+    {
+        if (!judge.loadMap(mapPath))
+        {
+            std::fprintf(stderr, "无法读取地图 %s\n", mapPath.c_str());
+            return false;
+        }
+        if (!judge.playable())
+        {
+            std::fprintf(stderr, "地图 %s 缺少购买点、交货点或泊位，不是复赛地图\n", mapPath.c_str());
+            return false;
+        }
+        game.commandManager.captureOutput(&output);
+        const std::string init = judge.initInput();
+        game.input.feed(init.data(), init.size());
+        uint64_t allocBegin = allocationTotal();
+        auto start = Clock::now();
+        game.loadInitialState();
+        initMicros += microsSince(start);
+        initAllocations += allocationTotal() - allocBegin;
+        return true;
+    }
+
+    void configure()
+    {
+        uint64_t allocBegin = allocationTotal();
+        auto start = Clock::now();
+        game.configureComponents();
+        initMicros += microsSince(start);
+        initAllocations += allocationTotal() - allocBegin;
+        output.clear();
+    }
+
+    inline bool initialize(const std::string &mapPath)
+    {
+        if (!load(mapPath))
+            return false;
+        configure();
+        return true;
+    }
+
+    // 运行一帧，frameMicros 和 frameAllocations 只统计选手程序部分
+    void step(int frame)
+    {
+        const std::string text = judge.frameInput(frame);
+        game.input.feed(text.data(), text.size());
+        output.clear();
+        uint64_t allocBegin = allocationTotal();
+        auto start = Clock::now();
+        game.processFrameData();
+        game.update();
+        game.outputCommands();
+        uint32_t micros = static_cast<uint32_t>(microsSince(start));
+        uint64_t allocated = allocationTotal() - allocBegin;
+        frameMicros.add(micros);
+        frameAllocations.add(static_cast<uint32_t>(allocated));
+        totalAllocations += allocated;
+        if (micros > FRAME_BUDGET_MICROS)
+            ++overBudgetFrames;
+        judge.applyCommands(output);
+    }
+
+    static inline uint64_t microsSince(Clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+    }
+
+public:
+    JudgeSimulator judge;
+    GameManager game;
+    std::string output;
+    uint64_t initMicros = 0, initAllocations = 0;
+    MicrosHistogram frameMicros;      // 每帧耗时
+    MicrosHistogram frameAllocations; // 每帧分配次数，借用直方图做分位统计
+    uint64_t totalAllocations = 0;
+    int overBudgetFrames = 0; // 超过一帧时间的帧数
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <climits>
+#include <algorithm>
 #include "utils.h"
 #include "log.h"
 #include "goods.h"
@@ -30,8 +32,6 @@ public:
 public:
     int stockpile;                                    // 泊位堆积的货物量
     int stockpileValue;                               // 泊位堆积的货物的价值
-    std::vector<Goods> reached_goods;                 // 堆积货物的列表
-    std::vector<Goods> unreached_goods;               // 未到达货物的列表
     int residue_num = 0;                              // 泊位当前剩余无法装在的货物数量，每帧重新计算
     int residue_value = 0;                             // 泊位溢出价值
     int totalValue = 0;                               // 泊位当前理论收益，每帧重新计算
@@ -42,6 +42,13 @@ public:
 
     std::vector<std::vector<int>> storageSlots; // 16个格子，-1表示没有机器人，否则表示机器人id
     float estimateValue = 0;                          // 根据泊位的平均访问距离和交货点访问性计算泊位的价值，在earlyGameAssetManager.init()更新
+
+private:
+    // 泊位账本，货物到达和装船时增量更新，读取都是 O(1)
+    // 三者必须一起修改，只能通过 receiveGoods / takeGoods 改动
+    std::vector<Goods> reached_goods;       // 堆积货物的列表
+    std::vector<int> reachedValuePrefix{0}; // 历史上所有到达货物的价值前缀和
+    int takenNum = 0;                       // 已装船的货物数量，reached_goods[k] 对应前缀和的第 takenNum + k 项
 public:
     // 统计变量
     static int totalLoadGoodnum; // 总装货的数量(送到虚拟点的货物量)
@@ -69,6 +76,16 @@ public:
         return distsToDelivery[0].second;
     }
 
+    // 最近的可达交货点和航线长度，航线长度为 0 表示没有预存航线，都不可达时返回 {-1, INT_MAX}
+    std::pair<int, int> nearestDelivery() const
+    {
+        // distsToDelivery 按航线长度升序
+        for (const auto &[deliveryId, length] : distsToDelivery)
+            if (length > 0)
+                return {deliveryId, length};
+        return {-1, INT_MAX};
+    }
+
     // 判断泊位是否启用
     bool isEnable() const
     {
@@ -113,13 +130,41 @@ public:
         //     reach_info += "(" + std::to_string(good.id) + "," + std::to_string(good.value) + "),";
         // }
 
-        std::string unreach_info = "未到达货物数量:" + std::to_string(unreached_goods.size()) + ";总价值：" + std::to_string(totalValue);
+        std::string unreach_info = "堆积货物价值:" + std::to_string(reachedValue()) + ";总价值：" + std::to_string(totalValue);
         LOGI(berth_info, reach_info, ";", unreach_info);
         LOGI("泊位上船的数量：", shipInBerthNum,",路途时间：", onRouteTime);
         LOGI("送达货物量：", totalLoadGoodnum, ",总货物量", deliverGoodNum, ",理论最大送达量：", maxLoadGoodNum, ", 成功装载比例：", maxLoadGoodNum * 1.0 / deliverGoodNum, ",成功送达比例：", totalLoadGoodnum * 1.0 / maxLoadGoodNum);
         LOGI("-----------------------------------------------------------------------------------------------------------------------------------------------");
     }
 
+    // 机器人放下货物
+    void receiveGoods(const Goods &good)
+    {
+        reached_goods.push_back(good);
+        reachedValuePrefix.push_back(reachedValuePrefix.back() + good.value);
+    }
+
+    // 船装走最早到达的 num 个货物，返回它们的价值
+    int takeGoods(int num)
+    {
+        num = std::min(num, reachedNum());
+        int value = reachedValue(0, num);
+        reached_goods.erase(reached_goods.begin(), reached_goods.begin() + num);
+        takenNum += num;
+        return value;
+    }
+
+    // 堆积货物中下标 [begin, end) 的价值之和，区间超出范围的部分忽略
+    inline int reachedValue(int begin, int end) const
+    {
+        begin = std::max(begin, 0);
+        end = std::min(end, reachedNum());
+        return begin < end ? reachedValuePrefix[takenNum + end] - reachedValuePrefix[takenNum + begin] : 0;
+    }
+    inline int reachedValue() const { return reachedValue(0, reachedNum()); }
+    // 堆积货物的数量
+    inline int reachedNum() const { return static_cast<int>(reached_goods.size()); }
+
     // 传入卸货数量，按照进货数量进行卸货
     void unloadGoods(int res)
     {
@@ -1,4 +1,5 @@
 #include "berthAssignAndControlService.h"
+#include <numeric>
 
 void BerthAssignAndControlService::initialize(const Map &map, std::vector<Berth> &berths){
     CLUSTERNUMS = std::min(int(berths.size()), CLUSTERNUMS); //需要先setparams
@@ -34,7 +35,7 @@ void BerthAssignAndControlService::clusterBerths(const Map &map, std::vector<Ber
             clusteredNum++;
             for (int j = i + 1; j < berths.size(); j++)
             {
-                if (map.berthDistanceMap.at(i)[berths[j].pos.x][berths[j].pos.y] != INT_MAX)
+                if (map.berthLandComponent[berths[j].id] == map.berthLandComponent[berths[i].id])
                 {
                     anotherClass.push_back(berths[j]);
                     clustered[j] = true;
@@ -47,32 +48,44 @@ void BerthAssignAndControlService::clusterBerths(const Map &map, std::vector<Ber
     LOGI("泊位联通块数量：", clusters.size());
     LOGI("第一个类的数量：", clusters[0].size());
     LOGI("类的数量：", CLUSTERNUMS);
-    // 距离聚类
+    // 距离聚类，类内距离矩阵和总距离只在类被拆分时重新计算
+    std::vector<std::vector<std::vector<int>>> inner_dist_grid;
+    std::vector<int> total_inner_dist;
+    auto measure = [&](const std::vector<Berth> &cluster)
+    {
+        inner_dist_grid.push_back(inner_dist(cluster, map));
+        int total = 0;
+        for (const std::vector<int> &row : inner_dist_grid.back())
+            total = std::accumulate(row.begin(), row.end(), total);
+        total_inner_dist.push_back(total);
+    };
+    for (const std::vector<Berth> &cluster : clusters)
+        measure(cluster);
     while (clusters.size() < CLUSTERNUMS)
     {
-        // LOGI(clusters.size());
-        std::vector<std::vector<std::vector<int>>> inner_dist_grid(clusters.size());
-        int max = 0, argmax = -1;
         // 找类内距最大的类进行拆分
+        int max = 0, argmax = -1;
         for (int i = 0; i < clusters.size(); i++)
         {
-            inner_dist_grid[i] = inner_dist(clusters[i], map);
-            int total_inner_dist = 0;
-            for (int j = 0; j < clusters[i].size(); j++)
-                for (int k = 0; k < clusters[i].size(); k++)
-                    total_inner_dist += inner_dist_grid[i][j][k];
-            if (total_inner_dist > max)
+            if (total_inner_dist[i] > max)
             {
-                max = total_inner_dist;
+                max = total_inner_dist[i];
                 argmax = i;
             }
         }
+        // 每个类都只剩一个泊位时无法继续拆分
+        if (argmax == -1)
+            break;
 
-        // LOGI(clusters[argmax].size(), ' ', inner_dist_grid[argmax].size());s
         std::vector<std::vector<Berth>> ret = hierarchicalClustering(clusters[argmax], inner_dist_grid[argmax], 2);
         clusters.erase(clusters.begin() + argmax);
-        clusters.push_back(ret[0]);
-        clusters.push_back(ret[1]);
+        inner_dist_grid.erase(inner_dist_grid.begin() + argmax);
+        total_inner_dist.erase(total_inner_dist.begin() + argmax);
+        for (const std::vector<Berth> &half : ret)
+        {
+            clusters.push_back(half);
+            measure(half);
+        }
     }
 
     // 更新berthCluster
@@ -164,7 +177,7 @@ BerthAssignAndControlService::findClosestClusters(const std::vector<std::vector<
 }
 
 std::vector<std::vector<int>> 
-BerthAssignAndControlService::inner_dist(std::vector<Berth> berths, const Map &map)
+BerthAssignAndControlService::inner_dist(const std::vector<Berth> &berths, const Map &map)
 {
     int n = berths.size();
     std::vector<std::vector<int>> grid(n, std::vector<int>(n));
@@ -172,7 +185,7 @@ BerthAssignAndControlService::inner_dist(std::vector<Berth> berths, const Map &m
     {
         for (int j = 0; j < n; j++)
         {
-            grid[i][j] = map.berthDistanceMap.at(berths[i].id)[berths[j].pos.x][berths[j].pos.y];
+            grid[i][j] = map.berthToBerthLandDistance[berths[i].id][berths[j].id];
         }
     }
     return grid;
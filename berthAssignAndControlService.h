@@ -11,7 +11,7 @@ public:
     std::vector<std::vector<Berth>> clusters;   // 聚簇所得类
     std::vector<int> berthCluster; // 每个泊位所对应的类
 
-    int CLUSTERNUMS;  //超参，暂时设定为聚类数量
+    int CLUSTERNUMS = 4;  //超参，暂时设定为聚类数量
 public:
     // 初始化
     void initialize(const Map &map, std::vector<Berth> &berths);
@@ -35,5 +35,5 @@ private:
                         const std::vector<bool> &merged);
 
     std::vector<std::vector<int>>
-    inner_dist(std::vector<Berth> berths, const Map &map);
+    inner_dist(const std::vector<Berth> &berths, const Map &map);
 };
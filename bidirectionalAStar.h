@@ -1,23 +1,154 @@
+#pragma once
 #include "pathFinder.h"
-#include <mutex>
-#include <optional>
+#include "priorityQueue.h"
 #include <vector>
-#include <future>
 #include <atomic>
+#include <memory>
+#include <cstdint>
 
+// 双向搜索需要的图上动作：正向后继、反向前驱和两个方向都一致（consistent）的启发式
+template <class Location>
+struct BidirectionalMoves;
+
+template <>
+struct BidirectionalMoves<Point2d>
+{
+    // 陆地四邻域对称，前驱与后继相同；不使用 Map::neighbors，它会随机打乱顺序
+    template <class Graph, class Visit>
+    static inline void successors(const Graph &graph, const Point2d &pos, Visit &&visit)
+    {
+        for (const Point2d &dir : Graph::DIRS)
+        {
+            Point2d next = pos + dir;
+            if (graph.inBounds(next) && graph.passable(next))
+                visit(next);
+        }
+    }
+    template <class Graph, class Visit>
+    static inline void predecessors(const Graph &graph, const Point2d &pos, Visit &&visit)
+    {
+        successors(graph, pos, visit);
+    }
+    static inline int heuristic(const Point2d &a, const Point2d &b)
+    {
+        return Point2d::calculateManhattanDistance(a, b);
+    }
+};
+
+template <>
+struct BidirectionalMoves<VectorPosition>
+{
+    template <class Graph, class Visit>
+    static inline void successors(const Graph &graph, const VectorPosition &vp, Visit &&visit)
+    {
+        const VectorPosition next[3] = {SpatialUtils::moveForward(vp),
+                                        SpatialUtils::anticlockwiseRotation(vp),
+                                        SpatialUtils::clockwiseRotation(vp)};
+        for (const VectorPosition &n : next)
+            if (graph.passable(n))
+                visit(n);
+    }
+    template <class Graph, class Visit>
+    static inline void predecessors(const Graph &graph, const VectorPosition &vp, Visit &&visit)
+    {
+        const VectorPosition prev[3] = {SpatialUtils::moveBackward(vp),
+                                        SpatialUtils::anticlockwiseRotationInverse(vp),
+                                        SpatialUtils::clockwiseRotationInverse(vp)};
+        for (const VectorPosition &p : prev)
+            if (graph.passable(p))
+                visit(p);
+    }
+    // 每个动作代价至少为 1，核心点的曼哈顿距离最多变化 2，取一半保证可采纳且一致
+    static inline int heuristic(const VectorPosition &a, const VectorPosition &b)
+    {
+        return (Point2d::calculateManhattanDistance(a.pos, b.pos) + 1) / 2;
+    }
+};
+
+// 双向 A*：在调用线程中交替扩展开放列表较小的一方，各自使用可重入的缓冲区
+// 不另开线程：航线预计算已经在线程池中按航线并行，交替执行时结果也不随线程调度变化
+// 两个方向通过每个状态一个戳（generation << 32 | g）发布已到达的代价
+// 任意方向新到达一个状态时读取另一方向的发布值更新最优相遇代价 mu
+// 使用平均势函数 p(v) = (h(v, 终点) - h(v, 起点)) / 2，正向键为 g + p，反向键为 g - p，两边的边权都非负，
+// 两个方向当前最小键之和不小于 mu 时停止（键都乘 2 保持整数），启发式一致时得到的是最短路
 template <class Location, class Graph>
 class BidirectionalAStarPathfinder : public Pathfinder<Location, Graph>
 {
 private:
-    std::unordered_map<Location, Location> came_from_start, came_from_goal; // came_from 用于追踪路径
-    std::unordered_map<Location, int> cost_so_far_start, cost_so_far_goal;  // cost_so_far 用于记录到达每个点的成本
-    PriorityQueue<Location, double> frontier_start, frontier_goal;
-    std::mutex search_from_goal_mutex, search_from_start_mutex;
-    std::optional<Location> meeting_point;
-    std::atomic<bool> found_meeting_point{false};
+    using Indexer = GridIndexer<Location>;
+    using Moves = BidirectionalMoves<Location>;
+    static constexpr int FORWARD = 0, BACKWARD = 1;
+    static constexpr uint64_t NO_MEETING = UINT64_MAX;
+
+    // 单个方向的搜索状态，只被该方向的搜索写
+    struct DirectionState
+    {
+        std::vector<int> costSoFar;
+        std::vector<int> cameFrom;
+        std::vector<uint32_t> seenStamp;
+        IndexedDaryHeap<4> frontier;
+    };
+
+    // 一次搜索的全部缓冲区，按调用线程各一份，跨调用复用
+    struct Workspace
+    {
+        size_t stateCount = 0;
+        uint32_t generation = 0;
+        DirectionState directions[2];
+        std::unique_ptr<std::atomic<uint64_t>[]> published[2]; // 高 32 位为 generation，低 32 位为该方向的 g
+        std::atomic<uint64_t> best{NO_MEETING};                // 高 32 位为 mu，低 32 位为相遇状态下标
+        std::atomic<int> topKey[2];                            // 各方向最近出队的键，单调不减
+        std::atomic<bool> done{false};
+
+        void prepare(size_t states, int initialKey)
+        {
+            if (stateCount != states)
+            {
+                stateCount = states;
+                generation = 0;
+                for (int d = 0; d < 2; ++d)
+                {
+                    directions[d].costSoFar.assign(states, 0);
+                    directions[d].cameFrom.assign(states, -1);
+                    directions[d].seenStamp.assign(states, 0);
+                    published[d].reset(new std::atomic<uint64_t>[states]);
+                }
+                resetStamps();
+            }
+            if (++generation == 0)
+            {
+                resetStamps();
+                generation = 1;
+            }
+            for (int d = 0; d < 2; ++d)
+                directions[d].frontier.reset(states);
+            best.store(NO_MEETING, std::memory_order_relaxed);
+            // 起点和终点的键都是 h(起点, 终点)，不大于之后出队的任何键
+            for (int d = 0; d < 2; ++d)
+                topKey[d].store(initialKey, std::memory_order_relaxed);
+            done.store(false, std::memory_order_relaxed);
+        }
+
+        void resetStamps()
+        {
+            for (int d = 0; d < 2; ++d)
+            {
+                std::fill(directions[d].seenStamp.begin(), directions[d].seenStamp.end(), 0);
+                for (size_t i = 0; i < stateCount; ++i)
+                    published[d][i].store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    static Workspace &workspace()
+    {
+        // 航线预计算会在多个线程中同时寻路，每个调用线程一份
+        static thread_local Workspace ws;
+        return ws;
+    }
 
 public:
-    // Path 第一个元素是终点，逆序存储
+    // Path 第一个元素是终点，逆序存储，不含起点，与 GridAStarPathfinder 一致
     virtual std::variant<Path<Location>, PathfindingFailureReason>
     findPath(const Location &start,
              const Location &goal,
@@ -31,146 +162,144 @@ public:
             return PathfindingFailureReason::END_POINT_INVALID;
         if (start == goal)
             return PathfindingFailureReason::START_AND_END_POINT_SAME;
-        
-        auto search_from_start = std::async(std::launch::async, [&]
-                                            { searchFromStart(graph, start); });
-        auto search_from_goal = std::async(std::launch::async, [&]
-                                           { searchFromGoal(graph, goal); });
-
-        // 等待两个方向的搜索完成
-        search_from_start.wait();
-        search_from_goal.wait();
-
-        // 如果未找到路径
-        if (!meeting_point.has_value())
-        {
-            return PathfindingFailureReason::NO_PATH_EXISTS;
-        }
 
-        // 回溯路径
-        Path<Location> path = reconstruct_path(start, goal);
-        return path;
+        Workspace &ws = workspace();
+        ws.prepare(static_cast<size_t>(graph.rows) * graph.cols * Indexer::layers, Moves::heuristic(start, goal));
+
+        Search<FORWARD> forward(graph, start, goal, ws);
+        Search<BACKWARD> backward(graph, goal, start, ws);
+        bool running = true;
+        while (running)
+            running = forward.frontierSize() <= backward.frontierSize() ? forward.step() : backward.step();
+
+        uint64_t best = ws.best.load(std::memory_order_acquire);
+        if (best == NO_MEETING)
+            return PathfindingFailureReason::NO_PATH_EXISTS;
+        return reconstruct_path(graph, start, goal, static_cast<int>(best & UINT32_MAX), ws);
     }
 
-    void searchFromStart(const Graph &graph, const Location &start)
+private:
+    // 单个方向的搜索过程，Dir 为 FORWARD 时从 source = 起点向 target = 终点搜索后继，BACKWARD 时从终点向起点搜索前驱
+    template <int Dir>
+    class Search
     {
-        frontier_start.put(start, 0);
-        came_from_start[start] = start;
-        cost_so_far_start[start] = 0;
-
-        while (!frontier_start.empty())
+    public:
+        Search(const Graph &graph, const Location &source, const Location &target, Workspace &ws)
+            : graph(graph), source(source), target(target), ws(ws), self(ws.directions[Dir]),
+              mine(ws.published[Dir].get()), other(ws.published[1 - Dir].get()),
+              stamp(static_cast<uint64_t>(ws.generation) << 32), cols(graph.cols)
         {
-            Location current = frontier_start.get();
+            const int sourceIndex = Indexer::toIndex(source, cols);
+            reach(sourceIndex, -1, 0);
+            self.frontier.put(sourceIndex, key(source, 0));
+        }
 
-            // 检查是否遇到了从另一侧开始的搜索
+        // 扩展一个状态，返回 false 表示本方向已经结束，并通知另一方向
+        bool step()
+        {
+            if (ws.done.load(std::memory_order_relaxed) || !advance())
             {
-                // std::lock_guard<std::mutex> lock(search_from_goal_mutex);
-                if (came_from_goal.find(current) != came_from_goal.end())
-                {
-                    meeting_point = current;         // 记录相遇点
-                    found_meeting_point.store(true); // 通知其他搜索方向
-                    break;
-                }
+                ws.done.store(true, std::memory_order_relaxed);
+                return false;
             }
+            return true;
+        }
 
-            for (const Location &next : graph.neighbors(current))
-            {
-                if (!graph.passable(next))
-                    continue; // 忽略不可通过的节点
+        size_t frontierSize() const { return self.frontier.size(); }
 
-                int new_cost = cost_so_far_start[current] + graph.cost(current, next);
-                if (!cost_so_far_start.count(next) || new_cost < cost_so_far_start[next])
-                {
-                    cost_so_far_start[next] = new_cost;
-                    int priority = new_cost + heuristic(next, start); // 注意：启发式函数的目标位置取决于搜索方向
-                    frontier_start.put(next, priority);
-                    // std::lock_guard<std::mutex> lock(search_from_start_mutex);
-                    came_from_start[next] = current;
-                }
-            }
+    private:
+        // 两倍的键：2g + h(v, target) - h(v, source)
+        inline int key(const Location &loc, int cost) const
+        {
+            return 2 * cost + Moves::heuristic(loc, target) - Moves::heuristic(loc, source);
         }
-    }
 
-    void searchFromGoal(const Graph &graph, const Location &goal)
-    {
-        frontier_goal.put(goal, 0);
-        came_from_goal[goal] = goal;
-        cost_so_far_goal[goal] = 0;
-
-        while (!frontier_goal.empty())
+        // 记录到达 index 的代价并发布，另一方向已经到达过时尝试更新 mu
+        inline void reach(int index, int parent, int cost)
         {
-            Location current = frontier_goal.get();
+            self.seenStamp[index] = ws.generation;
+            self.cameFrom[index] = parent;
+            self.costSoFar[index] = cost;
+            // 双方都是先写自己再读对方，同一个状态后到达的一方一定能看到另一方
+            mine[index].store(stamp | static_cast<uint32_t>(cost), ORDER);
+            uint64_t theirs = other[index].load(ORDER);
+            if ((theirs & ~static_cast<uint64_t>(UINT32_MAX)) == stamp)
+                offerMeeting(ws, cost + static_cast<int>(theirs & UINT32_MAX), index);
+        }
 
-            // 检查是否遇到了从另一侧开始的搜索
-            {
-                // std::lock_guard<std::mutex> lock(search_from_start_mutex);
-                if (came_from_start.find(current) != came_from_start.end())
-                {
-                    meeting_point = current;         // 找到相遇点
-                    found_meeting_point.store(true); // 通知其他搜索方向
-                    break;
-                }
-            }
+        bool advance()
+        {
+            if (self.frontier.empty())
+                return false;
+            const int currentIndex = self.frontier.get();
+            const Location current = Indexer::fromIndex(currentIndex, cols);
+            const int currentCost = self.costSoFar[currentIndex];
+            const int currentKey = key(current, currentCost);
+            ws.topKey[Dir].store(currentKey, std::memory_order_release);
+            // 另一方向的键读到旧值只会更晚停止，不影响正确性
+            uint64_t best = ws.best.load(std::memory_order_acquire);
+            if (best != NO_MEETING &&
+                currentKey + ws.topKey[1 - Dir].load(std::memory_order_acquire) >= 2 * static_cast<int>(best >> 32))
+                return false;
 
-            for (const Location &next : graph.neighbors(current))
+            auto relax = [&](const Location &next)
             {
-                if (!graph.passable(next))
-                    continue; // 忽略不可通过的节点
-
-                int new_cost = cost_so_far_goal[current] + graph.cost(current, next);
-                if (!cost_so_far_goal.count(next) || new_cost < cost_so_far_goal[next])
-                {
-                    cost_so_far_goal[next] = new_cost;
-                    int priority = new_cost + heuristic(next, goal); // 注意：启发式函数的目标位置取决于搜索方向
-                    frontier_goal.put(next, priority);
-                    // std::lock_guard<std::mutex> lock(search_from_goal_mutex);
-                    came_from_goal[next] = current;
-                }
-            }
+                // 边的代价只取决于到达的位姿，反向搜索时到达的是 current
+                int newCost = currentCost + (Dir == FORWARD ? graph.cost(current, next) : graph.cost(next, current));
+                int nextIndex = Indexer::toIndex(next, cols);
+                if (self.seenStamp[nextIndex] == ws.generation && self.costSoFar[nextIndex] <= newCost)
+                    return;
+                reach(nextIndex, currentIndex, newCost);
+                self.frontier.put(nextIndex, key(next, newCost));
+            };
+            if (Dir == FORWARD)
+                Moves::successors(graph, current, relax);
+            else
+                Moves::predecessors(graph, current, relax);
+            return true;
         }
-    }
 
-    Path<Location> reconstruct_path(const Location &start, const Location &goal)
+        static constexpr std::memory_order ORDER = std::memory_order_relaxed;
+        const Graph &graph;
+        const Location source, target;
+        Workspace &ws;
+        DirectionState &self;
+        std::atomic<uint64_t> *mine;
+        const std::atomic<uint64_t> *other;
+        const uint64_t stamp;
+        const int cols;
+    };
+
+    static void offerMeeting(Workspace &ws, int cost, int index)
     {
-        if (!meeting_point.has_value())
+        uint64_t candidate = (static_cast<uint64_t>(cost) << 32) | static_cast<uint32_t>(index);
+        uint64_t current = ws.best.load(std::memory_order_relaxed);
+        while (candidate < current &&
+               !ws.best.compare_exchange_weak(current, candidate, std::memory_order_acq_rel, std::memory_order_relaxed))
         {
-            return Path<Location>(); // 如果没有相遇点，直接返回空路径
         }
+    }
 
-        Location meet = meeting_point.value();
-        std::vector<Location> path;
-        std::vector<Location> path_to_meet;
-        std::vector<Location> path_from_meet;
-
-        // 从相遇点回溯到起点
-        Location current = meet;
-        while (current != start)
-        {
-            path_to_meet.push_back(current);
-            current = came_from_start.at(current);
-        }
-        path_to_meet.push_back(start);                          // 加入起点
-        std::reverse(path_to_meet.begin(), path_to_meet.end()); // 反转，因为我们是从相遇点回溯到起点
+    static Path<Location> reconstruct_path(const Graph &graph, const Location &start, const Location &goal,
+                                           int meetIndex, const Workspace &ws)
+    {
+        const int cols = graph.cols;
+        const int startIndex = Indexer::toIndex(start, cols);
+        const int goalIndex = Indexer::toIndex(goal, cols);
+        const std::vector<int> &forwardParent = ws.directions[FORWARD].cameFrom;
+        const std::vector<int> &backwardParent = ws.directions[BACKWARD].cameFrom;
 
-        // 从相遇点回溯到终点
-        current = meet;
-        while (current != goal)
+        // 相遇点到终点一段，先正序收集再翻转成终点在前
+        Path<Location> path;
+        for (int index = meetIndex; index != goalIndex;)
         {
-            path_from_meet.push_back(current);
-            current = came_from_goal.at(current);
+            index = backwardParent[index];
+            path.push_back(Indexer::fromIndex(index, cols));
         }
-        path_from_meet.push_back(goal); // 加入终点
-
-        // 合并两个路径段
-        path.reserve(path_to_meet.size() + path_from_meet.size() - 1); // 相遇点会被重复加入，因此-1
-        path.insert(path.end(), path_to_meet.begin(), path_to_meet.end());
-        path.insert(path.end(), path_from_meet.begin() + 1, path_from_meet.end()); // 从第二个元素开始加入，避免重复相遇点
-
+        std::reverse(path.begin(), path.end());
+        // 相遇点到起点一段，不含起点
+        for (int index = meetIndex; index != startIndex; index = forwardParent[index])
+            path.push_back(Indexer::fromIndex(index, cols));
         return path;
     }
-
-    inline int heuristic(const Point2d &pos1, const Point2d &pos2)
-    {
-        return Point2d::calculateManhattanDistance(pos1, pos2);
-    }
 };
@@ -2,44 +2,157 @@
 
 #include <vector>
 #include <string>
-#include <iostream>
-#include "robot.h"
-#include "ship.h"
-#include "goods.h"
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include "utils.h"
 #include "log.h"
-#include <sstream>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// 指令缓冲区，指令直接编码为字符，容量只增不减，稳定后每帧不再分配内存
+class CommandBuffer
+{
+public:
+    explicit CommandBuffer(size_t capacity = 1 << 14) : data(capacity) {}
+
+    inline void clear() { length = 0; }
+    inline size_t size() const { return length; }
+    inline const char *begin() const { return data.data(); }
+
+    inline CommandBuffer &append(const char *text, size_t n)
+    {
+        reserve(n);
+        std::memcpy(data.data() + length, text, n);
+        length += n;
+        return *this;
+    }
+    // 追加字符串字面量，不包括结尾的 '\0'
+    template <size_t N>
+    inline CommandBuffer &append(const char (&text)[N]) { return append(text, N - 1); }
+
+    inline CommandBuffer &append(const CommandBuffer &other) { return append(other.begin(), other.size()); }
+
+    inline CommandBuffer &appendChar(char c)
+    {
+        reserve(1);
+        data[length++] = c;
+        return *this;
+    }
+
+    // 追加一个整数，先用空格分隔
+    inline CommandBuffer &appendArg(int value)
+    {
+        reserve(12);
+        data[length++] = ' ';
+        if (value < 0)
+        {
+            data[length++] = '-';
+            value = -value;
+        }
+        char digits[10];
+        int n = 0;
+        do
+        {
+            digits[n++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value);
+        while (n)
+            data[length++] = digits[--n];
+        return *this;
+    }
+
+private:
+    inline void reserve(size_t n)
+    {
+        if (length + n > data.size())
+            data.resize(std::max(data.size() * 2, length + n));
+    }
+
+private:
+    std::vector<char> data;
+    size_t length = 0;
+};
+
 // 这个类负责收集机器人和船只的指令，并最终统一输出。
+// 机器人指令在前，船舶指令在后，每帧用一次 write 输出
 class CommandManager
 {
 private:
-    std::vector<std::string> robotCommands; // 存储机器人指令
-    std::vector<std::string> shipCommands;  // 存储船只指令
+    CommandBuffer robotCommands; // 存储机器人指令
+    CommandBuffer shipCommands;  // 存储船只指令
+    CommandBuffer output;        // 本帧的完整输出
+    std::string *capture = nullptr; // 非空时输出追加到这里而不写标准输出
 
 public:
-    void addRobotCommand(const std::string &command)
+    // 把之后的输出重定向到内存，传 nullptr 恢复写标准输出
+    void captureOutput(std::string *sink) { capture = sink; }
+
+    // 机器人指令
+    void robotMove(RobotID id, int direction)
+    {
+#ifdef DEBUG
+        assert(direction >= 0 && direction <= 3);
+#endif
+        robotCommands.append("move").appendArg(id).appendArg(direction).appendChar('\n');
+    }
+    void robotGet(RobotID id) { robotCommands.append("get").appendArg(id).appendChar('\n'); }
+    void robotPull(RobotID id) { robotCommands.append("pull").appendArg(id).appendChar('\n'); }
+    // 购买机器人
+    void purchaseRobot(const Point2d &pos, int type)
     {
-        robotCommands.emplace_back(command);
+        robotCommands.append("lbot").appendArg(pos.x).appendArg(pos.y).appendArg(type).appendChar('\n');
     }
-    void addShipCommand(const std::string &command)
+
+    // 船舶指令
+    void shipForward(ShipID id) { shipCommands.append("ship").appendArg(id).appendChar('\n'); }
+    void shipRotate(ShipID id, RotationDirection rotDirection)
     {
-        shipCommands.emplace_back(command);
+        shipCommands.append("rot").appendArg(id).appendArg(static_cast<int>(rotDirection)).appendChar('\n');
     }
-    void outputCommands() const
+    void shipBerth(ShipID id) { shipCommands.append("berth").appendArg(id).appendChar('\n'); }
+    void shipDept(ShipID id) { shipCommands.append("dept").appendArg(id).appendChar('\n'); }
+    // 购买船舶
+    void purchaseShip(const Point2d &pos)
+    {
+        shipCommands.append("lboat").appendArg(pos.x).appendArg(pos.y).appendChar('\n');
+    }
+
+    void outputCommands()
     {
-        std::ostringstream stream;
-        // 输出所有机器人指令
-        for (const auto &command : robotCommands)
-            stream << command << "\n";
-        // 输出所有船舶指令
-        for (const auto &command : shipCommands)
-            stream << command << "\n";
-        stream << "OK\n";
-        // 刷新输出缓冲区
-        std::cout << stream.str() << std::flush;
+        output.clear();
+        output.append(robotCommands).append(shipCommands).append("OK\n");
+        if (capture)
+        {
+            capture->append(output.begin(), output.size());
+            return;
+        }
+        const char *p = output.begin();
+        size_t remaining = output.size();
+        while (remaining > 0)
+        {
+#ifdef _WIN32
+            int n = _write(1, p, static_cast<unsigned>(remaining));
+#else
+            ssize_t n = write(1, p, remaining);
+#endif
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                LOGE("输出指令失败");
+                return;
+            }
+            p += n;
+            remaining -= n;
+        }
     }
     void clearCommands()
     {
         robotCommands.clear();
         shipCommands.clear();
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cmath>
+
+// 按半衰期衰减的事件计数和价值，半衰期内的事件权重不低于一半
+struct DecayedCounter
+{
+    static constexpr float HALF_LIFE = 500; // 半衰期（帧）
+    // 衰减后的总量约等于最近 HALF_LIFE / ln2 帧内的总量
+    static constexpr float WINDOW = HALF_LIFE / 0.693147f;
+
+    float count = 0, value = 0;
+    int lastFrame = 0;
+
+    void add(int frame, int eventValue)
+    {
+        float d = decay(frame);
+        count = count * d + 1;
+        value = value * d + eventValue;
+        lastFrame = frame;
+    }
+    inline float recentCount(int frame) const { return count * decay(frame); }
+    inline float recentValue(int frame) const { return value * decay(frame); }
+    // 每帧的平均事件数和价值
+    inline float countRate(int frame) const { return recentCount(frame) / WINDOW; }
+    inline float valueRate(int frame) const { return recentValue(frame) / WINDOW; }
+
+private:
+    inline float decay(int frame) const { return std::exp2(-(frame - lastFrame) / HALF_LIFE); }
+};
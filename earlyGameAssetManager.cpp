@@ -43,7 +43,7 @@ void EarlyGameAssetManager::init(const Map& map, std::vector<Berth> &berths)
 }
 
 std::vector<PurchaseDecision> EarlyGameAssetManager::makePurchaseDecision(const Map &gameMap,
-                                                    const std::vector<Goods> &goods,
+                                                    const GoodsStore &goods,
                                                     const std::vector<Robot> &robots,
                                                     const std::vector<Ship> &ships,
                                                     const std::vector<Berth> &berths,
@@ -86,7 +86,7 @@ std::vector<PurchaseDecision> EarlyGameAssetManager::makePurchaseDecision(const
     return purchaseDecisions;
 }
 
-int EarlyGameAssetManager::buyRobotType(const std::vector<Robot> &robots, const std::vector<Goods> &goods, const Map &gameMap, int currentFunds)
+int EarlyGameAssetManager::buyRobotType(const std::vector<Robot> &robots, const GoodsStore &goods, const Map &gameMap, int currentFunds)
 {
     for (int phase=0; phase<robotPurchaseAssign[0].size(); phase++) {
         // 按阶段进行购买
@@ -149,8 +149,8 @@ void EarlyGameAssetManager::calBerthsEstimateValue(std::vector<Berth>& berths, c
         int totalLandDistance = 0, totalLandNum = 0;
         for (int i=0;i<map.rows;i++) 
             for (int j=0;j<map.cols;j++) 
-                if (map.berthDistanceMap.at(berth.id)[i][j] < INT_MAX) {
-                    totalLandDistance += map.berthDistanceMap.at(berth.id)[i][j];
+                if (map.berthDistanceMap.get(berth.id, i, j) < INT_MAX) {
+                    totalLandDistance += map.berthDistanceMap.get(berth.id, i, j);
                     totalLandNum++;
                 }
         LOGI("totalLandDistance ",totalLandDistance, ", totalLandNum ", totalLandNum);
@@ -158,8 +158,8 @@ void EarlyGameAssetManager::calBerthsEstimateValue(std::vector<Berth>& berths, c
 
         int totalSeaDistance = 0, totalSeaNum = 0;
         for (auto& delivery : map.deliveryLocations)
-            if (map.maritimeBerthDistanceMap.at(berth.id)[delivery.x][delivery.y] < INT_MAX) {
-                totalSeaDistance += map.maritimeBerthDistanceMap.at(berth.id)[delivery.x][delivery.y];
+            if (map.maritimeBerthDistanceMap.get(berth.id, delivery.x, delivery.y) < INT_MAX) {
+                totalSeaDistance += map.maritimeBerthDistanceMap.get(berth.id, delivery.x, delivery.y);
                 totalSeaNum++;
             }
         LOGI("totalSeaDistance ",totalSeaDistance, ", totalSeaNum ", totalSeaNum);
@@ -182,27 +182,15 @@ void EarlyGameAssetManager::divideLandConnectedBlocks(const std::vector<Berth> &
             anotherClass.push_back(berths[i]);
             for (int j = i + 1; j < berths.size(); j++)
             {
-                if (map.berthDistanceMap.at(i)[berths[j].pos.x][berths[j].pos.y] != INT_MAX)
+                if (map.berthLandComponent[berths[j].id] == map.berthLandComponent[berth.id])
                 {
                     anotherClass.push_back(berths[j]);
                     clustered[j] = true;
                 }
             }
-            landBlocks.push_back(LandBlock{0, anotherClass});
+            landBlocks.push_back(LandBlock{berthLandSize(map, berth.id), anotherClass});
         }
     }
-
-    // 确定连通块大小
-    for (LandBlock& lb: landBlocks) {
-        int count_passableBlock = 0;
-        for (int i=0;i<map.rows;i++) {
-            for (int j=0;j<map.cols;j++) {
-                if (map.berthDistanceMap.at(lb.berths[0].id)[i][j] < INT_MAX) 
-                    count_passableBlock++;
-            }
-        }
-        lb.size = count_passableBlock;
-    }
 }
 
 void EarlyGameAssetManager::divideSeaConnectedBlocks(const std::vector<Berth> &berths, const std::vector<Point2d> &deliveryLocations, const Map &map)
@@ -218,13 +206,11 @@ void EarlyGameAssetManager::divideSeaConnectedBlocks(const std::vector<Berth> &b
             anotherClass.push_back(deliveryLocations[i]);
             for (int j = i + 1; j < deliveryLocations.size(); j++)
             {
-                const Point2d& delivery2 = deliveryLocations[j];
-                for (int k = 0; k < berths.size(); k++)
-                    if (map.maritimeBerthDistanceMap.at(k)[delivery1.x][delivery1.y] != INT_MAX && map.maritimeBerthDistanceMap.at(k)[delivery2.x][delivery2.y] != INT_MAX)
-                    {
-                        anotherClass.push_back(deliveryLocations[j]);
-                        clustered[j] = true;
-                    }
+                if (!clustered[j] && seaConnected(map, delivery1, deliveryLocations[j]))
+                {
+                    anotherClass.push_back(deliveryLocations[j]);
+                    clustered[j] = true;
+                }
             }
             seaBlocks.push_back(SeaBlock{0, anotherClass});
         }
@@ -235,7 +221,7 @@ void EarlyGameAssetManager::divideSeaConnectedBlocks(const std::vector<Berth> &b
     //     int count_passableBlock = 0;
     //     for (int i=0;i<map.rows;i++) {
     //         for (int j=0;j<map.cols;j++) {
-    //             if (map.maritimeBerthDistanceMap.at(sb.berths[0].id)[i][j] < INT_MAX) 
+    //             if (map.maritimeBerthDistanceMap.get(sb.berths[0].id, i, j) < INT_MAX) 
     //                 count_passableBlock++;
     //         }
     //     }
@@ -257,13 +243,11 @@ void EarlyGameAssetManager::divideLandAndSeaConnectedBlocks(std::vector<Berth> &
             anotherDeliveryLocations.push_back(deliveryLocations[i]);
             for (int j = i + 1; j < deliveryLocations.size(); j++)
             {
-                const Point2d& delivery2 = deliveryLocations[j];
-                for (int k = 0; k < berths.size(); k++)
-                    if (map.maritimeBerthDistanceMap.at(k)[delivery1.x][delivery1.y] != INT_MAX && map.maritimeBerthDistanceMap.at(k)[delivery2.x][delivery2.y] != INT_MAX)
-                    {
-                        anotherDeliveryLocations.push_back(deliveryLocations[j]);
-                        clustered[j] = true;
-                    }
+                if (!clustered[j] && seaConnected(map, delivery1, deliveryLocations[j]))
+                {
+                    anotherDeliveryLocations.push_back(deliveryLocations[j]);
+                    clustered[j] = true;
+                }
             }
             landseaBlocks.push_back(LandSeaBlock{0, {}, anotherDeliveryLocations, {}, {}});
         }
@@ -271,48 +255,41 @@ void EarlyGameAssetManager::divideLandAndSeaConnectedBlocks(std::vector<Berth> &
 
     for (int i=0;i<landseaBlocks.size();i++) {
         LandSeaBlock& lsb = landseaBlocks[i];
-        // 找出相连通的泊位
+        // 找出相连通且距离场能到达交货点的泊位
+        const int seaComponent = map.seaComponentOf(lsb.deliveryLocations[0]);
         std::vector<Berth> connectedBerths;
         for (int j=0;j<berths.size();j++) {
             Berth& berth = berths[j];
-            if (map.maritimeBerthDistanceMap.at(berth.id)[lsb.deliveryLocations[0].x][lsb.deliveryLocations[0].y] != INT_MAX) {
+            if (seaComponent != -1 && map.berthSeaComponent[berth.id] == seaComponent &&
+                map.maritimeBerthDistanceMap.get(berth.id, lsb.deliveryLocations[0]) < INT_MAX) {
                 connectedBerths.push_back(berth);
             }
         }
-        // 找出可用的机器人购买点
+        // 找出可用的机器人购买点：与某个相连通的泊位在同一陆地连通块
         std::vector<Point2d> availableRobotShops;
         for (int j=0;j<robotShops.size();j++) {
-            Point2d& rs = robotShops[j];
+            const int landComponent = map.landComponentOf(robotShops[j]);
             for (int k=0;k<connectedBerths.size();k++) {
-                const Berth& berth = connectedBerths[k];
-                if (map.berthDistanceMap.at(berth.id)[rs.x][rs.y] != INT_MAX) {
+                if (landComponent != -1 && map.berthLandComponent[connectedBerths[k].id] == landComponent) {
                     availableRobotShops.push_back(robotShops[j]);
                     break;
                 }
             }
         }
-        // 找出可用的轮船购买点
+        // 找出可用的轮船购买点：某个相连通的泊位的距离场能到达
         std::vector<Point2d> availableShipShops;
         for (int j=0;j<shipShops.size();j++) {
-            Point2d& ss = shipShops[j];
+            if (seaComponent == -1 || map.seaComponentOf(shipShops[j]) != seaComponent)
+                continue;
             for (int k=0;k<connectedBerths.size();k++) {
-                const Berth& berth = connectedBerths[k];
-                if (map.maritimeBerthDistanceMap.at(berth.id)[ss.x][ss.y] != INT_MAX) {
+                if (map.maritimeBerthDistanceMap.get(connectedBerths[k].id, shipShops[j]) < INT_MAX) {
                     availableShipShops.push_back(shipShops[j]);
                     break;
                 }
             }
         }
         // 找出连通块的陆地面积
-        int landSize = 0;
-        for (int j=0;j<map.rows;j++) {
-            for (int k=0;k<map.cols;k++) {
-                if (map.berthDistanceMap.at(connectedBerths[0].id)[j][k] < INT_MAX) {
-                    landSize++;
-                }
-            }
-        }
-        landseaBlocks[i].landSize = landSize;
+        landseaBlocks[i].landSize = connectedBerths.empty() ? 0 : berthLandSize(map, connectedBerths[0].id);
         landseaBlocks[i].berths = connectedBerths;
         landseaBlocks[i].robotShops = availableRobotShops;
         landseaBlocks[i].shipShops = availableShipShops;
@@ -323,7 +300,7 @@ void EarlyGameAssetManager::divideLandAndSeaConnectedBlocks(std::vector<Berth> &
     });
 }
 
-bool EarlyGameAssetManager::needToBuyRobot(const std::vector<Robot> &robots, const std::vector<Goods> &goods, const Map &gameMap, int currentFunds)
+bool EarlyGameAssetManager::needToBuyRobot(const std::vector<Robot> &robots, const GoodsStore &goods, const Map &gameMap, int currentFunds)
 {
     // 超出最大限制
     if (robots.size() >= maxRobotNum) return false;
@@ -335,7 +312,7 @@ bool EarlyGameAssetManager::needToBuyRobot(const std::vector<Robot> &robots, con
     }
     return true;
 }
-bool EarlyGameAssetManager::needToBuyShip(const std::vector<Ship> &ships, const std::vector<Goods> &goods, const Map &gameMap, int currentFunds, int currentTime)
+bool EarlyGameAssetManager::needToBuyShip(const std::vector<Ship> &ships, const GoodsStore &goods, const Map &gameMap, int currentFunds, int currentTime)
 {
     if (purchasedShipNum[0]==0) return true;
     // 超出最大限制
@@ -345,7 +322,7 @@ bool EarlyGameAssetManager::needToBuyShip(const std::vector<Ship> &ships, const
     return true;
 }
 
-Point2d EarlyGameAssetManager::buyRobot(const std::vector<Robot> &robots, const std::vector<Goods> &goods, const Map &gameMap, int currentFunds)
+Point2d EarlyGameAssetManager::buyRobot(const std::vector<Robot> &robots, const GoodsStore &goods, const Map &gameMap, int currentFunds)
 {
     for (int phase=0; phase<robotPurchaseAssign[0].size(); phase++) {
         // 按阶段进行购买
@@ -361,7 +338,7 @@ Point2d EarlyGameAssetManager::buyRobot(const std::vector<Robot> &robots, const
     return Point2d(-1,-1);
 }
 
-Point2d EarlyGameAssetManager::buyShip(const std::vector<Ship> &ships, const std::vector<Goods> &goods, const Map &gameMap, int currentFunds)
+Point2d EarlyGameAssetManager::buyShip(const std::vector<Ship> &ships, const GoodsStore &goods, const Map &gameMap, int currentFunds)
 {
     for (int phase=0; phase<shipPurchaseAssign[0].size(); phase++) {
         // 按阶段进行购买
@@ -378,7 +355,7 @@ Point2d EarlyGameAssetManager::buyShip(const std::vector<Ship> &ships, const std
     return Point2d(-1,-1);
 }
 
-Point2d EarlyGameAssetManager::getProperRobotShop(LandSeaBlock& block, const std::vector<Robot> &robots, const Map &gameMap, const std::vector<Goods> &goods)
+Point2d EarlyGameAssetManager::getProperRobotShop(LandSeaBlock& block, const std::vector<Robot> &robots, const Map &gameMap, const GoodsStore &goods)
 {
     if (block.robotShops.empty()) return Point2d(-1,-1);
     // 计算各个泊位的机器人数目
@@ -399,9 +376,10 @@ Point2d EarlyGameAssetManager::getProperRobotShop(LandSeaBlock& block, const std
     }
     // 计算各个泊位周边的货物价值
     std::vector<float> berthsValue(block.berths.size(), 0);
-    for (auto &good : goods)
+    for (GoodsID id : goods.availableGoods())
     {
-        if (good.status == 0 && !good.distsToBerths.empty())
+        const Goods &good = goods[id];
+        if (!good.distsToBerths.empty())
         {
             int berthID = good.distsToBerths[0].first;
             for (int i=0;i<block.berths.size();i++) 
@@ -425,7 +403,7 @@ Point2d EarlyGameAssetManager::getProperRobotShop(LandSeaBlock& block, const std
         // 算出泊位到所有购买点的距离
         std::vector<int> distanceToShop(block.robotShops.size(), 0);
         for (int j=0;j<distanceToShop.size();j++) {
-            distanceToShop[j] = gameMap.berthDistanceMap.at(block.berths[i].id)[block.robotShops[j].x][block.robotShops[j].y];
+            distanceToShop[j] = gameMap.berthDistanceMap.get(block.berths[i].id, block.robotShops[j].x, block.robotShops[j].y);
         }
         // 最近的购买点加上泊位的价值
         auto min_iter = std::min_element(distanceToShop.begin(), distanceToShop.end());
@@ -29,7 +29,7 @@ class EarlyGameAssetManager : public AssetManager
 {
 public:
     std::vector<PurchaseDecision> makePurchaseDecision(const Map &gameMap,
-                                                       const std::vector<Goods> &goods,
+                                                       const GoodsStore &goods,
                                                        const std::vector<Robot> &robots,
                                                        const std::vector<Ship> &ships,
                                                        const std::vector<Berth> &berths,
@@ -71,12 +71,24 @@ private:
     void divideSeaConnectedBlocks(const std::vector<Berth> &berths, const std::vector<Point2d> &deliveryLocations, const Map &map);
     void divideLandAndSeaConnectedBlocks(std::vector<Berth> &berths, const Map &map);
     void calBerthsEstimateValue(std::vector<Berth>& berths, const Map& map);
-    bool needToBuyRobot(const std::vector<Robot> &robots, const std::vector<Goods> &goods, const Map &gameMap, int currentFunds);
-    bool needToBuyShip(const std::vector<Ship> &ships, const std::vector<Goods> &goods, const Map &gameMap, int currentFunds, int currentTime);
-    Point2d buyRobot(const std::vector<Robot> &robots, const std::vector<Goods> &goods, const Map &gameMap, int currentFunds);
-    Point2d buyShip(const std::vector<Ship> &ships, const std::vector<Goods> &goods, const Map &gameMap, int currentFunds);
-    Point2d getProperRobotShop(LandSeaBlock& block, const std::vector<Robot> &robots, const Map &gameMap, const std::vector<Goods> &goods);
+    // 泊位所在陆地连通块的面积
+    static int berthLandSize(const Map &map, BerthID id)
+    {
+        int component = map.berthLandComponent[id];
+        return component == -1 ? 0 : map.landComponentSize[component];
+    }
+    // 两点在海洋上是否连通
+    static bool seaConnected(const Map &map, const Point2d &a, const Point2d &b)
+    {
+        int component = map.seaComponentOf(a);
+        return component != -1 && component == map.seaComponentOf(b);
+    }
+    bool needToBuyRobot(const std::vector<Robot> &robots, const GoodsStore &goods, const Map &gameMap, int currentFunds);
+    bool needToBuyShip(const std::vector<Ship> &ships, const GoodsStore &goods, const Map &gameMap, int currentFunds, int currentTime);
+    Point2d buyRobot(const std::vector<Robot> &robots, const GoodsStore &goods, const Map &gameMap, int currentFunds);
+    Point2d buyShip(const std::vector<Ship> &ships, const GoodsStore &goods, const Map &gameMap, int currentFunds);
+    Point2d getProperRobotShop(LandSeaBlock& block, const std::vector<Robot> &robots, const Map &gameMap, const GoodsStore &goods);
     Point2d getProperShipShop(LandSeaBlock& l, const Map &gameMap);
-    int buyRobotType(const std::vector<Robot> &robots, const std::vector<Goods> &goods, const Map &gameMap, int currentFunds);
+    int buyRobotType(const std::vector<Robot> &robots, const GoodsStore &goods, const Map &gameMap, int currentFunds);
     int getAssignId(Point2d shopPos, const std::vector<Berth> &berths);
 };
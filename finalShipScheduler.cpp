@@ -12,7 +12,7 @@ void FinalShipScheduler::setParameter(const Params &params)
 FinalShipScheduler::FinalShipScheduler(const std::vector<int> &berthCluster, const std::vector<std::vector<Berth>> &clusters)
     : berthCluster(std::make_shared<std::vector<int>>(berthCluster)),clusters(std::make_shared<std::vector<std::vector<Berth>>>(clusters)){}
 
-// std::vector<std::pair<ShipID, ShipActionSpace::ShipAction>> FinalShipScheduler::scheduleShips(Map &map, std::vector<Ship> &ships, std::vector<Berth> &berths, std::vector<Goods> &goods, std::vector<Robot> &robots) {
+// std::vector<std::pair<ShipID, ShipActionSpace::ShipAction>> FinalShipScheduler::scheduleShips(Map &map, std::vector<Ship> &ships, std::vector<Berth> &berths, GoodsStore &goods, std::vector<Robot> &robots) {
 //     // 1. 选定终局泊位和候选泊位，分配船只
 //     if(!hasInit) init(ships, berths, goods);    
 
@@ -164,7 +164,7 @@ FinalShipScheduler::handleShipAtVirtualPoint(Ship& ship, std::vector<Berth> &ber
 }
 
 // 初始化
-void FinalShipScheduler::init(std::vector<Ship> &ships, std::vector<Berth> &berths, std::vector<Goods> &goods){
+void FinalShipScheduler::init(std::vector<Ship> &ships, std::vector<Berth> &berths, GoodsStore &goods){
     // 初始化边界变量
     for(auto &ship : ships) maxCapacity = std::max(maxCapacity,ship.capacity);
     for(auto &berth : berths) minVelocity = std::min(minVelocity,berth.velocity),maxTime = std::max(maxTime, berth.timeToDelivery());
@@ -194,19 +194,18 @@ void FinalShipScheduler::init(std::vector<Ship> &ships, std::vector<Berth> &bert
 
 
 // 初始化泊位的状态
-void FinalShipScheduler::updateBerthStatus(std::vector<Ship> &ships,std::vector<Berth> &berths,std::vector<Goods> & goods){
+void FinalShipScheduler::updateBerthStatus(std::vector<Ship> &ships,std::vector<Berth> &berths,GoodsStore &goods){
     // 遍历泊位，初始化泊位的正常货物量和未到达货物量，计算泊位价值
     for(auto &berth : berths){
         berth.totalValue = 0;
         berth.residue_num = 0;
         berth.shipInBerthNum = 0;
-        berth.residue_num = berth.reached_goods.size();
+        berth.residue_num = berth.reachedNum();
     }
-    //  遍历货物，更新泊位的溢出货物量和价值
-    for(auto &good : goods){
-        if((good.status == 1 || good.status == 2) && berths[good.distsToBerths[0].first].isEnable()){
-             berths[good.distsToBerths[0].first].residue_num += 1;
-        }
+    // 加上正在运往泊位的货物数量
+    for(auto &berth : berths){
+        if(berth.isEnable())
+            berth.residue_num += goods.berthAssignedNum(berth.id);
     }
 }
 
@@ -490,14 +489,14 @@ bool FinalShipScheduler::shouldDepartBerth(Ship &ship,std::vector<Berth> &berths
 
 // 判断泊位上是否有货物可装载
 bool FinalShipScheduler::isThereGoodsToLoad(Berth &berth){
-    if(berth.reached_goods.size() != 0) return true;
+    if(berth.reachedNum() != 0) return true;
     else return false;
 }
 
 // 处理装货的状态
 void FinalShipScheduler::loadGoodAtBerth(Ship &ship, std::vector<Berth> &berths){
     BerthID berthId = ship.berthId;
-    int shipment = std::min(static_cast<int>(berths[berthId].reached_goods.size()),berths[berthId].velocity);
+    int shipment = std::min(berths[berthId].reachedNum(),berths[berthId].velocity);
     int res = ship.loadGoods(shipment); // 装货
-    berths[berthId].reached_goods.erase(berths[berthId].reached_goods.begin(),berths[berthId].reached_goods.begin() + res);
+    berths[berthId].takeGoods(res);
 }
\ No newline at end of file
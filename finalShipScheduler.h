@@ -11,7 +11,7 @@ public:
     void scheduleShips(Map &map,
                   std::vector<Ship> &ships,
                   std::vector<Berth> &berths,
-                  std::vector<Goods> &goods,
+                  GoodsStore &goods,
                   std::vector<Robot> &robots) override{}
     // 设置参数
     void setParameter(const Params &params) override;
@@ -72,7 +72,7 @@ private:
     // handleShipEnRouteToFinalBerth(Ship& ship, std::vector<Berth> &berths);
 
     // 初始化变量
-    void init(std::vector<Ship> &ships, std::vector<Berth> &berths, std::vector<Goods> &goods);
+    void init(std::vector<Ship> &ships, std::vector<Berth> &berths, GoodsStore &goods);
 
     // 配对终局泊位和候选泊位
     void selectFinalAndBackupBerths(std::vector<Berth> &berths);
@@ -128,7 +128,7 @@ private:
     // void disableBerth(Berth &berth);
 
     // 初始化泊位的状态
-    void updateBerthStatus(std::vector<Ship> &ships,std::vector<Berth> &berths,std::vector<Goods> & goods);
+    void updateBerthStatus(std::vector<Ship> &ships,std::vector<Berth> &berths,GoodsStore &goods);
 
     // 装货
     void loadGoodAtBerth(Ship &ship, std::vector<Berth> &berths);
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <memory_resource>
+#include <vector>
+#include <set>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// 统计向上游申请内存次数的资源，帧内缓冲区用完时才会走到这里
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    inline uint64_t allocations() const { return count; }
+
+private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        ++count;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+    {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+private:
+    uint64_t count = 0;
+};
+
+// 帧内临时数据的单调分配器：分配只移动指针，释放为空操作，帧开始时整体回到缓冲区起点
+// monotonic_buffer_resource 不是线程安全的，每个线程一份；调用 beginFrame 后各线程在下一次取用时各自重置
+// 只能给生命周期不超过一帧的局部容器使用，跨帧保存的成员容器不能使用
+class FrameArena
+{
+public:
+    static constexpr std::size_t BUFFER_SIZE = 1 << 20; // 单线程每帧的初始缓冲区大小
+
+    // 开始新的一帧，只在主线程、没有其他线程使用帧内内存时调用
+    static void beginFrame() { frameGeneration.fetch_add(1, std::memory_order_relaxed); }
+
+    // 当前线程的帧内内存资源
+    static std::pmr::memory_resource *resource()
+    {
+        FrameArena &arena = local();
+        const uint32_t generation = frameGeneration.load(std::memory_order_relaxed);
+        if (arena.generation != generation)
+        {
+            arena.arena.release();
+            arena.generation = generation;
+        }
+        return &arena.arena;
+    }
+
+    // 当前线程缓冲区用完后向全局堆申请的次数
+    static uint64_t overflowCount() { return local().upstream.allocations(); }
+
+private:
+    FrameArena() : buffer(BUFFER_SIZE), arena(buffer.data(), buffer.size(), &upstream) {}
+
+    static FrameArena &local()
+    {
+        static thread_local FrameArena arena;
+        return arena;
+    }
+
+private:
+    static inline std::atomic<uint32_t> frameGeneration{0};
+    std::vector<std::byte> buffer;
+    CountingResource upstream;
+    std::pmr::monotonic_buffer_resource arena;
+    uint32_t generation = 0;
+};
+
+// 分配在帧内内存上的容器
+template <class T>
+using FrameVector = std::pmr::vector<T>;
+template <class T, class Compare = std::less<T>>
+using FrameSet = std::pmr::set<T, Compare>;
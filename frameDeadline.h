@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <algorithm>
+
+// 有时间片的阶段，机器人和船舶的阶段可能在不同线程中同时进行
+enum class DeadlineStage
+{
+    ROBOT_SCHEDULE,    // 机器人调度
+    ROBOT_PATHFINDING, // 机器人寻路
+    ROBOT_CONFLICT,    // 机器人冲突处理
+    SHIP_CONFLICT,     // 船舶冲突处理
+    COUNT
+};
+
+// 帧内截止时间管理：以读到帧号的时刻为起点，整帧和每个阶段各有时间预算
+// 阶段开始时调用 startStage 得到截止时刻（不晚于整帧截止时刻），阶段内的搜索和分配在超时后返回已有的结果
+// 不在帧内（初始化阶段）时不设截止时刻
+class FrameDeadline
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr int STAGES = static_cast<int>(DeadlineStage::COUNT);
+
+    static FrameDeadline &instance()
+    {
+        static FrameDeadline deadline;
+        return deadline;
+    }
+
+    // 设置整帧预算和各阶段的时间片，单位微秒
+    void setBudget(int frameMicros, const std::array<int, STAGES> &stageMicros)
+    {
+        frameBudget = std::chrono::microseconds(std::max(1, frameMicros));
+        for (int i = 0; i < STAGES; ++i)
+            stageBudget[i] = std::chrono::microseconds(std::max(1, stageMicros[i]));
+    }
+
+    // 读到帧号后调用
+    void beginFrame()
+    {
+        frameStart = Clock::now();
+        frameEnd = frameStart + frameBudget;
+        stageEnd.fill(frameEnd);
+        active = true;
+    }
+
+    // 输出 OK 之后调用，超过整帧预算时计数
+    void endFrame()
+    {
+        if (active && Clock::now() > frameEnd)
+            ++lateFrames;
+        active = false;
+    }
+
+    // 开始一个阶段，返回该阶段的截止时刻；阶段的截止时刻只由执行该阶段的线程写入
+    Clock::time_point startStage(DeadlineStage stage)
+    {
+        const int index = static_cast<int>(stage);
+        stageEnd[index] = active ? std::min(frameEnd, Clock::now() + stageBudget[index]) : Clock::time_point::max();
+        return stageEnd[index];
+    }
+
+    inline Clock::time_point stageDeadline(DeadlineStage stage) const
+    {
+        return active ? stageEnd[static_cast<int>(stage)] : Clock::time_point::max();
+    }
+
+    inline bool expired(DeadlineStage stage) const { return active && Clock::now() >= stageEnd[static_cast<int>(stage)]; }
+    inline bool frameExpired() const { return active && Clock::now() >= frameEnd; }
+
+    // 整帧剩余时间不少于 micros 时返回 true，用于把不紧急的工作推迟到有余量的帧
+    inline bool hasSlack(int micros) const
+    {
+        return !active || frameEnd - Clock::now() >= std::chrono::microseconds(micros);
+    }
+
+    inline int lateFrameCount() const { return lateFrames; }
+
+private:
+    FrameDeadline() { stageBudget.fill(frameBudget); }
+
+private:
+    bool active = false;
+    Clock::duration frameBudget = std::chrono::microseconds(14000);
+    std::array<Clock::duration, STAGES> stageBudget;
+    Clock::time_point frameStart, frameEnd;
+    std::array<Clock::time_point, STAGES> stageEnd;
+    int lateFrames = 0;
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// 一帧中变化的货物
+struct GoodsDelta
+{
+    int x, y, value;
+};
+
+// 一帧中机器人的状态
+struct RobotState
+{
+    int id, carrying, x, y;
+};
+
+// 一帧中船舶的状态
+struct ShipState
+{
+    int id, goodsCount, x, y, direction, state;
+};
+
+// 一帧的全部输入，容器在帧之间复用
+struct FrameInput
+{
+    int frame = 0;
+    int money = 0;
+    std::vector<GoodsDelta> goods;
+    std::vector<RobotState> robots;
+    std::vector<ShipState> ships;
+};
+
+// 判题器输入读取，直接从标准输入文件描述符读到缓冲区，手写整数解析，不经过 iostream
+// 所有输入都必须通过该类读取，不能与 cin 混用
+// 调用 feed 后改为从内存读取，供离线回放和基准测试在进程内驱动
+class FrameInputReader
+{
+public:
+    explicit FrameInputReader(size_t capacity = 1 << 16) : buffer(capacity) {}
+
+    // 追加一段内存输入，之后不再读标准输入；已追加的内容读完时视为输入结束
+    void feed(const char *data, size_t n)
+    {
+        if (memoryHead == memory.size())
+            memory.clear(), memoryHead = 0;
+        memory.append(data, n);
+        fromMemory = true;
+    }
+
+    // 读取一个整数，输入结束返回 false
+    bool readInt(int &value)
+    {
+        int c = skipSpaces();
+        if (c < 0)
+            return false;
+        bool negative = false;
+        if (c == '-')
+        {
+            negative = true;
+            c = nextChar();
+        }
+        int result = 0;
+        while (c >= '0' && c <= '9')
+        {
+            result = result * 10 + (c - '0');
+            c = nextChar();
+        }
+        value = negative ? -result : result;
+        return true;
+    }
+
+    // 读取一个以空白分隔的单词，输入结束返回 false
+    bool readToken(std::string &token)
+    {
+        token.clear();
+        int c = skipSpaces();
+        if (c < 0)
+            return false;
+        while (c > ' ')
+        {
+            token.push_back(static_cast<char>(c));
+            c = nextChar();
+        }
+        return true;
+    }
+
+    // 读取帧号和金额，等待判题器输入的时间都在这里
+    bool readFrameHeader(FrameInput &input)
+    {
+        return readInt(input.frame) && readInt(input.money);
+    }
+
+    // 读取帧头之后的货物、机器人、船舶状态，直到 OK
+    bool readFrameBody(FrameInput &input)
+    {
+        int count;
+        if (!readInt(count))
+            return false;
+        input.goods.resize(count);
+        for (GoodsDelta &goods : input.goods)
+            if (!(readInt(goods.x) && readInt(goods.y) && readInt(goods.value)))
+                return false;
+
+        if (!readInt(count))
+            return false;
+        input.robots.resize(count);
+        for (RobotState &robot : input.robots)
+            if (!(readInt(robot.id) && readInt(robot.carrying) && readInt(robot.x) && readInt(robot.y)))
+                return false;
+
+        if (!readInt(count))
+            return false;
+        input.ships.resize(count);
+        for (ShipState &ship : input.ships)
+            if (!(readInt(ship.id) && readInt(ship.goodsCount) && readInt(ship.x) && readInt(ship.y) &&
+                  readInt(ship.direction) && readInt(ship.state)))
+                return false;
+
+        return readToken(okToken) && okToken == "OK";
+    }
+
+private:
+    // 返回当前字符并前进，缓冲区读完时从标准输入补充，输入结束返回 -1
+    inline int nextChar()
+    {
+        if (head == tail && !refill())
+            return -1;
+        return static_cast<unsigned char>(buffer[head++]);
+    }
+
+    inline int skipSpaces()
+    {
+        int c = nextChar();
+        while (c >= 0 && c <= ' ')
+            c = nextChar();
+        return c;
+    }
+
+    bool refill()
+    {
+        head = tail = 0;
+        if (fromMemory)
+        {
+            size_t n = std::min(buffer.size(), memory.size() - memoryHead);
+            if (n == 0)
+                return false;
+            std::memcpy(buffer.data(), memory.data() + memoryHead, n);
+            memoryHead += n;
+            tail = n;
+            return true;
+        }
+#ifdef _WIN32
+        int n = _read(0, buffer.data(), static_cast<unsigned>(buffer.size()));
+#else
+        ssize_t n;
+        do
+            n = read(0, buffer.data(), buffer.size());
+        while (n < 0 && errno == EINTR);
+#endif
+        if (n <= 0)
+            return false;
+        tail = static_cast<size_t>(n);
+        return true;
+    }
+
+private:
+    std::vector<char> buffer;
+    size_t head = 0, tail = 0;
+    std::string okToken;
+    bool fromMemory = false;
+    std::string memory; // 内存输入，fromMemory 时使用
+    size_t memoryHead = 0;
+};
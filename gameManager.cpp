@@ -5,7 +5,13 @@
 #include <chrono>
 #include <thread>
 #include "log.h"
+#include "threadPool.h"
+#include "profiler.h"
+#include "frameDeadline.h"
+#include "frameArena.h"
+#include "mapArtifacts.h"
 #include "greedyRobotScheduler.h"
+#include "auctionRobotScheduler.h"
 #include "greedyShipScheduler.h"
 #include "finalShipScheduler.h"
 #include "earlyGameAssetManager.h"
@@ -41,13 +47,29 @@ void findPathWrapper(const Map &gameMap, const VectorPosition startVP, const Vec
 }
 
 void GameManager::initializeGame()
+{
+    loadInitialState();
+    configureComponents();
+    if (initInputComplete)
+    {
+        LOGI("Init complete.");
+        // 初始化阶段没有指令，只输出 OK
+        commandManager.outputCommands();
+    }
+    else
+    {
+        LOGE("Init fail!");
+    }
+}
+
+void GameManager::loadInitialState()
 {
     // 读取地图
     string map_data;
     int robot_id = 0;
     for (int i = 0; i < MAPROWS; ++i)
     {
-        cin >> map_data;
+        input.readToken(map_data);
         for (int j = 0; j < MAPCOLS; ++j)
         {
             // if(i == j) diagonal += map_data[j];
@@ -101,16 +123,20 @@ void GameManager::initializeGame()
         }
     }
     this->gameMap.readOnlyGrid = this->gameMap.grid;
+    this->gameMap.computeShipPoseMask();
 
     // LOGI("Log init map info");
     // LOGI(this->gameMap.drawMap());
 
     // 初始化泊位
     int id, x, y, time, velocity, berthNum;
-    cin >> berthNum;
+    input.readInt(berthNum);
     for (int i = 0; i < berthNum; ++i)
     {
-        cin >> id >> x >> y >> velocity;
+        input.readInt(id);
+        input.readInt(x);
+        input.readInt(y);
+        input.readInt(velocity);
         Berth berth(id, Point2d(x,y), velocity);
         berth.orientation = this->gameMap.computeBerthOrientation(berth.pos);
         this->berths.push_back(berth);
@@ -122,7 +148,7 @@ void GameManager::initializeGame()
         LOGI("ID: ", berth.id, " POS: ", berth.pos, " velocity: ", berth.velocity, " orientation: ", static_cast<int>(berth.orientation));
 
     // 初始化船舶
-    cin >> Ship::capacity;
+    input.readInt(Ship::capacity);
 
     // 初始化数据读取完成
     // 进行其他部件的初始化
@@ -131,16 +157,8 @@ void GameManager::initializeGame()
     
 
     string ok;
-    cin >> ok;
-    if (ok == "OK")
-    {
-        LOGI("Init complete.");
-        cout << "OK" << std::endl;
-    }
-    else
-    {
-        LOGE("Init fail!");
-    }
+    input.readToken(ok);
+    initInputComplete = ok == "OK";
     
     // 打印单行路
     // LOGI("单行路数量：",this->singleLaneManager.singleLanes.size());
@@ -159,97 +177,35 @@ void GameManager::initializeGame()
 void GameManager::initializeComponents()
 {
     // 8. 判断地图类型，后续封装在其他函数中实现
-    MapFlag mapType = this->gameMap.getMapType();
+    mapType = this->gameMap.getMapType();
     // 1. 让地图实时跟踪机器人位置
     // for (Robot &robot : this->robots)
     //     this->gameMap.robotPosition.push_back(robot.pos);
 
-    // 1. 使用 BFS 计算地图上每个点到泊位的距离
-    for (auto &berth : this->berths)
-    {
-        vector<Point2d> positions;
-        // 泊位大小 4x4
-        for (int i = 0; i < 4; ++i)
-            for (int j = 0; j < 4; ++j)
-                positions.push_back(berth.pos + Point2d(i, j));
-
-        this->gameMap.computeDistancesToBerthViaBFS(berth.id, positions);
-        this->gameMap.computeMaritimeBerthDistanceViaBFS(berth.id, positions);
-        // berth.distsToDelivery = this->gameMap.initializeBerthToDeliveryDistances(berth.id);
-    }
-
-    // 2. 预先计算海图航线
-    // 计算泊位之间的航线
-    std::vector<std::thread> threads;
-    std::vector<std::thread> backgroundThreads;
-    // 计算泊位间的航线
-    for(int i = 0; i < berths.size(); ++i)
+    // 1, 2. 泊位距离场和航线只与地图有关，有匹配的快照时直接读取，否则计算后在后台保存快照
     {
-        for(int j = 0; j < berths.size(); ++j)
+        MapArtifactStore artifacts(artifactDirectory);
+        const uint64_t mapHash = MapArtifactStore::mapHash(gameMap, berths);
+        auto start = std::chrono::steady_clock::now();
+        if (artifacts.load(mapHash, gameMap))
         {
-            if(i == j)
-                continue;
-            if(gameMap.maritimeBerthDistanceMap[i].at(berths[j].pos.x).at(berths[j].pos.y) >= INT_MAX)
-                continue;
-            VectorPosition startVP(berths[i].pos, berths[i].orientation);
-            VectorPosition targetVP(berths[j].pos, berths[j].orientation);
-            threads.emplace_back(findPathWrapper, std::ref(gameMap), startVP, targetVP);
+            LOGI("读取预计算快照: ", artifacts.path(mapHash), ", 时间: ",
+                 std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count(), " us");
         }
-    }
-    // 计算泊位到交货点的航线
-    for(int i = 0; i < berths.size(); ++i)
-    {
-        for(int j = 0; j < gameMap.deliveryLocations.size(); ++j)
+        else
         {
-            Point2d deliveryLocation = gameMap.deliveryLocations[j];
-            if(gameMap.maritimeBerthDistanceMap[i].at(deliveryLocation.x).at(deliveryLocation.y) >= INT_MAX)
-                continue;
-            VectorPosition startVP(berths[i].pos, berths[i].orientation);
-            VectorPosition targetVP(deliveryLocation, Direction::EAST);
-            if(gameMap.passable(targetVP)) {
-                threads.emplace_back(findPathWrapper, std::ref(gameMap), startVP, targetVP);
-                threads.emplace_back(findPathWrapper, std::ref(gameMap), targetVP, startVP);
-                if(mapType == MapFlag::MAP3) continue;
-            }
-            targetVP.direction = Direction::WEST;
-            if(gameMap.passable(targetVP)) {
-                threads.emplace_back(findPathWrapper, std::ref(gameMap), startVP, targetVP);
-                threads.emplace_back(findPathWrapper, std::ref(gameMap), targetVP, startVP);
-                if(mapType == MapFlag::MAP3) continue;
-            }
-            targetVP.direction = Direction::NORTH;
-            if(gameMap.passable(targetVP)) {
-                threads.emplace_back(findPathWrapper, std::ref(gameMap), startVP, targetVP);
-                threads.emplace_back(findPathWrapper, std::ref(gameMap), targetVP, startVP);
-                if(mapType == MapFlag::MAP3) continue;
-            }
-            targetVP.direction = Direction::SOUTH;
-            if(gameMap.passable(targetVP)) {
-                threads.emplace_back(findPathWrapper, std::ref(gameMap), startVP, targetVP);
-                threads.emplace_back(findPathWrapper, std::ref(gameMap), targetVP, startVP);
-                if(mapType == MapFlag::MAP3) continue;
-            }
+            computeDistanceFieldsAndSeaRoutes();
+            LOGI("计算距离场和航线时间: ",
+                 std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count(), " ms");
+            artifacts.saveAsync(mapHash, gameMap);
         }
     }
-    // 计算船舶购买点到泊位的航线
-    for(int i = 0; i < berths.size(); ++i)
+    // 连通块标号和泊位间陆地距离由距离场推出，后续的聚类、连通块划分和孤立机器人判断都查询它们
     {
-        for(int j = 0; j < gameMap.shipShops.size(); ++j)
-        {
-            Point2d shipShop = gameMap.shipShops[j];
-            if(gameMap.maritimeBerthDistanceMap[i].at(shipShop.x).at(shipShop.y) >= INT_MAX)
-                continue;
-            VectorPosition startVP(shipShop, Direction::EAST);
-            VectorPosition targetVP(berths[i].pos, berths[i].orientation);
-            threads.emplace_back(findPathWrapper, std::ref(gameMap), startVP, targetVP);
-        }
-    }
-    // 等待所有线程完成
-    // for(auto& t : backgroundThreads) {
-    //     t.detach();
-    // }
-    for(auto& t : threads) {
-        t.join();
+        auto start = std::chrono::steady_clock::now();
+        gameMap.computeConnectedComponents(berthAreas());
+        LOGI("计算连通块时间: ",
+             std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count(), " us");
     }
 
     // 3. 根据航线距离更新 berthToBerthDistance, berthToDeliveryDistance, berth.distsToDelivery
@@ -266,7 +222,7 @@ void GameManager::initializeComponents()
             }
             VectorPosition startVP(berths[i].pos, berths[i].orientation);
             VectorPosition targetVP(berths[j].pos, berths[j].orientation);
-            gameMap.berthToBerthDistance.at(berths[i].id).at(berths[j].id) = SeaRoute::getPathLength(this->gameMap, startVP, targetVP);
+            gameMap.berthToBerthDistance.at(berths[i].id).at(berths[j].id) = SeaRoute::getPathLength(startVP, targetVP);
         }
         LOGI(Log::printVector(gameMap.berthToBerthDistance[i]));
     }
@@ -277,8 +233,8 @@ void GameManager::initializeComponents()
         {
             Point2d deliveryLocation = gameMap.deliveryLocations[j];
             VectorPosition startVP(berths[i].pos, berths[i].orientation);
-            VectorPosition targetVP(deliveryLocation, Direction::EAST);
-            int length  = SeaRoute::getPathLength(this->gameMap, startVP, targetVP);
+            // 交货点取代价最小的朝向
+            int length  = SeaRoute::getPathLength(startVP, deliveryLocation);
             gameMap.berthToDeliveryDistance.at(berths[i].id).at(j) = length;
             berths[i].distsToDelivery.emplace_back(j, length);
         }
@@ -296,17 +252,8 @@ void GameManager::initializeComponents()
     // 5. 判断机器人是否 DEATH 状态
     for (auto &robot : this->robots)
     {
-        bool is_isolated = true;
-        for (const auto &berth : this->berths)
-        {
-            if (this->gameMap.isBerthReachable(berth.id, robot.pos))
-            {
-                is_isolated = false;
-                break;
-            }
-        }
         // 孤立机器人
-        if (is_isolated)
+        if (!this->gameMap.reachesAnyBerthByLand(robot.pos))
         {
             robot.status = DEATH;
             LOGI("死機器人:", robot.id);
@@ -324,31 +271,157 @@ void GameManager::initializeComponents()
     this->seaSingleLaneManager.init(gameMap);
     end = std::chrono::steady_clock::now();
     LOGI("初始化海洋单行路时间: ",std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()," ms");
+}
+
+vector<std::pair<BerthID, vector<Point2d>>> GameManager::berthAreas() const
+{
+    vector<std::pair<BerthID, vector<Point2d>>> areas;
+    for (const auto &berth : this->berths)
+    {
+        vector<Point2d> positions;
+        // 泊位大小 4x4
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                positions.push_back(berth.pos + Point2d(i, j));
+        areas.emplace_back(berth.id, std::move(positions));
+    }
+    return areas;
+}
+
+void GameManager::computeDistanceFieldsAndSeaRoutes()
+{
+    // 1. 使用 BFS 计算地图上每个点到泊位的距离
+    this->gameMap.computeAllBerthDistanceFields(berthAreas());
+
+    // 2. 预先计算海图航线
+    // 计算泊位之间的航线，所有航线作为任务提交到线程池
+    ThreadPool routePool;
+    auto submitRoute = [this, &routePool](const VectorPosition &startVP, const VectorPosition &targetVP)
+    {
+        routePool.submit([this, startVP, targetVP]()
+                         { findPathWrapper(gameMap, startVP, targetVP); });
+    };
+    // 计算泊位间的航线
+    for(int i = 0; i < berths.size(); ++i)
+    {
+        for(int j = 0; j < berths.size(); ++j)
+        {
+            if(i == j)
+                continue;
+            if(gameMap.maritimeBerthDistanceMap.get(i, berths[j].pos.x, berths[j].pos.y) >= INT_MAX)
+                continue;
+            VectorPosition startVP(berths[i].pos, berths[i].orientation);
+            VectorPosition targetVP(berths[j].pos, berths[j].orientation);
+            submitRoute(startVP, targetVP);
+        }
+    }
+    // 计算泊位到交货点的航线
+    for(int i = 0; i < berths.size(); ++i)
+    {
+        for(int j = 0; j < gameMap.deliveryLocations.size(); ++j)
+        {
+            Point2d deliveryLocation = gameMap.deliveryLocations[j];
+            if(gameMap.maritimeBerthDistanceMap.get(i, deliveryLocation.x, deliveryLocation.y) >= INT_MAX)
+                continue;
+            VectorPosition startVP(berths[i].pos, berths[i].orientation);
+            VectorPosition targetVP(deliveryLocation, Direction::EAST);
+            if(gameMap.passable(targetVP)) {
+                submitRoute(startVP, targetVP);
+                submitRoute(targetVP, startVP);
+                if(mapType == MapFlag::MAP3) continue;
+            }
+            targetVP.direction = Direction::WEST;
+            if(gameMap.passable(targetVP)) {
+                submitRoute(startVP, targetVP);
+                submitRoute(targetVP, startVP);
+                if(mapType == MapFlag::MAP3) continue;
+            }
+            targetVP.direction = Direction::NORTH;
+            if(gameMap.passable(targetVP)) {
+                submitRoute(startVP, targetVP);
+                submitRoute(targetVP, startVP);
+                if(mapType == MapFlag::MAP3) continue;
+            }
+            targetVP.direction = Direction::SOUTH;
+            if(gameMap.passable(targetVP)) {
+                submitRoute(startVP, targetVP);
+                submitRoute(targetVP, startVP);
+                if(mapType == MapFlag::MAP3) continue;
+            }
+        }
+    }
+    // 计算船舶购买点到泊位的航线
+    for(int i = 0; i < berths.size(); ++i)
+    {
+        for(int j = 0; j < gameMap.shipShops.size(); ++j)
+        {
+            Point2d shipShop = gameMap.shipShops[j];
+            if(gameMap.maritimeBerthDistanceMap.get(i, shipShop.x, shipShop.y) >= INT_MAX)
+                continue;
+            VectorPosition startVP(shipShop, Direction::EAST);
+            VectorPosition targetVP(berths[i].pos, berths[i].orientation);
+            submitRoute(startVP, targetVP);
+        }
+    }
+    // 等待所有航线计算完成
+    routePool.wait();
+}
+
+void GameManager::configureComponents()
+{
     // 9. 读取参数
-    // 初始化超参数
+    // 初始化超参数，paramReader 中有值的参数覆盖地图默认值
     Params params(mapType);
     // 从文件读取参数
     // this->paramReader.logParams(params);
 #ifdef DEBUG
     // this->paramReader.readParams(std::string("../param/param_now.txt"));
-
-    // this->paramReader.setParams(params);
 #endif
+    this->paramReader.setParams(params);
     // 设置终局参数
     FINAL_FRAME = params.FINAL_FRAME;   // 设置终局参数
     SHIP_STILL_FRAMES_LIMIE = params.SHIP_STILL_FRAMES_LIMIE;
     LOGI("终局帧数：", FINAL_FRAME);
     LOGI("船阻塞帧数限制：", SHIP_STILL_FRAMES_LIMIE);
+    // 建立机器人分层寻路的抽象图，单行路两端作为额外的入口节点
+    // 船舶不分层：船用分层路线时 map2 上会在离港和靠泊之间反复，船只用预存航线和完整寻路
+    if (params.HierarchicalPathfinding)
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Point2d> landChokepoints;
+        for (int laneId = 1; laneId < static_cast<int>(singleLaneManager.singleLanes.size()); ++laneId)
+        {
+            const std::vector<Point2d> &lane = singleLaneManager.singleLanes[laneId];
+            if (lane.empty())
+                continue;
+            landChokepoints.push_back(lane.front());
+            landChokepoints.push_back(lane.back());
+        }
+        HierarchicalGraph<Point2d> &landHierarchy = HierarchicalGraph<Point2d>::getInstance();
+        landHierarchy.build(gameMap, params.HierarchicalClusterSize, landChokepoints, params.HierarchicalMinDistance, params.HierarchicalLookahead);
+        auto end = std::chrono::steady_clock::now();
+        LOGI("初始化分层寻路时间: ", std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count(), " ms, 陆地节点: ",
+             landHierarchy.nodeCount(), " 边: ", landHierarchy.edgeCount());
+    }
     // 10. 初始化 RobotController
     this->robotController = std::make_shared<RobotController>(this->robots);
+    this->robotController->setParameter(params);
     this->shipController = std::make_shared<ShipController>();
+    FrameDeadline::instance().setBudget(params.FrameBudgetMicros, {params.RobotScheduleBudgetMicros, params.RobotPathfindingBudgetMicros,
+                                                                   params.RobotConflictBudgetMicros, params.ShipConflictBudgetMicros});
+    deferredWorkSlack = params.DeferredWorkSlackMicros;
+    if (params.ParallelFramePipeline && std::thread::hardware_concurrency() > 1)
+        framePool = std::make_unique<ThreadPool>(1);
     // 11. 对泊位进行聚类
     this->berthAssignAndControlService.setParameter(params);
     this->berthAssignAndControlService.initialize(this->gameMap,this->berths);
     std::vector<int> &berthCluster = this->berthAssignAndControlService.berthCluster;
     std::vector<std::vector<Berth>> &clusters = this->berthAssignAndControlService.clusters;
     // 12. 注册机器人调度函数
-    robotScheduler = std::make_shared<GreedyRobotScheduler>(clusters, berthCluster);
+    if (params.BatchedRobotScheduling)
+        robotScheduler = std::make_shared<AuctionRobotScheduler>(clusters, berthCluster);
+    else
+        robotScheduler = std::make_shared<GreedyRobotScheduler>(clusters, berthCluster);
     // 13. 注册船舶调度函数
     shipScheduler = std::make_shared<GreedyShipScheduler>();
     // 14. 注册资产管理类
@@ -363,6 +436,9 @@ void GameManager::initializeComponents()
     this->assetManager->init(this->gameMap, berths);
     // 18. 初始化统计信息
     goodsExpiredMap = vector<vector<int>> (MAPROWS, vector<int>(MAPCOLS, 0));
+    // 19. 初始化货物生成热力图，之后生成的货物都会记入
+    if (params.SpawnHeatmapPositioning)
+        goods.spawnHeatmap().init(gameMap.rows, gameMap.cols, params.SpawnHeatmapTileSize);
 }
 
 void GameManager::statisticGoods(int value, std::unordered_map<std::string, int> &statisticMap)
@@ -408,21 +484,28 @@ void GameManager::statisticGoods(int value, std::unordered_map<std::string, int>
 
 void GameManager::processFrameData()
 {
-    int newItemCount;
-    int goodsX, goodsY, value;
-    int carrying, robotX, robotY, robotState;
-    // int shipState, berthId;
-    // 如果读取到了 EOF，则结束
-    if (cin.eof())
-    {
-        exit(0);
-    }
-    
     // 清除临时障碍
     LOGI("=======================================新的一帧====================================");
     gameMap.clearTemporaryObstacles();
 
-    cin >> this->currentFrame >> this->currentMoney;
+    // 判题器关闭输入时输出性能报告并结束
+    if (!input.readFrameHeader(frameInput))
+    {
+        LOGI(FrameProfiler::instance().report());
+        exit(0);
+    }
+    PROFILE_BEGIN_FRAME(frameInput.frame);
+    FrameDeadline::instance().beginFrame();
+    FrameArena::beginFrame();
+    PROFILE_SCOPE(PARSE);
+    if (!input.readFrameBody(frameInput))
+    {
+        LOGE("帧数据不完整");
+        LOGI(FrameProfiler::instance().report());
+        exit(0);
+    }
+    this->currentFrame = frameInput.frame;
+    this->currentMoney = frameInput.money;
     LOGI("当前帧数：", this->currentFrame, ",当前金额：", this->currentMoney);
     CURRENT_MONEY = this->currentMoney;
     int skipFrame = this->currentFrame - CURRENT_FRAME - 1;
@@ -430,14 +513,13 @@ void GameManager::processFrameData()
     if(skipFrame)
         LOGW("跳帧: ", skipFrame);
     CURRENT_FRAME = this->currentFrame;
-    // 货物生命周期维护
-    for (auto& good : goods){
-        // todo 边界条件
-        if(good.TTL != INT_MAX && good.TTL >= 0){
-            // LOGI(good.id,",initFrame:",good.initFrame,",currentFrame:",currentFrame,",TTL:",good.TTL);
-            good.TTL = std::max(1000-(currentFrame - good.initFrame),-1);
+    // 货物生命周期维护，只遍历仍在计时的货物
+    {
+        PROFILE_SCOPE(GOODS_TTL);
+        goods.advanceFrame(currentFrame, [this](const Goods &good)
+        {
 #ifdef DEBUG
-            if (good.TTL == -1 && !good.distsToBerths.empty())
+            if (!good.distsToBerths.empty())
             {
                 goodsExpiredMap[good.pos.x][good.pos.y]++;
                 statisticGoods(good.value, expiredGoodsValueDistribution);
@@ -447,15 +529,13 @@ void GameManager::processFrameData()
                     LOGW("货物过期 ID: ", good.id, ", value: ", good.value, ", pos: ", good.pos, ", distsToBerths: ", good.distsToBerths[0].first, " : ", good.distsToBerths[0].second);
             }
 #endif
-        }
+        });
     }
     // 读取变化货物
     // TODO: 使用Map::computePointToBerthsDistances计算货物到泊位距离
-    cin >> newItemCount;
-    // LOGI("变化货物数量：", newItemCount);
-    while (newItemCount--)
+    // LOGI("变化货物数量：", frameInput.goods.size());
+    for (const auto &[goodsX, goodsY, value] : frameInput.goods)
     {
-        cin >> goodsX >> goodsY >> value;
         // 金额为 0 表示上一帧被拿取或者该帧消失
         if (value==0) 
             continue;
@@ -467,7 +547,7 @@ void GameManager::processFrameData()
 
         Goods good(Point2d(goodsX, goodsY), value, currentFrame);
         good.distsToBerths = gameMap.computePointToBerthsDistances(Point2d(goodsX, goodsY));
-        this->goods.push_back(good);
+        this->goods.add(good);
 
         int tempGoodDistrubtID = this->gameMap.getNearestBerthID(Point2d(goodsX, goodsY));
         if(tempGoodDistrubtID>=0 && tempGoodDistrubtID<berths.size()) {
@@ -476,13 +556,11 @@ void GameManager::processFrameData()
         }
     }
     // 读取机器人状态
-    int robotNum=0, robotId, carryNum;
-    std::cin >> robotNum;
-    // LOGI("机器人数目：",robotNum);
+    // LOGI("机器人数目：",frameInput.robots.size());
     int tmp = 0;
-    for (int i = 0; i < robotNum; ++i)
+    for (int i = 0; i < frameInput.robots.size(); ++i)
     {
-        cin >> robotId >> carryNum >> robotX >> robotY;
+        const auto &[robotId, carryNum, robotX, robotY] = frameInput.robots[i];
         // 创建机器人
         if (i >= this->robots.size()) {
             // 根据购买类型设置机器人
@@ -507,13 +585,11 @@ void GameManager::processFrameData()
     }
 
     // 读取船舶状态
-    int shipNum, shipId, goodsCount, shipX, shipY, direction, shipState;
-    std::cin >> shipNum;
-    // LOGI("轮船数目：", shipNum);
+    // LOGI("轮船数目：", frameInput.ships.size());
     int unreachValue = 0;
-    for (int i = 0; i < shipNum; ++i)
+    for (int i = 0; i < frameInput.ships.size(); ++i)
     {
-        cin >> shipId >> goodsCount >> shipX >> shipY >> direction >> shipState;
+        const auto &[shipId, goodsCount, shipX, shipY, direction, shipState] = frameInput.ships[i];
         if (i >= this->ships.size())
             this->ships.emplace_back(Ship(shipId));
         int lastFrameGoodsCount = this->ships[shipId].goodsCount;   //  上一帧载货量
@@ -560,25 +636,7 @@ void GameManager::processFrameData()
     if (this->currentFrame == 15000){
         LOGI("因未到达交货点损失的货物价值：", unreachValue);
     }
-    // 确认已接收完本帧的所有数据
-    string ok;
-    cin >> ok;
-
-    // 初始化泊位货物状态
-    for(auto &berth : berths){
-        berth.unreached_goods = std::vector<Goods>();
-        // berth.reached_goods = std::vector<Goods>();
-    }
-    if(currentFrame % 500 == 0)
-    {
-        LOGI("输出泊位信息");
-        for(auto &berth : berths)
-            LOGI("Berth ID: ", berth.id, ", totalValue: ",berth.totalValue);
-        LOGI("输出船舶信息");
-        for(auto &ship : ships)
-            ship.info();
-        LOGI("机器人数目: ", robots.size());
-    }
+    // 本帧数据（包括 OK）已由 readFrameBody 读完
     // LOGI("processFrameData done");
 }
 
@@ -600,11 +658,11 @@ void GameManager::robotControl()
         // if (robot.status==DEATH) continue;
         if (robot.status==MOVING_TO_GOODS && robot.targetid!=-1 && robot.pos == goods[robot.targetid].pos) {
             LOGI("开始取货");
-            if (goods[robot.targetid].TTL>0) {
-                commandManager.addRobotCommand(robot.get());
+            if (goods.ttl(robot.targetid)>0) {
+                commandManager.robotGet(robot.id);
                 // robot.carryingItem = 1;
                 robot.carryingItem++;
-                goods[robot.targetid].TTL = INT_MAX;
+                goods.markPickedUp(robot.targetid);
 #ifdef DEBUG
                 statisticGoods(goods[robot.targetid].value, getGoodsValueDistribution);
 #endif
@@ -634,23 +692,23 @@ void GameManager::robotControl()
             // LOGI(robot);
             if (canUnload(robot.pos, gameMap)) {
                 LOGI("機器人",robot.id,"放貨 ");
-                commandManager.addRobotCommand(robot.pull());
+                commandManager.robotPull(robot.id);
                 int x = robot.pos.x-berth.pos.x, y=robot.pos.y-berth.pos.y;
                 if(currentFrame < 15000 - berth.timeToDelivery()){
                     Berth::deliverGoodNum += 1;
                     totalGetGoodsValue += goods[robot.carryingItemId].value;
-                    berth.reached_goods.push_back(goods[robot.carryingItemId]);
-                    goods[robot.carryingItemId].status = 3;
+                    berth.receiveGoods(goods[robot.carryingItemId]);
+                    goods.setStatus(robot.carryingItemId, 3);
                     if (robot.type==1 && robot.carryingItemId2!=-1) {
                         Berth::deliverGoodNum++;
                         totalGetGoodsValue += goods[robot.carryingItemId2].value;
-                        berth.reached_goods.push_back(goods[robot.carryingItemId2]);
+                        berth.receiveGoods(goods[robot.carryingItemId2]);
                     }
                 }
                 LOGI("机器人效率统计, 当前时间, ",currentFrame,", robotID, ", robot.id, ", goodValue, ", goods[robot.carryingItemId].value, ", berthID, ", berth.id);
-                goods[robot.carryingItemId].status = 3;
+                goods.setStatus(robot.carryingItemId, 3);
                 if (robot.type==1 && robot.carryingItemId2!=-1)
-                    goods[robot.carryingItemId2].status = 3;
+                    goods.setStatus(robot.carryingItemId2, 3);
                 robot.status = MOVING_TO_GOODS;
                 robot.carryingItem = 0;
                 robot.carryingItemId = -1;
@@ -677,27 +735,34 @@ void GameManager::robotControl()
     //     LOGI("機器人調度進入終局");
     // }
     
-    auto start = std::chrono::steady_clock::now();
     // 对所有需要调度的机器人进行调度
-    this->robotScheduler->scheduleRobots(gameMap, robots, goods, berths, currentFrame);
-
-    auto end = std::chrono::steady_clock::now();
-    LOGI("scheduleRobots时间: ",std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()," ms");
+    {
+        PROFILE_SCOPE(ROBOT_SCHEDULE);
+        FrameDeadline::instance().startStage(DeadlineStage::ROBOT_SCHEDULE);
+        this->robotScheduler->scheduleRobots(gameMap, robots, goods, berths, currentFrame);
+    }
     // LOGI("機器人調度完畢");
+}
 
+void GameManager::robotMotionControl()
+{
     // 执行动作
     robotController->runController(gameMap, this->singleLaneManager);
     // LOGI("機器人尋路完畢");
     // 维护单行路的锁
-    updateSingleLaneLocks();
+    {
+        PROFILE_SCOPE(LANE_LOCK);
+        updateSingleLaneLocks();
+    }
     
     // 输出指令
     for (Robot& robot : robots) {
         if (robot.status==DEATH) continue;
         if (!robot.path.empty()) {
-            string command = robot.movetoNextPosition();
-            // if (robotDebugOutput) LOGI(robot.id, "向货物移动中:", command, " 路径长度: ",robot.path.size());
-            commandManager.addRobotCommand(command);
+            int direction = robot.nextMoveDirection();
+            // if (robotDebugOutput) LOGI(robot.id, "向货物移动中:", direction, " 路径长度: ",robot.path.size());
+            if (direction != -1)
+                commandManager.robotMove(robot.id, direction);
         }
     }
     
@@ -705,17 +770,27 @@ void GameManager::robotControl()
 
 void GameManager::shipControl(){
     // 重置水路单行路的锁情况
-    this->seaSingleLaneManager.initSeaSingleLineLock(ships);
+    {
+        PROFILE_SCOPE(LANE_LOCK);
+        this->seaSingleLaneManager.initSeaSingleLineLock(ships);
+    }
 
-    auto start = std::chrono::steady_clock::now();
     // 执行船调度
-    this->shipScheduler->scheduleShips(this->gameMap, this->ships, this->berths, this->goods, this->robots);
+    {
+        PROFILE_SCOPE(SHIP_SCHEDULE);
+        this->shipScheduler->scheduleShips(this->gameMap, this->ships, this->berths, this->goods, this->robots);
+    }
     LOGI("执行完船调度");
+}
+
+void GameManager::shipMotionControl()
+{
     // 对需要移动的船执行shipControl
     // todo 修改为海洋单行路
-    shipController->runController(gameMap,this->ships, this->seaSingleLaneManager);
-    auto end = std::chrono::steady_clock::now();
-    LOGI("shipControl: ",std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()," ms");
+    {
+        PROFILE_SCOPE(SHIP_CONTROL);
+        shipController->runController(gameMap,this->ships, this->seaSingleLaneManager);
+    }
     // 执行指令
     for (Ship& ship : ships) {
         // 恢复状态
@@ -723,29 +798,44 @@ void GameManager::shipControl(){
         // 靠泊
         if (ship.shipStatus == ShipStatusSpace::ShipStatus::LOADING && ship.state == 0){
             // LOGI("执行靠泊指令");
-            commandManager.addShipCommand(ship.berth());
-            // LOGI("执行指令：", ship.berth());
+            commandManager.shipBerth(ship.id);
         }
         // 判断是否需要离港
         else if (ship.shouldDept){
             LOGI("离港指令：", ship);
-            string command = ship.dept();
+            commandManager.shipDept(ship.id);
             ship.resetDeptStatus();
-            commandManager.addShipCommand(command);
         }
         // 移动指令
         else if(!ship.path.empty()){
             // LOGI("进去移动指令");
-            string command = ship.movetoNextPosture();
-            // LOGI("船", ship.id, "执行指令：",command);
-            // ship.info();
-            commandManager.addShipCommand(command);
+            switch (ship.nextMoveType())
+            {
+            case ShipMoveType::FORWARD:
+                commandManager.shipForward(ship.id);
+                break;
+            case ShipMoveType::CLOCKWISE:
+                commandManager.shipRotate(ship.id, RotationDirection::Clockwise);
+                break;
+            case ShipMoveType::ANTICLOCKWISE:
+                commandManager.shipRotate(ship.id, RotationDirection::AntiClockwise);
+                break;
+            default:
+                break;
+            }
         }
     }
 }
 
 void GameManager::assetControl()
 {
+    PROFILE_SCOPE(ASSET);
+    // 整帧已经超时时推迟到下一帧再做购买决策
+    if (FrameDeadline::instance().frameExpired())
+    {
+        LOGW("帧超时，推迟购买决策");
+        return;
+    }
     std::vector<PurchaseDecision> purchaseDecisions =
         assetManager->makePurchaseDecision(gameMap, goods, robots, ships, berths,
                                            currentMoney, currentFrame);
@@ -755,13 +845,13 @@ void GameManager::assetControl()
         if (purchaseDecision.assetType == AssetType::ROBOT)
             for (int i = 0; i < purchaseDecision.quantity; ++i) {
                 robotsPurchaseType.push_back(purchaseDecision.type);
-                commandManager.addRobotCommand(Robot::lbot(purchaseDecision.pos, purchaseDecision.type));
+                commandManager.purchaseRobot(purchaseDecision.pos, purchaseDecision.type);
                 // 集中搬货
                 robotScheduler->assignedBerthID = BerthID(purchaseDecision.assignId);
             }
         else if (purchaseDecision.assetType == AssetType::SHIP)
             for (int i = 0; i < purchaseDecision.quantity; ++i)
-                commandManager.addShipCommand(Ship::lboat(purchaseDecision.pos));
+                commandManager.purchaseShip(purchaseDecision.pos);
     }
 }
 
@@ -769,28 +859,28 @@ void GameManager::update()
 {   
     LOGI("集中搬货：", robotScheduler->assignedBerthID);
 
-    auto start = std::chrono::steady_clock::now();
-    
     bool robotDebugOutput = false;
     bool shipDebugOutput = true;
 
+    // 取放货和调度会读写货物、泊位和机器人状态，按顺序执行
+    // 原来船舶调度在机器人寻路之后；船舶调度只读机器人的 carryingItem 和 targetid 估计泊位未来货物，
+    // 机器人寻路只在寻路失败时清空 targetid，所以只有寻路失败的那一帧会多算一个目标，各图 5 个种子得分与原顺序完全一致
     robotControl();
+    shipControl();
 
-
-    auto end = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    LOGI("robotControl时长:",duration.count(),"ms");
-    if(duration.count() > 15){
-        LOGI("机器人调度掉帧：",duration.count());
+    // 寻路和冲突处理只涉及各自的状态、单行路锁、指令缓冲和地图上各自的临时障碍层，可以并行
+    // 船舶在常驻线程上执行，机器人在主线程执行，两者都完成后再进入购买决策和指令输出
+    if (framePool)
+    {
+        framePool->submit([this]()
+                          { shipMotionControl(); });
+        robotMotionControl();
+        framePool->wait();
     }
-
-    start = std::chrono::steady_clock::now();
-    shipControl();
-    end = std::chrono::steady_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    LOGI("shipControl时长:",duration.count(),"ms");
-    if(duration.count() > 15){
-        LOGI("船调度掉帧：",duration.count());
+    else
+    {
+        robotMotionControl();
+        shipMotionControl();
     }
 
     // if(shipDebugOutput){LOGI("船只开始调度");};
@@ -829,8 +919,20 @@ void GameManager::update()
 
 void GameManager::logStatisticsInfo()
 {
+    // 定期统计不紧急，到期后在有余量的帧输出
+    if (currentFrame >= nextStatisticsFrame && FrameDeadline::instance().hasSlack(deferredWorkSlack))
+    {
+        LOGI("输出泊位信息");
+        for(auto &berth : berths)
+            LOGI("Berth ID: ", berth.id, ", totalValue: ",berth.totalValue);
+        LOGI("输出船舶信息");
+        for(auto &ship : ships)
+            ship.info();
+        LOGI("机器人数目: ", robots.size(), ", 超时帧数: ", FrameDeadline::instance().lateFrameCount(), ", 帧内内存溢出次数: ", FrameArena::overflowCount());
+        nextStatisticsFrame = (currentFrame / 500 + 1) * 500;
+    }
     if(currentFrame>=14900 && currentFrame <= 14905){
-        LOGI("skipFrame: ", skipFrame, ", 已搬运到泊位的货物价值: ", totalGetGoodsValue);
+        LOGI("skipFrame: ", skipFrame, ", 超时帧数: ", FrameDeadline::instance().lateFrameCount(), ", 已搬运到泊位的货物价值: ", totalGetGoodsValue);
         LOGI("berthDistrubtGoodNumCount: ",Log::printVector(berthDistrubtGoodNumCount));
         LOGI("berthDistrubtGoodValueCount: ",Log::printVector(berthDistrubtGoodValueCount));
         LOGI("理论最大货物价值: ", std::accumulate(berthDistrubtGoodValueCount.begin(), berthDistrubtGoodValueCount.end(),0));
@@ -838,6 +940,11 @@ void GameManager::logStatisticsInfo()
     }
     if(currentFrame >=14990 && currentFrame <= 15000){
         LOGI("游戏结束");
+        if (!profileReported)
+        {
+            LOGI(FrameProfiler::instance().report());
+            profileReported = true;
+        }
         // 输出统计结果
         LOGI("生成货物价值分布");
         for (const auto &entry : generateGoodsValueDistribution)
@@ -857,10 +964,8 @@ void GameManager::logStatisticsInfo()
         LOGI("货物过期图绘制");
         LOGI(Map::drawMap(goodsExpiredMap, 3));
         LOGI("泊位剩余情况：");
-        for(auto &berth : berths){
-            berth.totalValue = 0;
-            for(auto & good : berth.reached_goods) berth.totalValue += good.value;
-        }
+        for(auto &berth : berths)
+            berth.totalValue = berth.reachedValue();
         for(auto & berth : berths){
             berth.info();
         }
@@ -892,9 +997,13 @@ void GameManager::updateSingleLaneLocks()
 
 void GameManager::outputCommands()
 {
-
-    commandManager.outputCommands();
-    commandManager.clearCommands();
+    {
+        PROFILE_SCOPE(OUTPUT);
+        commandManager.outputCommands();
+        commandManager.clearCommands();
+    }
+    FrameDeadline::instance().endFrame();
+    PROFILE_END_FRAME();
 }
 
 void GameManager::onBerthStatusChanged(int berthId, bool isEnabled)
@@ -940,6 +1049,7 @@ void GameManager::onBerthStatusChanged(int berthId, bool isEnabled)
             }
         }
     }
+    goods.refreshNearestBerths();
 }
 
 
@@ -8,15 +8,18 @@
 #include "robot.h"
 #include "ship.h"
 #include "goods.h"
+#include "goodsStore.h"
 #include "berth.h"
 #include "scheduler.h"
 #include "commandManager.h"
+#include "frameInput.h"
 #include "robotController.h"
 #include "shipController.h"
 #include "assetManager.h"
 #include "berthAssignAndControlService.h"
 #include "singleLaneManager.h"
 #include "seaSingleLaneManager.h"
+#include "threadPool.h"
 
 enum class StageType
 {
@@ -41,7 +44,7 @@ public:
     ParamReader paramReader;
     std::vector<Robot> robots;
     std::vector<Ship> ships;
-    std::vector<Goods> goods;
+    GoodsStore goods;
     std::vector<Berth> berths;
     BerthAssignAndControlService berthAssignAndControlService;
     int currentFrame;
@@ -49,6 +52,15 @@ public:
     // 统计
     int totalGetGoodsValue = 0;
     int skipFrame = 0;
+    bool profileReported = false; // 帧性能报告是否已输出
+    FrameInputReader input;       // 判题器输入
+    FrameInput frameInput;        // 当前帧输入，帧之间复用
+    std::unique_ptr<ThreadPool> framePool; // 帧内并行的常驻线程，单核或关闭并行时为空
+    MapFlag mapType = MapFlag::NORMAL; // 地图类型，决定参数默认值
+    bool initInputComplete = false; // 初始化输入是否以 OK 结束
+    std::string artifactDirectory;  // 预计算快照目录，为空时不读写快照
+    int nextStatisticsFrame = 0;  // 下一次输出定期统计的帧数
+    int deferredWorkSlack = 8000; // 可推迟工作需要的帧内剩余时间，单位微秒
     int finalFrame = -1;                                                 // 进入终局调度的帧数
     std::vector<std::vector<int>> goodsExpiredMap;                    // 存储每个地点生成的货物数目
     std::unordered_map<std::string, int> generateGoodsValueDistribution; // 用于存储不同价值区间的货物数量
@@ -60,12 +72,18 @@ public:
 public:
     GameManager() : gameMap(MAPROWS, MAPCOLS) {}
     void initializeGame();                                                              // 读取初始化信息并初始化
-    void initializeComponents();                                                        // 初始化游戏各个类部件
+    void loadInitialState();                                                            // 读取初始化信息并完成与参数无关的预计算
+    void initializeComponents();                                                        // 与参数无关的预计算：距离场、航线、单行路
+    void computeDistanceFieldsAndSeaRoutes();                                           // 泊位距离场和航线，可由快照代替
+    std::vector<std::pair<BerthID, std::vector<Point2d>>> berthAreas() const;           // 每个泊位的 ID 和占据的 4x4 格子
+    void configureComponents();                                                         // 按参数创建调度、控制和资产管理部件
     void processFrameData();                                                            // 处理每帧的输入
     void update();                                                                      // 更新
     void outputCommands();                                                              // 输出每帧的控制指令
-    void robotControl();                                                                // 运行机器人控制器
-    void shipControl();                                                                 // 运行船控制器
+    void robotControl();                                                                // 机器人取放货和调度
+    void robotMotionControl();                                                          // 机器人寻路、冲突处理和移动指令
+    void shipControl();                                                                 // 船舶调度
+    void shipMotionControl();                                                           // 船舶寻路、冲突处理和指令
     void assetControl();                                                                // 运行资产管理
     void updateSingleLaneLocks();                                                       // 维护单行路的锁
     void logStatisticsInfo();                                                           // 结束前输出统计信息
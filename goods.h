@@ -12,9 +12,8 @@ public:
     Point2d pos;
 
 public:
-    int status;        // 货物状态：0初始，1已分配，2已搬运，3已送达
-    int initFrame = 0; // 起始帧数
-    int TTL;           // 剩余生存帧数，当TTL为 -1 时无法使用；INT_MAX时为不会过期
+    int status;        // 货物状态：0初始，1已分配，2已搬运，3已送达，通过 GoodsStore::setStatus 修改
+    int initFrame = 0; // 起始帧数，剩余生存帧数由 GoodsStore::ttl 给出
 
     std::vector<std::pair<BerthID, int>> distsToBerths; // 存储货物到港口的距离，第一个是泊位 ID，第二个是距离，应该为升序存储
 
@@ -23,11 +22,5 @@ public:
           value(value),
           pos(pos),
           status(status),
-          initFrame(initFrame),
-          TTL(1000) { count++; }
-
-    void assignRobot()
-    {
-        status = 1;
-    }
+          initFrame(initFrame) { count++; }
 };
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <climits>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// 货物表上的批量计算，输入输出都是连续的 int32/float 数组
+// 编译时开启 AVX2 则每次处理 8 个，x86-64 默认的 SSE2 每次处理 4 个，其他平台逐个计算，三种实现结果完全一致
+namespace GoodsKernel
+{
+    // 剩余生存帧数：ttl 为 -1（已过期）或 INT_MAX（已取走）时保持不变，否则为 lifetime - (currentFrame - initFrame)
+    inline void refreshTTL(int32_t *ttl, const int32_t *initFrame, int n, int currentFrame, int lifetime)
+    {
+        const int32_t offset = lifetime - currentFrame;
+        int i = 0;
+#if defined(__AVX2__)
+        const __m256i vOffset = _mm256_set1_epi32(offset), vMinusOne = _mm256_set1_epi32(-1), vMax = _mm256_set1_epi32(INT_MAX);
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256i t = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ttl + i));
+            __m256i fresh = _mm256_add_epi32(vOffset, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(initFrame + i)));
+            __m256i timed = _mm256_andnot_si256(_mm256_cmpeq_epi32(t, vMax), _mm256_cmpgt_epi32(t, vMinusOne));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(ttl + i), _mm256_blendv_epi8(t, fresh, timed));
+        }
+#elif defined(__SSE2__)
+        const __m128i vOffset = _mm_set1_epi32(offset), vMinusOne = _mm_set1_epi32(-1), vMax = _mm_set1_epi32(INT_MAX);
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ttl + i));
+            __m128i fresh = _mm_add_epi32(vOffset, _mm_loadu_si128(reinterpret_cast<const __m128i *>(initFrame + i)));
+            __m128i timed = _mm_andnot_si128(_mm_cmpeq_epi32(t, vMax), _mm_cmpgt_epi32(t, vMinusOne));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(ttl + i), _mm_or_si128(_mm_and_si128(timed, fresh), _mm_andnot_si128(timed, t)));
+        }
+#endif
+        for (; i < n; ++i)
+            if (ttl[i] >= 0 && ttl[i] != INT_MAX)
+                ttl[i] = offset + initFrame[i];
+    }
+
+    // 货物收益 value / (toGoodWeight * toGood + toBerthWeight * toBerth)，任一距离为 INT_MAX 时为 0
+    // applyTTLWeight 为 true 时 ttl <= ttlBound 的货物收益乘以 ttlWeight
+    // 距离不超过 2^24，转为 float 无误差；float 除法与先按 double 计算再转为 float 的结果相同
+    inline void computeProfits(const int32_t *value, const int32_t *ttl, const int32_t *toGood, const int32_t *toBerth, int n,
+                               float toGoodWeight, float toBerthWeight, bool applyTTLWeight, int32_t ttlBound, float ttlWeight,
+                               float *profits)
+    {
+        int i = 0;
+#if defined(__AVX2__)
+        const __m256i vMax = _mm256_set1_epi32(INT_MAX), vBound = _mm256_set1_epi32(ttlBound);
+        const __m256 vGoodW = _mm256_set1_ps(toGoodWeight), vBerthW = _mm256_set1_ps(toBerthWeight);
+        const __m256 vTTLW = _mm256_set1_ps(applyTTLWeight ? ttlWeight : 1.0f);
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256i g = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(toGood + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(toBerth + i));
+            __m256i unreachable = _mm256_or_si256(_mm256_cmpeq_epi32(g, vMax), _mm256_cmpeq_epi32(b, vMax));
+            __m256 denominator = _mm256_add_ps(_mm256_mul_ps(vGoodW, _mm256_cvtepi32_ps(g)), _mm256_mul_ps(vBerthW, _mm256_cvtepi32_ps(b)));
+            __m256 profit = _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(value + i))), denominator);
+            __m256i expiring = _mm256_cmpgt_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(ttl + i)), vBound);
+            __m256 weighted = _mm256_mul_ps(profit, vTTLW);
+            profit = _mm256_blendv_ps(weighted, profit, _mm256_castsi256_ps(expiring));
+            _mm256_storeu_ps(profits + i, _mm256_andnot_ps(_mm256_castsi256_ps(unreachable), profit));
+        }
+#elif defined(__SSE2__)
+        const __m128i vMax = _mm_set1_epi32(INT_MAX), vBound = _mm_set1_epi32(ttlBound);
+        const __m128 vGoodW = _mm_set1_ps(toGoodWeight), vBerthW = _mm_set1_ps(toBerthWeight);
+        const __m128 vTTLW = _mm_set1_ps(applyTTLWeight ? ttlWeight : 1.0f);
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i *>(toGood + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(toBerth + i));
+            __m128i unreachable = _mm_or_si128(_mm_cmpeq_epi32(g, vMax), _mm_cmpeq_epi32(b, vMax));
+            __m128 denominator = _mm_add_ps(_mm_mul_ps(vGoodW, _mm_cvtepi32_ps(g)), _mm_mul_ps(vBerthW, _mm_cvtepi32_ps(b)));
+            __m128 profit = _mm_div_ps(_mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(value + i))), denominator);
+            // ttl > ttlBound 的保持原值，其余乘以权重
+            __m128 keep = _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ttl + i)), vBound));
+            profit = _mm_or_ps(_mm_and_ps(keep, profit), _mm_andnot_ps(keep, _mm_mul_ps(profit, vTTLW)));
+            _mm_storeu_ps(profits + i, _mm_andnot_ps(_mm_castsi128_ps(unreachable), profit));
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            if (toGood[i] == INT_MAX || toBerth[i] == INT_MAX)
+            {
+                profits[i] = 0;
+                continue;
+            }
+            float denominator = toGoodWeight * static_cast<float>(toGood[i]) + toBerthWeight * static_cast<float>(toBerth[i]);
+            profits[i] = static_cast<float>(value[i]) / denominator;
+            if (applyTTLWeight && ttl[i] <= ttlBound)
+                profits[i] *= ttlWeight;
+        }
+    }
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <vector>
+#include <climits>
+#include <cmath>
+#include <algorithm>
+#include "goods.h"
+#include "goodsKernel.h"
+#include "spawnHeatmap.h"
+
+// ID 集合，支持 O(1) 插入和删除，删除时与末尾元素交换，不保证顺序
+class GoodsIdSet
+{
+public:
+    inline bool contains(GoodsID id) const { return id < static_cast<int>(slots.size()) && slots[id] != -1; }
+
+    void insert(GoodsID id)
+    {
+        if (id >= static_cast<int>(slots.size()))
+            slots.resize(id + 1, -1);
+        if (slots[id] != -1)
+            return;
+        slots[id] = static_cast<int>(ids.size());
+        ids.push_back(id);
+    }
+
+    void erase(GoodsID id)
+    {
+        if (!contains(id))
+            return;
+        int slot = slots[id];
+        GoodsID last = ids.back();
+        ids[slot] = last;
+        slots[last] = slot;
+        ids.pop_back();
+        slots[id] = -1;
+    }
+
+    inline size_t size() const { return ids.size(); }
+    inline bool empty() const { return ids.empty(); }
+    inline std::vector<GoodsID>::const_iterator begin() const { return ids.begin(); }
+    inline std::vector<GoodsID>::const_iterator end() const { return ids.end(); }
+
+private:
+    std::vector<GoodsID> ids;
+    std::vector<int> slots; // 货物 ID 在 ids 中的下标，-1 表示不在集合中
+};
+
+// 货物存储，货物 ID 即为下标且不会改变
+// available 为可分配货物（状态 0 且未过期），assigned 为已分配但未送达的货物（状态 1）
+// 每帧对所有货物计算的字段（剩余生存帧数、价值、最近泊位）按 ID 连续存放在货物表中，由 GoodsKernel 批量计算
+// 货物按生成帧顺序编号，仍在计时的货物是 ID 连续的一段 [timedBegin, size)，过期时只需移动起点
+// 按最近泊位汇总的可分配货物价值密度和已分配货物数随货物状态变化增量维护，调度时不需要遍历货物
+// 新货物同时记入生成热力图，初始化热力图之前不记录
+class GoodsStore
+{
+public:
+    static constexpr int GOODS_LIFETIME = 1000; // 货物存活帧数
+
+    // 添加新货物，货物 ID 必须与存储下标一致，distsToBerths 需在添加前算好
+    void add(const Goods &good)
+    {
+        goods.push_back(good);
+        ttls.push_back(GOODS_LIFETIME);
+        initFrames.push_back(good.initFrame);
+        values.push_back(good.value);
+        nearestBerths.push_back(-1);
+        nearestDistances.push_back(INT_MAX);
+        refreshNearestBerth(good.id);
+        heatmap.add(good.pos, good.initFrame, good.value, nearestBerths[good.id]);
+        if (good.status == 0)
+            insertAvailable(good.id);
+        else if (good.status == 1)
+            insertAssigned(good.id);
+    }
+
+    // 更新计时货物的 TTL，本帧过期的货物移出可分配集合并调用 onExpired
+    template <typename ExpiredCallback>
+    void advanceFrame(int currentFrame, ExpiredCallback onExpired)
+    {
+        // 按生成帧升序，起点之后的货物都还未过期
+        const int total = static_cast<int>(goods.size());
+        while (timedBegin < total && currentFrame - initFrames[timedBegin] > GOODS_LIFETIME)
+        {
+            GoodsID id = timedBegin++;
+            if (ttls[id] == INT_MAX || ttls[id] < 0)
+                continue;
+            ttls[id] = -1;
+            eraseAvailable(id);
+            onExpired(goods[id]);
+        }
+        GoodsKernel::refreshTTL(ttls.data() + timedBegin, initFrames.data() + timedBegin, total - timedBegin, currentFrame, GOODS_LIFETIME);
+    }
+
+    // 修改货物状态，同步更新索引
+    void setStatus(GoodsID id, int status)
+    {
+        Goods &good = goods[id];
+        good.status = status;
+        eraseAvailable(id);
+        eraseAssigned(id);
+        if (status == 0 && ttls[id] >= 0)
+            insertAvailable(id);
+        else if (status == 1)
+            insertAssigned(id);
+    }
+
+    // 货物被机器人拿起，不再过期
+    void markPickedUp(GoodsID id)
+    {
+        ttls[id] = INT_MAX;
+    }
+
+    // 泊位启用或禁用后重新计算所有货物的最近泊位，并重建按泊位汇总的统计
+    void refreshNearestBerths()
+    {
+        for (GoodsID id = 0; id < static_cast<int>(goods.size()); ++id)
+            refreshNearestBerth(id);
+        std::fill(berthDensity.begin(), berthDensity.end(), 0.0);
+        std::fill(berthZeroDistanceNum.begin(), berthZeroDistanceNum.end(), 0);
+        std::fill(berthAvailable.begin(), berthAvailable.end(), 0);
+        std::fill(berthAssigned.begin(), berthAssigned.end(), 0);
+        for (GoodsID id : available)
+            trackAvailable(id, 1);
+        for (GoodsID id : assigned)
+            trackAssigned(id, 1);
+    }
+
+    // 剩余生存帧数，-1 表示已过期，INT_MAX 表示已被取走不会过期
+    inline int ttl(GoodsID id) const { return ttls[id]; }
+    // 最近泊位及其距离，没有可达泊位时为 -1 和 INT_MAX
+    inline int nearestBerth(GoodsID id) const { return nearestBerths[id]; }
+    inline int nearestDistance(GoodsID id) const { return nearestDistances[id]; }
+    inline int value(GoodsID id) const { return values[id]; }
+
+    // 以该泊位为最近泊位的可分配货物的 value / 距离 之和
+    inline double berthAvailableDensity(BerthID berthId) const
+    {
+        if (berthId >= static_cast<int>(berthDensity.size()))
+            return 0;
+        return berthZeroDistanceNum[berthId] > 0 ? HUGE_VAL : berthDensity[berthId];
+    }
+    // 以该泊位为最近泊位的已分配（包括搬运中）货物数
+    inline int berthAssignedNum(BerthID berthId) const
+    {
+        return berthId < static_cast<int>(berthAssigned.size()) ? berthAssigned[berthId] : 0;
+    }
+
+    inline Goods &operator[](GoodsID id) { return goods[id]; }
+    inline const Goods &operator[](GoodsID id) const { return goods[id]; }
+    inline size_t size() const { return goods.size(); }
+    inline std::vector<Goods>::iterator begin() { return goods.begin(); }
+    inline std::vector<Goods>::iterator end() { return goods.end(); }
+    inline std::vector<Goods>::const_iterator begin() const { return goods.begin(); }
+    inline std::vector<Goods>::const_iterator end() const { return goods.end(); }
+
+    // 可分配的货物 ID
+    inline const GoodsIdSet &availableGoods() const { return available; }
+    // 已分配给机器人（包括搬运中）的货物 ID
+    inline const GoodsIdSet &assignedGoods() const { return assigned; }
+
+    // 货物生成热力图
+    inline SpawnHeatmap &spawnHeatmap() { return heatmap; }
+    inline const SpawnHeatmap &spawnHeatmap() const { return heatmap; }
+
+private:
+    // distsToBerths 变化后同步货物表中的最近泊位，调用前货物需不在 available 和 assigned 中，或随后重建统计
+    void refreshNearestBerth(GoodsID id)
+    {
+        const Goods &good = goods[id];
+        nearestBerths[id] = good.distsToBerths.empty() ? -1 : static_cast<int16_t>(good.distsToBerths[0].first);
+        nearestDistances[id] = good.distsToBerths.empty() ? INT_MAX : good.distsToBerths[0].second;
+        if (nearestBerths[id] >= static_cast<int>(berthAssigned.size()))
+        {
+            berthDensity.resize(nearestBerths[id] + 1, 0.0);
+            berthZeroDistanceNum.resize(nearestBerths[id] + 1, 0);
+            berthAvailable.resize(nearestBerths[id] + 1, 0);
+            berthAssigned.resize(nearestBerths[id] + 1, 0);
+        }
+    }
+
+    // 距离为 0 的货物密度为无穷大，单独计数，避免增减时出现 inf - inf
+    void trackAvailable(GoodsID id, int sign)
+    {
+        int berthId = nearestBerths[id];
+        if (berthId < 0)
+            return;
+        berthAvailable[berthId] += sign;
+        if (nearestDistances[id] == 0)
+            berthZeroDistanceNum[berthId] += sign;
+        else
+            berthDensity[berthId] += sign * (values[id] * 1.0 / nearestDistances[id]);
+        // 清空时归零，避免浮点误差累积
+        if (berthAvailable[berthId] == 0)
+            berthDensity[berthId] = 0;
+    }
+    void trackAssigned(GoodsID id, int sign)
+    {
+        if (nearestBerths[id] >= 0)
+            berthAssigned[nearestBerths[id]] += sign;
+    }
+    void insertAvailable(GoodsID id)
+    {
+        if (available.contains(id))
+            return;
+        available.insert(id);
+        trackAvailable(id, 1);
+    }
+    void eraseAvailable(GoodsID id)
+    {
+        if (!available.contains(id))
+            return;
+        available.erase(id);
+        trackAvailable(id, -1);
+    }
+    void insertAssigned(GoodsID id)
+    {
+        if (assigned.contains(id))
+            return;
+        assigned.insert(id);
+        trackAssigned(id, 1);
+    }
+    void eraseAssigned(GoodsID id)
+    {
+        if (!assigned.contains(id))
+            return;
+        assigned.erase(id);
+        trackAssigned(id, -1);
+    }
+
+private:
+    std::vector<Goods> goods;
+    GoodsIdSet available;
+    GoodsIdSet assigned;
+    GoodsID timedBegin = 0; // 第一个仍在计时的货物
+
+    // 货物表，下标为货物 ID
+    std::vector<int32_t> ttls;
+    std::vector<int32_t> initFrames;
+    std::vector<int32_t> values;
+    std::vector<int16_t> nearestBerths;
+    std::vector<int32_t> nearestDistances;
+
+    // 按最近泊位汇总，下标为泊位 ID
+    std::vector<double> berthDensity;
+    std::vector<int> berthZeroDistanceNum;
+    std::vector<int> berthAvailable;
+    std::vector<int> berthAssigned;
+
+    SpawnHeatmap heatmap;
+};
@@ -11,9 +11,54 @@ GreedyRobotScheduler::GreedyRobotScheduler(std::vector<std::vector<Berth>> &_clu
 
 void GreedyRobotScheduler::scheduleRobots(const Map &map,
                                           std::vector<Robot> &robots,
-                                          std::vector<Goods> &goods,
+                                          GoodsStore &goods,
                                           std::vector<Berth> &berths,
                                           const int currentFrame)
+{
+    prepareScheduling(map, robots, goods, berths, currentFrame);
+
+    const FrameDeadline &deadline = FrameDeadline::instance();
+    const int robotNum = robots.size();
+    // 从上一帧超时时停下的机器人开始，拥堵时排在后面的机器人也能轮到；本帧不超时则下一帧从头开始
+    const int start = scheduleStart < robotNum ? scheduleStart : 0;
+    scheduleStart = 0;
+    for (int k = 0; k < robotNum; ++k)
+    {
+        const int index = (start + k) % robotNum;
+        Robot &robot = robots[index];
+        if (robot.status==DEATH) continue;
+        // 超时后剩下的机器人保持原决策，下一帧再调度
+        if (deadline.expired(DeadlineStage::ROBOT_SCHEDULE))
+        {
+            LOGW("机器人调度超时，从机器人 ", robot.id, " 开始推迟到下一帧");
+            scheduleStart = index;
+            break;
+        }
+        // 机器人需要寻找合适的货物
+        // TODO: 机器人临时改变之前拿取货物的决策，去拿取另一个货物
+        if (shouldFetchGoods(robot))
+        {
+            findGoodsForRobot(map, robot, goods, berths, currentFrame);
+        }
+        // 机器人需要寻找合适的泊位
+        else if (shouldMoveToBerth(robot))
+        {
+            findBerthForRobot(robot, goods, berths, map);
+        }
+        // 机器人保持之前的决策
+        else
+        {
+        }
+    }
+    // 返回机器人接下来应当采取的行动，在 gameManager 里对机器人状态进行修改
+    return;
+}
+
+void GreedyRobotScheduler::prepareScheduling(const Map &map,
+                                             std::vector<Robot> &robots,
+                                             GoodsStore &goods,
+                                             std::vector<Berth> &berths,
+                                             const int currentFrame)
 {
     // LOGI("货物数量：", goods.size());
     // countRobotsPerBerth(robots);
@@ -21,7 +66,9 @@ void GreedyRobotScheduler::scheduleRobots(const Map &map,
         assignRobotsByCluster(robots, map, ASSIGNBOUND);
         if (robots.size()==maxRobotNum) allAssign = true;
     }
-    if (!assignment.empty() && DynamicPartitionScheduling && currentFrame - lastReassignFrame > DynamicSchedulingInterval) {
+    // 动态分区不紧急，到期后推迟到有余量的帧执行
+    if (!assignment.empty() && DynamicPartitionScheduling && currentFrame - lastReassignFrame > DynamicSchedulingInterval &&
+        FrameDeadline::instance().hasSlack(DeferredWorkSlackMicros)) {
         reassignRobotsByCluster(goods, robots, map, berths);
         lastReassignFrame = currentFrame;
     }
@@ -41,27 +88,8 @@ void GreedyRobotScheduler::scheduleRobots(const Map &map,
         enterFinal = true;
     }
 
-    for (Robot &robot : robots)
-    {
-        if (robot.status==DEATH) continue;
-        // 机器人需要寻找合适的货物
-        // TODO: 机器人临时改变之前拿取货物的决策，去拿取另一个货物
-        if (shouldFetchGoods(robot))
-        {
-            findGoodsForRobot(map, robot, goods, berths, currentFrame);
-        }
-        // 机器人需要寻找合适的泊位
-        else if (shouldMoveToBerth(robot))
-        {
-            findBerthForRobot(robot, goods, berths, map);
-        }
-        // 机器人保持之前的决策
-        else
-        {
-        }
-    }
-    // 返回机器人接下来应当采取的行动，在 gameManager 里对机器人状态进行修改
-    return;
+    // 按泊位类对可分配货物建立索引，分区调度时机器人只需要评估所在类的货物
+    buildClusterGoodsIndex(goods);
 }
 
 void GreedyRobotScheduler::setParameter(const Params &params)
@@ -79,6 +107,9 @@ void GreedyRobotScheduler::setParameter(const Params &params)
     FinalgameScheduling = params.FinalgameScheduling;
     robot2goodWeight = params.robot2goodWeight;
     good2berthWeight = params.good2berthWeight;
+    DeferredWorkSlackMicros = params.DeferredWorkSlackMicros;
+    SpawnHeatmapPositioning = params.SpawnHeatmapPositioning;
+    SpawnHeatmapTileSize = params.SpawnHeatmapTileSize;
 }
 
 void GreedyRobotScheduler::FinalgameAdjustment(std::vector<Berth> &berths)
@@ -143,9 +174,9 @@ void GreedyRobotScheduler::assignRobotsByCluster(vector<Robot> &robots, const Ma
             int dist = INT_MAX;
             for (int k = 0; k < clusters[i].size(); k++)
             {
-                if (dist > map.berthDistanceMap.at(clusters[i][k].id)[robot.pos.x][robot.pos.y])
+                if (dist > map.berthDistanceMap.get(clusters[i][k].id, robot.pos.x, robot.pos.y))
                 {
-                    dist = map.berthDistanceMap.at(clusters[i][k].id)[robot.pos.x][robot.pos.y];
+                    dist = map.berthDistanceMap.get(clusters[i][k].id, robot.pos.x, robot.pos.y);
                 }
             }
             if (dist < mini_dist)
@@ -175,9 +206,9 @@ void GreedyRobotScheduler::assignRobotsByCluster(vector<Robot> &robots, const Ma
                 continue; 
             for (int k = 0; k < clusters[i].size(); k++)
             {
-                if (dist > map.berthDistanceMap.at(clusters[i][k].id)[robot.pos.x][robot.pos.y])
+                if (dist > map.berthDistanceMap.get(clusters[i][k].id, robot.pos.x, robot.pos.y))
                 {
-                    dist = map.berthDistanceMap.at(clusters[i][k].id)[robot.pos.x][robot.pos.y];
+                    dist = map.berthDistanceMap.get(clusters[i][k].id, robot.pos.x, robot.pos.y);
                 }
             }
             if (dist < mini_dist)
@@ -194,23 +225,19 @@ void GreedyRobotScheduler::assignRobotsByCluster(vector<Robot> &robots, const Ma
     return;
 }
 
-void GreedyRobotScheduler::reassignRobotsByCluster(vector<Goods> &goods, vector<Robot> &robots, const Map &map, const std::vector<Berth> &berths)
+void GreedyRobotScheduler::reassignRobotsByCluster(GoodsStore &goods, vector<Robot> &robots, const Map &map, const std::vector<Berth> &berths)
 {
     // 根据类收益分配机器人
     vector<int> assignBound(clusters.size(), 0);
     for (int i = 0; i < assignment.size(); i++)
-        assignBound[assignment[i]]++;
+        if (assignment[i] >= 0) // 没有可达类的机器人未分配
+            assignBound[assignment[i]]++;
 
-    // 需要统计（机器人空闲率）和泊位类的价值
+    // 需要统计（机器人空闲率）和泊位类的价值，类的价值为类中泊位附近可分配货物的价值密度之和，由货物存储增量维护
     vector<float> clusterValue(clusters.size(), 0);
-    for (auto &good : goods)
-    {
-        if (good.status == 0 && !good.distsToBerths.empty())
-        {
-            // todo 可能有问题
-            clusterValue[berthCluster->at(int(good.distsToBerths[0].first))] += good.value *1.0 / good.distsToBerths[0].second;
-        }
-    }
+    for (BerthID berthId = 0; berthId < berthCluster->size(); berthId++)
+        if (berthCluster->at(berthId) >= 0)
+            clusterValue[berthCluster->at(berthId)] += goods.berthAvailableDensity(berthId);
     for (int i=0;i<clusters.size();i++) clusterValue[i] /= assignBound[i] * 1.0;
     float clusterValue_avg = std::accumulate(clusterValue.begin(), clusterValue.end(), 0.0) / clusterValue.size();
 
@@ -272,128 +299,162 @@ int GreedyRobotScheduler::WhereIsRobot(const Robot &robot, const std::vector<Ber
     return -1;
 }
 
-std::vector<std::reference_wrapper<Goods>>
-GreedyRobotScheduler::getAvailableGoods(std::vector<Goods> &goods)
+void GreedyRobotScheduler::buildClusterGoodsIndex(GoodsStore &goods)
 {
-    std::vector<std::reference_wrapper<Goods>> availableGoods;
-    for (Goods &good : goods)
+    for (auto &bucket : clusterGoods)
+        bucket.clear();
+    clusterGoods.resize(clusters.size());
+    for (GoodsID id : goods.availableGoods())
     {
-        if (good.status == 0)
-        {
-            availableGoods.push_back(std::ref(good));
-        }
+        const Goods &good = goods[id];
+        // 不可达任何泊位的货物不会被选中
+        if (good.distsToBerths.empty())
+            continue;
+        int cluster = berthCluster->at(good.distsToBerths[0].first);
+        if (cluster >= 0 && cluster < clusterGoods.size())
+            clusterGoods[cluster].push_back(id);
     }
+}
+
+bool GreedyRobotScheduler::isPartitionScheduled(const Robot &robot) const
+{
+    return PartitionScheduling && !assignment.empty() && robot.id < assignment.size() && !enterFinal;
+}
+
+FrameVector<std::reference_wrapper<Goods>>
+GreedyRobotScheduler::getAvailableGoods(GoodsStore &goods, const Robot &robot)
+{
+    FrameVector<std::reference_wrapper<Goods>> availableGoods(FrameArena::resource());
+    // 分区调度时只返回机器人所在类的货物
+    if (isPartitionScheduled(robot) && assignment[robot.id] >= 0 && assignment[robot.id] < clusterGoods.size())
+    {
+        const std::vector<GoodsID> &bucket = clusterGoods[assignment[robot.id]];
+        availableGoods.reserve(bucket.size());
+        for (GoodsID id : bucket)
+            if (goods[id].status == 0)
+                availableGoods.push_back(std::ref(goods[id]));
+        return availableGoods;
+    }
+    availableGoods.reserve(goods.availableGoods().size());
+    for (GoodsID id : goods.availableGoods())
+        if (!goods[id].distsToBerths.empty())
+            availableGoods.push_back(std::ref(goods[id]));
     return availableGoods;
 }
 
-vector<long long>
+const DistanceTensor &GreedyRobotScheduler::getRobotDistanceField(const Robot &robot, const Map &map)
+{
+    if (robotDistanceFields.layers() == 0)
+        robotDistanceFields = DistanceTensor(map.rows, map.cols);
+    if (robot.id >= robotFieldOrigins.size())
+        robotFieldOrigins.resize(robot.id + 1, Point2d(-1, -1));
+    // 机器人等待分配期间位置通常不变，此时不需要重新 BFS
+    if (robotFieldOrigins[robot.id] != robot.pos)
+    {
+        map.computeLandDistanceField(robot.pos, robotDistanceFields.layer(robot.id), fieldQueue);
+        robotFieldOrigins[robot.id] = robot.pos;
+    }
+    return robotDistanceFields;
+}
+
+FrameVector<int>
 GreedyRobotScheduler::Cost_RobotToGood(const Robot &robot,
-                                       std::vector<std::reference_wrapper<Goods>> &availableGoods,
+                                       FrameVector<std::reference_wrapper<Goods>> &availableGoods,
                                        const std::vector<Berth> &berths,
                                        const Map &map)
 {
-    vector<long long> cost_robot2good(availableGoods.size(), 0);
+    FrameVector<int> cost_robot2good(availableGoods.size(), 0, FrameArena::resource());
+    // 机器人在泊位上时直接使用泊位距离场，否则使用以机器人为起点的距离场，两者都是真实距离
+    int berthid = WhereIsRobot(robot, berths, map);
+    const DistanceTensor &distances = berthid == -1 ? getRobotDistanceField(robot, map) : map.berthDistanceMap;
+    const int layer = berthid == -1 ? robot.id : berthid;
     for (int j = 0; j < availableGoods.size(); j++)
     {
-        if (availableGoods[j].get().status != 0)
+        const Goods &good = availableGoods[j].get();
+        if (good.status != 0)
         {
             cost_robot2good[j] = INT_MAX;
             continue;
         }
-        // 机器人到货物的距离
-        int berthid = WhereIsRobot(robot, berths, map);
-        if (berthid == -1)
-        {
-            bool canReach = false;
-            for (int k = 0; k < berths.size(); k++)
-            {
-                if (map.berthDistanceMap.at(k)[robot.pos.x][robot.pos.y] != INT_MAX && map.berthDistanceMap.at(k)[availableGoods[j].get().pos.x][availableGoods[j].get().pos.y] != INT_MAX)
-                {
-                    canReach = true;
-                    break;
-                }
-            }
-            if (!canReach)
-                cost_robot2good[j] = INT_MAX;
-            else
-                cost_robot2good[j] = map.cost(robot.pos, availableGoods[j].get().pos);
-                //  Point2d::calculateManhattanDistance(robot.pos, availableGoods[j].get().pos);
-        }
-        else
-            cost_robot2good[j] = map.berthDistanceMap.at(berthid)[availableGoods[j].get().pos.x][availableGoods[j].get().pos.y];
+        cost_robot2good[j] = distances.get(layer, good.pos.x, good.pos.y);
     }
     return cost_robot2good;
 }
 
-vector<long long>
-GreedyRobotScheduler::Cost_GoodToBerth(std::vector<std::reference_wrapper<Goods>> &availableGoods,
-                                       const Map &map)
+FrameVector<int>
+GreedyRobotScheduler::Cost_GoodToBerth(FrameVector<std::reference_wrapper<Goods>> &availableGoods,
+                                       const GoodsStore &goods)
 {
-    vector<long long> cost_good2berth(availableGoods.size(), 0);
+    // 没有可达泊位时货物表中的距离为 INT_MAX
+    FrameVector<int> cost_good2berth(availableGoods.size(), 0, FrameArena::resource());
     for (int j = 0; j < availableGoods.size(); j++)
-    {
-        // 进入终局的时候要更新distsToBerths
-        // LOGI(j, " cost_good2berth ", availableGoods[j].get().distsToBerths.empty());
-        if (availableGoods[j].get().distsToBerths.empty()) cost_good2berth[j] = INT_MAX;
-        else cost_good2berth[j] = availableGoods[j].get().distsToBerths[0].second;
-    }
+        cost_good2berth[j] = goods.nearestDistance(availableGoods[j].get().id);
     return cost_good2berth;
 }
 
-std::pair<vector<float>, vector<int>>
-GreedyRobotScheduler::getProfitsAndSortedIndex(std::vector<std::reference_wrapper<Goods>> &availableGoods,
-                                               vector<long long> &cost_robot2good,
-                                               vector<long long> &cost_good2berth)
+FrameVector<float>
+GreedyRobotScheduler::getProfits(FrameVector<std::reference_wrapper<Goods>> &availableGoods,
+                                 const GoodsStore &goods,
+                                 FrameVector<int> &cost_robot2good,
+                                 FrameVector<int> &cost_good2berth)
 {
-    // 计算收益
-    vector<float> profits(availableGoods.size(), 0);
-    for (int j = 0; j < availableGoods.size(); j++)
+    // 候选货物在货物表中不连续，先收集成连续数组再整体计算
+    const int n = availableGoods.size();
+    FrameVector<int32_t> values(n, 0, FrameArena::resource()), ttls(n, 0, FrameArena::resource());
+    for (int j = 0; j < n; j++)
     {
-        if (cost_robot2good[j] >= INT_MAX || cost_good2berth[j] >= INT_MAX)
-            continue;
-        profits[j] = availableGoods[j].get().value * 1.0 / (robot2goodWeight * cost_robot2good[j] + good2berthWeight * cost_good2berth[j]);
-
-        if (availableGoods[j].get().TTL <= TTL_Bound && !enterFinal)
-            profits[j] *= TTL_ProfitWeight;
+        GoodsID id = availableGoods[j].get().id;
+        values[j] = goods.value(id);
+        ttls[j] = goods.ttl(id);
     }
-    // 对收益排序
-    std::vector<int> indices(availableGoods.size(), 0);
-    for (int j = 0; j < availableGoods.size(); j++)
-        indices[j] = j;
-    std::sort(indices.begin(), indices.end(), [&](int a, int b)
-    {
-        return profits[a] > profits[b]; // 根据第二个维度进行降序排序
-    });
-
-    return std::make_pair(profits, indices);
+    FrameVector<float> profits(n, 0, FrameArena::resource());
+    GoodsKernel::computeProfits(values.data(), ttls.data(), cost_robot2good.data(), cost_good2berth.data(), n,
+                                robot2goodWeight, good2berthWeight, !enterFinal, TTL_Bound, TTL_ProfitWeight, profits.data());
+    return profits;
 }
 
 void GreedyRobotScheduler::findGoodsForRobot(const Map &map,
                                              Robot &robot,
-                                             std::vector<Goods> &goods,
+                                             GoodsStore &goods,
                                              const std::vector<Berth> &berths,
                                              const int currentFrame)
 {
     // 获取可用的货物子集
     // 注：reference_wrapper封装的元素要用 .get() 获取原对象
-    std::vector<std::reference_wrapper<Goods>> availableGoods = getAvailableGoods(goods);
+    FrameVector<std::reference_wrapper<Goods>> availableGoods = getAvailableGoods(goods, robot);
+    // 没有候选货物时不需要距离场，前往热力图区域途中的机器人每帧都在移动，BFS 只在有货物要比较时做
+    if (availableGoods.empty())
+    {
+        stageIdleRobot(map, robot, goods, currentFrame);
+        return;
+    }
 
     // 计算机器人到货物的距离
-    vector<long long> cost_robot2good = Cost_RobotToGood(robot, availableGoods, berths, map);
+    FrameVector<int> cost_robot2good = Cost_RobotToGood(robot, availableGoods, berths, map);
 
     // 计算机器人到每个货物的距离，该功能封装在一个函数里
-    vector<long long> cost_good2berth = Cost_GoodToBerth(availableGoods, map);
+    FrameVector<int> cost_good2berth = Cost_GoodToBerth(availableGoods, goods);
 
     // 输入距离和货物，计算得分，该功能封装在一个函数里
-    auto profitsAndSortedIndex = getProfitsAndSortedIndex(availableGoods, cost_robot2good, cost_good2berth);
-    vector<float> profits = profitsAndSortedIndex.first;
-    vector<int> index = profitsAndSortedIndex.second;
+    FrameVector<float> profits = getProfits(availableGoods, goods, cost_robot2good, cost_good2berth);
 
-    // 选择得分第一的作为搬运目标
-    // for (int j = std::min((int)availableGoods.size()-2, rand()%3); j < availableGoods.size(); ++j)
+    // 收益不为正的货物不会被选中，其余按收益建大顶堆，按收益从高到低依次取出，
+    // 通常前几个就能分配成功，不需要对所有货物完整排序
+    FrameVector<int> index(FrameArena::resource());
+    index.reserve(availableGoods.size());
     for (int j = 0; j < availableGoods.size(); ++j)
+        if (profits[j] > 0)
+            index.push_back(j);
+    auto lessProfit = [&](int a, int b)
+    { return profits[a] < profits[b]; };
+    std::make_heap(index.begin(), index.end(), lessProfit);
+
+    // 选择得分第一的作为搬运目标
+    while (!index.empty())
     {
-        int goodIndex = index[j];
+        std::pop_heap(index.begin(), index.end(), lessProfit);
+        int goodIndex = index.back();
+        index.pop_back();
         Goods &good = availableGoods[goodIndex].get();
         // int berthsIndex = bestBerthIndex[goodsIndex];
         int timeToGoods = cost_robot2good[goodIndex];
@@ -401,33 +462,111 @@ void GreedyRobotScheduler::findGoodsForRobot(const Map &map,
 
         // 集中往一个泊位搬货
         if (assignedBerthID != -1) {
-            timeToBerths = map.berthDistanceMap.at(assignedBerthID)[good.pos.x][good.pos.y];
+            timeToBerths = map.berthDistanceMap.get(assignedBerthID, good.pos.x, good.pos.y);
         }
 
         if (timeToBerths == INT_MAX || timeToGoods == INT_MAX)
             continue;
         int berthsIndex = good.distsToBerths[0].first;
         // LOGI("货物id：",good.id,"货物状态：",good.status,"货物收益：",profits[good.id]);
-        if (PartitionScheduling && !assignment.empty() && robot.id<assignment.size() && !enterFinal && berthCluster->at(berthsIndex)!=assignment[robot.id]) continue;
+        if (isPartitionScheduled(robot) && berthCluster->at(berthsIndex)!=assignment[robot.id]) continue;
 
-        if (good.status == 0 && profits[goodIndex] > 0 && good.TTL + 10 >= timeToGoods)
+        if (good.status == 0 && goods.ttl(good.id) + 10 >= timeToGoods)
         {
             // LOGI("成功分配货物", goods[goodIndex].id, ",给机器人：", robot.id, "机器人状态：", robot.state);
-            robot.assignGoodOrBerth(good.id, good.pos);
-            good.assignRobot();
+            assignGoodToRobot(robot, good, goods);
             return;
         }
     }
     LOGI("机器人", robot.id, "分配货物失败");
+    stageIdleRobot(map, robot, goods, currentFrame);
     return;
 }
 
+void GreedyRobotScheduler::assignGoodToRobot(Robot &robot, Goods &good, GoodsStore &goods)
+{
+    robot.assignGoodOrBerth(good.id, good.pos);
+    goods.setStatus(good.id, 1);
+    // 路径为空时控制器按新目标重新寻路
+    if (robot.id < static_cast<int>(stagingTiles.size()) && stagingTiles[robot.id] != -1)
+    {
+        robot.path.clear();
+        stagingTiles[robot.id] = -1;
+    }
+}
+
+void GreedyRobotScheduler::stageIdleRobot(const Map &map, Robot &robot, const GoodsStore &goods, const int currentFrame)
+{
+    const SpawnHeatmap &heatmap = goods.spawnHeatmap();
+    if (!SpawnHeatmapPositioning || !heatmap.enabled() || robot.carryingItem > 0)
+        return;
+    if (robot.id >= static_cast<int>(stagingTiles.size()))
+        stagingTiles.resize(robot.id + 1, -1);
+    // 已在前往某个区域的路上
+    if (stagingTiles[robot.id] != -1 && !robot.path.empty())
+        return;
+
+    // 区域收益：近期价值速率 / 距离，被其他机器人选中的区域按人数均分
+    const DistanceTensor &distances = getRobotDistanceField(robot, map);
+    int bestTile = -1;
+    float bestScore = 0;
+    for (int t = 0; t < heatmap.size(); ++t)
+    {
+        const SpawnHeatmap::Tile &tile = heatmap[t];
+        if (tile.nearestBerth < 0)
+            continue;
+        if (isPartitionScheduled(robot) && berthCluster->at(tile.nearestBerth) != assignment[robot.id])
+            continue;
+        int distance = distances.get(robot.id, tile.lastSpawn);
+        if (distance == INT_MAX)
+            continue;
+        int others = 0;
+        for (int id = 0; id < static_cast<int>(stagingTiles.size()); ++id)
+            others += id != robot.id && stagingTiles[id] == t;
+        float score = tile.spawned.valueRate(currentFrame) / ((1 + others) * static_cast<float>(distance + SpawnHeatmapTileSize));
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestTile = t;
+        }
+    }
+    stagingTiles[robot.id] = bestTile;
+    if (bestTile == -1)
+        return;
+    // 已在区域附近则原地等待
+    const Point2d target = heatmap[bestTile].lastSpawn;
+    int distance = distances.get(robot.id, target);
+    if (distance <= SpawnHeatmapTileSize)
+        return;
+
+    // 从目标沿距离场下降到机器人旁边，得到的就是逆序存储的路径
+    robot.assignGoodOrBerth();
+    robot.destination = target;
+    robot.path.clear();
+    Point2d cur = target;
+    while (distance > 0)
+    {
+        robot.path.push_back(cur);
+        for (const Point2d &dir : Map::DIRS)
+        {
+            Point2d next = cur + dir;
+            if (map.inBounds(next) && distances.get(robot.id, next) == distance - 1)
+            {
+                cur = next;
+                break;
+            }
+        }
+        --distance;
+    }
+    LOGI("机器人", robot.id, "前往货物生成区域 ", target, ", 距离: ", robot.path.size());
+}
+
 void GreedyRobotScheduler::findBerthForRobot(Robot &robot,
-                                             std::vector<Goods> &goods,
+                                             GoodsStore &goods,
                                              const std::vector<Berth> &berths,
                                              const Map &map)
 {
-    if (assignedBerthID != -1 && map.berthDistanceMap.at(assignedBerthID)[robot.pos.x][robot.pos.y] < INT_MAX) {
+    if (assignedBerthID != -1 && map.berthDistanceMap.get(assignedBerthID, robot.pos.x, robot.pos.y) < INT_MAX) {
         robot.assignGoodOrBerth(assignedBerthID, berths[assignedBerthID].pos);
         return;
     }
@@ -1,5 +1,7 @@
 #pragma once
 #include "scheduler.h"
+#include "frameDeadline.h"
+#include "frameArena.h"
 #include <memory>
 
 class GreedyRobotScheduler : public RobotScheduler
@@ -8,7 +10,7 @@ public:
     // 实现接口
     void scheduleRobots(const Map &map,
                         std::vector<Robot> &robots,
-                        std::vector<Goods> &goods,
+                        GoodsStore &goods,
                         std::vector<Berth> &berths,
                         const int currentFrame) override;
     // 设置参数
@@ -23,7 +25,7 @@ public:
 
     GreedyRobotScheduler(std::vector<std::vector<Berth>> &_clusters, std::vector<int> &_berthCluster);
 
-private:
+protected:
     // 需要用到的超参数
     float TTL_ProfitWeight;
     int TTL_Bound;
@@ -38,24 +40,43 @@ private:
     bool FinalgameScheduling;
     float robot2goodWeight;
     float good2berthWeight;
+    int DeferredWorkSlackMicros = 8000; // 动态分区只在帧内剩余时间足够时执行
+    bool SpawnHeatmapPositioning = true; // 没有货物可分配时按生成热力图提前移动
+    int SpawnHeatmapTileSize = 10;
     // 等等
     std::vector<std::pair<BerthID, int>> maxRobotsPerBerth; // 记录每个泊位分配机器人的上限
-private:
+protected:
     // 辅助变量
     std::vector<std::pair<BerthID, int>> robotAllocationPerBerth; // 记录每个泊位已经分配了多少机器人
     std::vector<std::vector<Berth>> clusters;                     // 每个簇对应的泊位
     std::shared_ptr<std::vector<int>> berthCluster;         // 每个泊位所对应的类
     std::vector<int> assignment;
     int lastReassignFrame = 0; //上次动态调度的时刻
-    bool enterFinal; // 判断是否进入终局
+    int scheduleStart = 0;     // 本帧第一个调度的机器人下标，上一帧超时时为停下的机器人
+    bool enterFinal = false; // 判断是否进入终局
     bool allAssign = false;
+    std::vector<std::vector<GoodsID>> clusterGoods; // 每个类的可分配货物，每帧调度前重建
+    DistanceTensor robotDistanceFields;             // 每个机器人到陆地各点的真实距离，第 id 层属于 id 号机器人
+    std::vector<Point2d> robotFieldOrigins;         // 每层距离场的起点，机器人不动时直接复用
+    std::vector<int> fieldQueue;                    // BFS 队列，复用内存
+    std::vector<int> stagingTiles;                  // 每个机器人正在前往或停留的热力图区域，-1 表示没有
 
-private:
+protected:
+    // 调度前的公共步骤：分区分配、动态重分配、终局调整和货物索引
+    void prepareScheduling(const Map &map,
+                           std::vector<Robot> &robots,
+                           GoodsStore &goods,
+                           std::vector<Berth> &berths,
+                           const int currentFrame);
     void FinalgameAdjustment(std::vector<Berth> &berths);
+    // 按货物最近泊位所在的类建立可分配货物索引
+    void buildClusterGoodsIndex(GoodsStore &goods);
+    // 机器人是否按分区调度
+    bool isPartitionScheduled(const Robot &robot) const;
     // 根据类来分配机器人
     void assignRobotsByCluster(vector<Robot> &robots, const Map &map, vector<int> assignBound = vector<int>());
     // 根据类来重新分配机器人
-    void reassignRobotsByCluster(vector<Goods> &goods, vector<Robot> &robots, const Map &map, const std::vector<Berth> &berths);
+    void reassignRobotsByCluster(GoodsStore &goods, vector<Robot> &robots, const Map &map, const std::vector<Berth> &berths);
     // 统计每个泊位分配了多少机器人，维护 robotAllocationPerBerth 变量
     void countRobotsPerBerth(const std::vector<Robot> &robots);
     // 判断机器人是否需要去拿货物
@@ -67,37 +88,46 @@ private:
     void
     findGoodsForRobot(const Map &map,
                       Robot &robot,
-                      std::vector<Goods> &goods,
+                      GoodsStore &goods,
                       const std::vector<Berth> &berths,
                       const int currentFrame);
 
+    // 把货物分配给机器人，丢弃前往热力图区域的路径
+    void assignGoodToRobot(Robot &robot, Goods &good, GoodsStore &goods);
+
+    // 没有货物可分配的空闲机器人前往近期生成价值高、距离近且没有其他机器人前往的热力图区域
+    void stageIdleRobot(const Map &map, Robot &robot, const GoodsStore &goods, const int currentFrame);
+
     // 对单个机器人寻找合适的泊位
     void
     findBerthForRobot(Robot &robot,
-                      std::vector<Goods> &goods,
+                      GoodsStore &goods,
                       const std::vector<Berth> &berths,
                       const Map &map);
 
     // 根据 robotAllocationPerBerth 以及机器人对泊位的可达性和泊位是否启用，筛选出可用泊位
     std::vector<BerthID> getAvailableBerths(const Robot &robot);
 
-    // 获取可用的货物子集
-    std::vector<std::reference_wrapper<Goods>>
-    getAvailableGoods(std::vector<Goods> &goods);
+    // 获取机器人可用的货物子集，分区调度时只包含机器人所在类的货物
+    FrameVector<std::reference_wrapper<Goods>>
+    getAvailableGoods(GoodsStore &goods, const Robot &robot);
 
+    // 获取以机器人当前位置为起点的距离场，位置不变时复用上次结果
+    const DistanceTensor &getRobotDistanceField(const Robot &robot, const Map &map);
     // 确定机器人在泊位还是不在泊位
     int WhereIsRobot(const Robot &robot, const std::vector<Berth> &berths, const Map &map);
     // 计算机器人到货物的距离
-    vector<long long> Cost_RobotToGood(const Robot &robot,
-                                       std::vector<std::reference_wrapper<Goods>> &availableGoods,
+    FrameVector<int> Cost_RobotToGood(const Robot &robot,
+                                       FrameVector<std::reference_wrapper<Goods>> &availableGoods,
                                        const std::vector<Berth> &berths,
                                        const Map &map);
     // 计算货物到最佳泊位的距离
-    vector<long long> Cost_GoodToBerth(std::vector<std::reference_wrapper<Goods>> &availableGoods,
-                                       const Map &map);
-    // 计算收益并排序
-    std::pair<vector<float>, vector<int>> 
-    getProfitsAndSortedIndex(std::vector<std::reference_wrapper<Goods>>& availableGoods,
-                             vector<long long>& cost_robot2good,
-                             vector<long long>& cost_good2berth);
+    FrameVector<int> Cost_GoodToBerth(FrameVector<std::reference_wrapper<Goods>> &availableGoods,
+                                      const GoodsStore &goods);
+    // 计算收益，从货物表收集候选货物的价值和 TTL 后由 GoodsKernel 批量计算
+    FrameVector<float>
+    getProfits(FrameVector<std::reference_wrapper<Goods>>& availableGoods,
+               const GoodsStore &goods,
+               FrameVector<int>& cost_robot2good,
+               FrameVector<int>& cost_good2berth);
 };
@@ -14,7 +14,7 @@ void GreedyShipScheduler::setParameter(const Params &params)
     EARLY_DELIVERY_VALUE_LIMIT = params.EARLY_DELIVERY_VALUE_LIMIT;
 }
 
-void GreedyShipScheduler::scheduleShips(Map &map, std::vector<Ship> &ships, std::vector<Berth> &berths, std::vector<Goods> &goods, std::vector<Robot> &robots) {
+void GreedyShipScheduler::scheduleShips(Map &map, std::vector<Ship> &ships, std::vector<Berth> &berths, GoodsStore &goods, std::vector<Robot> &robots) {
     //需要迁移，更新泊位和货物的状态
     updateBerthStatus(ships, berths, goods, robots);
     // LOGI("测试当前全局参数：", CURRENT_FRAME, ", ", FINAL_FRAME, ", ", CURRENT_MONEY, ", ", static_cast<int>(MAP_TYPE));
@@ -48,7 +48,7 @@ void GreedyShipScheduler::scheduleShips(Map &map, std::vector<Ship> &ships, std:
 }
 
 // 处理船在路途的情况
-void GreedyShipScheduler::handleShipOnRoute(Map& map, Ship &ship,std::vector<Berth> &berths,std::vector<Goods> &goods){
+void GreedyShipScheduler::handleShipOnRoute(Map& map, Ship &ship,std::vector<Berth> &berths,GoodsStore &goods){
     BerthID berthId = ship.berthId;
     // LOGI("handleShipOnRoute");
     // ship.info();
@@ -81,7 +81,7 @@ void GreedyShipScheduler::handleShipOnRoute(Map& map, Ship &ship,std::vector<Ber
 }
 
 // 处理船在泊位上的情况
-void GreedyShipScheduler::handleShipAtBerth(Map &map, Ship &ship,std::vector<Berth> &berths,std::vector<Goods> &goods){
+void GreedyShipScheduler::handleShipAtBerth(Map &map, Ship &ship,std::vector<Berth> &berths,GoodsStore &goods){
     LOGI("船在泊位上");
     ship.info();
     // 分配交货点id
@@ -104,13 +104,10 @@ void GreedyShipScheduler::handleShipAtBerth(Map &map, Ship &ship,std::vector<Ber
         }
 
         BerthID berthId = ship.berthId;
-        int shipment = std::min(static_cast<int>(berths[berthId].reached_goods.size()),berths[berthId].velocity);
+        int shipment = std::min(berths[berthId].reachedNum(),berths[berthId].velocity);
         int res = ship.loadGoods(shipment); // 装货
         // 累计货物的价值
-        for (int index = 0; index < res; index++){
-            ship.loadGoodValue += berths[berthId].reached_goods[index].value;
-        }
-        berths[berthId].reached_goods.erase(berths[berthId].reached_goods.begin(),berths[berthId].reached_goods.begin() + res);
+        ship.loadGoodValue += berths[berthId].takeGoods(res);
         LOGI("装货中-----------------------------");
         LOGI("装货数量：", res);
         ship.info();
@@ -131,7 +128,7 @@ void GreedyShipScheduler::handleShipAtBerth(Map &map, Ship &ship,std::vector<Ber
 }
 
 // 初始化泊位的状态
-void GreedyShipScheduler::updateBerthStatus(std::vector<Ship> &ships,std::vector<Berth> &berths,std::vector<Goods> & goods, std::vector<Robot> &robots){
+void GreedyShipScheduler::updateBerthStatus(std::vector<Ship> &ships,std::vector<Berth> &berths,GoodsStore &goods, std::vector<Robot> &robots){
     // 遍历泊位，初始化泊位的正常货物量和未到达货物量，计算泊位价值
     for(auto &berth : berths){
         berth.totalValue = 0;
@@ -140,7 +137,7 @@ void GreedyShipScheduler::updateBerthStatus(std::vector<Ship> &ships,std::vector
         berth.shipInBerthNum = 0;
         berth.futureValue = 0;
         berth.onRouteTime = INT_MAX;
-        berth.residue_num = berth.reached_goods.size();
+        berth.residue_num = berth.reachedNum();
     }
     // 遍历船只，更新前泊位上的船只数量和更新溢出货物量
     for(auto &ship : ships){
@@ -150,47 +147,45 @@ void GreedyShipScheduler::updateBerthStatus(std::vector<Ship> &ships,std::vector
             berths[ship.berthId].shipInBerthNum += 1;
             // 记录船前往泊位上的时间
             if (ship.shipStatus == ShipStatusSpace::ShipStatus::MOVING_TO_BERTH) berths[ship.berthId].onRouteTime = std::min(static_cast<int>(ship.path.size()), berths[ship.berthId].onRouteTime);
+            if(berths[ship.berthId].onRouteTime == INT_MAX) berths[ship.berthId].onRouteTime = 0;
         }
-        if(berths[ship.berthId].onRouteTime == INT_MAX) berths[ship.berthId].onRouteTime = 0;
     }
-    // 遍历泊位，累加当前溢出货物价值
+    // 泊位价值为全部堆积货物的价值，溢出价值为船装不下的最后 residue_num 个货物的价值
     for(auto &berth : berths){
-        int reachGoodsSize = static_cast<int>(berth.reached_goods.size());
-        for(int index = 0; index < reachGoodsSize - berth.residue_num && index < reachGoodsSize; index++){
-            berth.totalValue += berth.reached_goods[index].value;
-        }
-        for(int index = reachGoodsSize - berth.residue_num; index < reachGoodsSize && index >= 0; index++){
-            berth.totalValue += berth.reached_goods[index].value;
-            berth.residue_value += berth.reached_goods[index].value;
-        }
+        int reachGoodsSize = berth.reachedNum();
+        berth.totalValue = berth.reachedValue();
+        if (berth.residue_num > 0)
+            berth.residue_value = berth.reachedValue(reachGoodsSize - berth.residue_num, reachGoodsSize);
     }
     // 终局前
     if (CURRENT_FRAME < FINAL_FRAME){
         //  遍历货物，更新泊位的未到达货物的价值，用来估算泊位未来价值futureValue
         // todo 根据货物到达泊位的距离进行加权影响
-        for(auto &good: goods){
+        for(GoodsID id : goods.assignedGoods()){
+            Goods &good = goods[id];
             // 已分配的货物（状态1），根据距离选泊位； 
-            if (good.status == 1 && good.distsToBerths[0].second <= GOOD_DISTANCE_LIMIT && good.TTL >= GOOD_DISTANCE_LIMIT){
-                berths[good.distsToBerths[0].first].futureValue += calculateGoodValueByDist(good);
+            if ( good.distsToBerths[0].second <= GOOD_DISTANCE_LIMIT && goods.ttl(id) >= GOOD_DISTANCE_LIMIT){
+                berths[good.distsToBerths[0].first].futureValue += calculateGoodValueByDist(goods, id);
             }
         }
         for (auto &robot: robots){
             // 累加运送途中的货物价值
             if (robot.type==0 && robot.carryingItem == 1 && robot.carryingItemId != -1 && robot.targetid != -1){
-                berths[robot.targetid].futureValue += calculateGoodValueByDist(goods[robot.carryingItemId]);
+                berths[robot.targetid].futureValue += calculateGoodValueByDist(goods, robot.carryingItemId);
             }
             if (robot.type==1 && robot.carryingItem == 2 && robot.carryingItemId != -1 && robot.carryingItemId2 != -1 && robot.targetid != -1) {
-                berths[robot.targetid].futureValue += calculateGoodValueByDist(goods[robot.carryingItemId]);
-                berths[robot.targetid].futureValue += calculateGoodValueByDist(goods[robot.carryingItemId2]);
+                berths[robot.targetid].futureValue += calculateGoodValueByDist(goods, robot.carryingItemId);
+                berths[robot.targetid].futureValue += calculateGoodValueByDist(goods, robot.carryingItemId2);
             }
         }
     }
 }
 
 // 根据货物距离泊位距离计算货物价值(选取最短距离)
-float GreedyShipScheduler::calculateGoodValueByDist(Goods &good){
+float GreedyShipScheduler::calculateGoodValueByDist(const GoodsStore &goods, GoodsID id){
+    const Goods &good = goods[id];
     // 过期前无法到达则价值为0
-    if(good.distsToBerths[0].second > good.TTL) return 0;
+    if(good.distsToBerths[0].second > goods.ttl(id)) return 0;
 
     // todo 设置超参，超过 distLimit 范围货物价值不予考虑
     int distLimit = 500;
@@ -214,20 +209,20 @@ bool GreedyShipScheduler::shouldDepartBerth( Ship &ship,std::vector<Berth> &bert
 
 // 判断泊位上是否有货物可装载
 bool GreedyShipScheduler::isThereGoodsToLoad(Berth &berth){
-    if(berth.reached_goods.size() != 0) return true;
+    if(berth.reachedNum() != 0) return true;
     else return false;
 }
 
 // 判断泊位上短时间内是否有货物可以状态
-bool GreedyShipScheduler::isThereGoodsToLoadRecently(Berth &berth, std::vector<Goods> &goods){
+bool GreedyShipScheduler::isThereGoodsToLoadRecently(Berth &berth, GoodsStore &goods){
     //  遍历货物，判断SHIP_WAIT_TIME_LIMIT时间内有没有货物到达
     int value = 0;
-    for(auto &good : goods){
-        if((good.status == 1 || good.status == 2)
-        && good.distsToBerths[0].first == berth.id
+    for(GoodsID id : goods.assignedGoods()){
+        const Goods &good = goods[id];
+        if(good.distsToBerths[0].first == berth.id
         && good.distsToBerths[0].second <= SHIP_WAIT_TIME_LIMIT
-        && good.distsToBerths[0].second <= good.TTL
-        && good.TTL != INT_MAX){
+        && good.distsToBerths[0].second <= goods.ttl(id)
+        && goods.ttl(id) != INT_MAX){
             value += good.value;
         }
     }
@@ -241,14 +236,14 @@ bool GreedyShipScheduler::isThereGoodsToLoadRecently(Berth &berth, std::vector<G
 }
 
 // 判断泊位最近有没有货物到来
-bool GreedyShipScheduler::isGoodsArrivingSoon(Berth &berth, std::vector<Goods> goods){
+bool GreedyShipScheduler::isGoodsArrivingSoon(Berth &berth, GoodsStore &goods){
     // todo 15000后期修改成超参数
     int timeToWait = std::min(TIME_TO_WAIT, 15000 - CURRENT_FRAME - berth.timeToDelivery() - 5);
-    for(auto good : goods){
-        if((good.status == 1 || good.status == 2)
-        && good.distsToBerths[0].first == berth.id
+    for(GoodsID id : goods.assignedGoods()){
+        const Goods &good = goods[id];
+        if(good.distsToBerths[0].first == berth.id
         && good.distsToBerths[0].second <= timeToWait
-        && good.distsToBerths[0].second <= good.TTL){
+        && good.distsToBerths[0].second <= goods.ttl(id)){
             return true;
         }
     }
@@ -257,7 +252,7 @@ bool GreedyShipScheduler::isGoodsArrivingSoon(Berth &berth, std::vector<Goods> g
 
 // 当船在虚拟点时，选择最佳调度策略
 // todo 后续要判断时间是否足够（排序）
-void GreedyShipScheduler::scheduleShipAtDelivery(Map& map, Ship &ship, std::vector<Berth> &berths, const std::vector<Goods> &goods){
+void GreedyShipScheduler::scheduleShipAtDelivery(Map& map, Ship &ship, std::vector<Berth> &berths, const GoodsStore &goods){
     std::vector<std::pair<BerthID, float>> profitBerths;
     
     if (ship.deliveryId == -1){
@@ -287,10 +282,12 @@ void GreedyShipScheduler::scheduleShipAtDelivery(Map& map, Ship &ship, std::vect
         }
     }
 
-    // 泊位选取有误 && 进去终局前报错
-    if (bestBerthAndProfit.first == -1 && CURRENT_FRAME < FINAL_FRAME){
-        LOGE("scheduleShipAtDelivery：泊位分配有误，每个泊位上都有船");
-        ship.info();
+    // 泊位选取有误，进去终局前报错
+    if (bestBerthAndProfit.first == -1){
+        if (CURRENT_FRAME < FINAL_FRAME){
+            LOGE("scheduleShipAtDelivery：泊位分配有误，每个泊位上都有船");
+            ship.info();
+        }
         return;
     }
 
@@ -300,7 +297,7 @@ void GreedyShipScheduler::scheduleShipAtDelivery(Map& map, Ship &ship, std::vect
 
 // 当船在泊位时（没货），选择最佳调度策略（去泊位|去虚拟点）
 // todo 后续要判断时间是否足够(排序)
-void GreedyShipScheduler::scheduleFreeShipAtBerth(Map& map, Ship &ship, std::vector<Berth> &berths, const std::vector<Goods> &goods){
+void GreedyShipScheduler::scheduleFreeShipAtBerth(Map& map, Ship &ship, std::vector<Berth> &berths, const GoodsStore &goods){
     std::vector<std::pair<BerthID, float>> profitBerths;
     std::vector<std::pair<int, float>> profitDelivery;  //第一维是交货点id，第二维是去交货点收益
 
@@ -379,10 +376,10 @@ void GreedyShipScheduler::scheduleFreeShipAtBerth(Map& map, Ship &ship, std::vec
 }
 
 // 当船在购买点时
-void GreedyShipScheduler::scheduleShipAtShipShops(Map& map, Ship &ship, std::vector<Berth> &berths, const std::vector<Goods> &goods){
+void GreedyShipScheduler::scheduleShipAtShipShops(Map& map, Ship &ship, std::vector<Berth> &berths, const GoodsStore &goods){
     std::vector<std::pair<BerthID, float>> profitBerths; // 第一维是泊位id，第二维是收益
     for (auto &berth : berths){
-        int distance = map.maritimeBerthDistanceMap[berth.id][ship.locAndDir.pos.x][ship.locAndDir.pos.y];
+        int distance = map.maritimeBerthDistanceMap.get(berth.id, ship.locAndDir.pos.x, ship.locAndDir.pos.y);
         profitBerths.push_back({berth.id, berth.totalValue + berth.futureValue / distance});
     }
 
@@ -420,14 +417,12 @@ std::pair<int, int> GreedyShipScheduler::calculateShipProfitInBerth(Map &map, Sh
     int value = 0;
 
     // 计算船留在原地的价值
-    if (berth.id == ship.berthId) return {berth.totalValue - berth.residue_value + berth.futureValue, std::min(static_cast<int>(ship.nowCapacity() / berth.velocity), static_cast<int>(berth.reached_goods.size() / berth.velocity))};
+    if (berth.id == ship.berthId) return {berth.totalValue - berth.residue_value + berth.futureValue, std::min(static_cast<int>(ship.nowCapacity() / berth.velocity), static_cast<int>(berth.reachedNum() / berth.velocity))};
     
-    startIndex = berth.reached_goods.size() - berth.residue_num;    //船到该泊位上装载货物的起始id
-    endIndex = std::min(startIndex + ship.nowCapacity(), static_cast<int>(berth.reached_goods.size()));   //船能装载的货物
+    startIndex = berth.reachedNum() - berth.residue_num;    //船到该泊位上装载货物的起始id
+    endIndex = std::min(startIndex + ship.nowCapacity(), berth.reachedNum());   //船能装载的货物
+    value = berth.reachedValue(startIndex, endIndex);
 
-    for( int i = startIndex; i < endIndex; i++)
-        value += berth.reached_goods[i].value;
-    
     return {value, endIndex - startIndex};
 }
 
@@ -461,17 +456,13 @@ void GreedyShipScheduler::updateBerthWhenShipMove(Ship &ship,std::vector<Berth>
     BerthID nowBerthId = ship.berthId;
     berths[nowBerthId].shipInBerthNum -= 1;
     berths[nowBerthId].residue_num += ship.nowCapacity();
-    int startIndex = berths[nowBerthId].reached_goods.size() - berths[nowBerthId].residue_num;
-    for(int index = startIndex;index < berths[nowBerthId].reached_goods.size() && index < startIndex + ship.nowCapacity(); index++){
-        berths[nowBerthId].totalValue += berths[nowBerthId].reached_goods[index].value;
-    }
+    int startIndex = berths[nowBerthId].reachedNum() - berths[nowBerthId].residue_num;
+    berths[nowBerthId].totalValue += berths[nowBerthId].reachedValue(startIndex, startIndex + ship.nowCapacity());
     // 目标泊位状态更新
     berths[targetId].shipInBerthNum += 1;
     berths[targetId].residue_num -= ship.nowCapacity();
-    startIndex = berths[targetId].reached_goods.size() - berths[targetId].residue_num - ship.nowCapacity();
-    for(int index = startIndex;index < berths[targetId].reached_goods.size() && index < startIndex + ship.nowCapacity(); index++){
-        berths[targetId].totalValue -= berths[targetId].reached_goods[index].value;
-    }
+    startIndex = berths[targetId].reachedNum() - berths[targetId].residue_num - ship.nowCapacity();
+    berths[targetId].totalValue -= berths[targetId].reachedValue(startIndex, startIndex + ship.nowCapacity());
     // #ifdef DEBUG
     // assert(berths[nowBerthId].shipInBerthNum >= 0);
     // assert(berths[targetId].shipInBerthNum >= 0);
@@ -482,8 +473,9 @@ void GreedyShipScheduler::updateBerthWhenShipMove(Ship &ship,std::vector<Berth>
 // 获取最近的交货点
 // todo 后续要判断该虚拟点是否能在结束前到达
 int GreedyShipScheduler::allocateDelivery( Berth &berth){
-    int deliveryId = berth.distsToDelivery[0].first;
-    return deliveryId;
+    // 与行程规划选同一个交货点，都不可达时退回最近的一个
+    int deliveryId = berth.nearestDelivery().first;
+    return deliveryId != -1 ? deliveryId : berth.distsToDelivery[0].first;
 }
 
 
@@ -494,7 +486,7 @@ bool GreedyShipScheduler::canShipMoveToBerth(Map &map, Ship &ship, Berth &berth)
     // 判断时间是否足够
     int timeCostToBerth =0;
     if (ship.isIdle()){
-        timeCostToBerth = map.maritimeBerthDistanceMap[berth.id][ship.locAndDir.pos.x][ship.locAndDir.pos.y];
+        timeCostToBerth = map.maritimeBerthDistanceMap.get(berth.id, ship.locAndDir.pos.x, ship.locAndDir.pos.y);
     }
     // 泊位前往泊位
     else if(ship.berthId != -1){
@@ -507,13 +499,18 @@ bool GreedyShipScheduler::canShipMoveToBerth(Map &map, Ship &ship, Berth &berth)
     }
     // 时间：移动到泊位距离 + 目标泊位到虚拟点距离 + 装货时间
     int deliveryId = allocateDelivery(berth);
+    // 航线长度为 0 表示没有预存航线，去了也寻不到路
+    if (timeCostToBerth <= 0 || map.berthToDeliveryDistance[berth.id][deliveryId] <= 0){
+        LOGI("没有前往泊位", berth.id, "或从泊位交货的航线");
+        return false;
+    }
     int timeCost = timeCostToBerth +  map.berthToDeliveryDistance[berth.id][deliveryId]
-     + std::min(static_cast<int>(ship.nowCapacity() / berth.velocity), static_cast<int>(berth.reached_goods.size() / berth.velocity)) + 15;
+     + std::min(static_cast<int>(ship.nowCapacity() / berth.velocity), static_cast<int>(berth.reachedNum() / berth.velocity)) + 15;
 
     if (CURRENT_FRAME + timeCost + 2 > 15000){
         LOGI("时间不够去另一个泊位", berth.id, "，消耗时间：", timeCost);
         LOGI("前往泊位距离：", timeCostToBerth);
-        LOGI("装货时间：", std::min(static_cast<int>(ship.nowCapacity() / berth.velocity), static_cast<int>(berth.reached_goods.size() / berth.velocity)));
+        LOGI("装货时间：", std::min(static_cast<int>(ship.nowCapacity() / berth.velocity), static_cast<int>(berth.reachedNum() / berth.velocity)));
         LOGI("泊位前往交货点距离：", map.berthToDeliveryDistance[berth.id][deliveryId]);
         ship.info();
         return false;
@@ -528,7 +525,7 @@ bool GreedyShipScheduler::canShipMoveToBerth(Map &map, Ship &ship, Berth &berth)
         return true;
     // 可以在预定船来临前进入泊位
     // todo 视效果可以注释
-    else if (berth.onRouteTime > timeCostToBerth + 10 + static_cast<int>(berth.reached_goods.size())) {
+    else if (berth.onRouteTime > timeCostToBerth + 10 + berth.reachedNum()) {
         LOGI("泊位容量已满，插队");
         berth.info();
         LOGI("船插队时长：", timeCostToBerth);
@@ -10,7 +10,7 @@ public:
     void scheduleShips(Map &map,
                   std::vector<Ship> &ships,
                   std::vector<Berth> &berths,
-                  std::vector<Goods> &goods,
+                  GoodsStore &goods,
                   std::vector<Robot> &robots) override;
     // 设置参数
     void setParameter(const Params &params) override;
@@ -40,13 +40,13 @@ private:
 
 private:
     // 初始化泊位的状态
-    void updateBerthStatus(std::vector<Ship> &ships,std::vector<Berth> &berths,std::vector<Goods> & goods, std::vector<Robot> &robots);
+    void updateBerthStatus(std::vector<Ship> &ships,std::vector<Berth> &berths,GoodsStore &goods, std::vector<Robot> &robots);
 
     // 根据货物距离泊位距离计算货物价值
-    float calculateGoodValueByDist(Goods &good);
+    float calculateGoodValueByDist(const GoodsStore &goods, GoodsID id);
 
     // // 计算一段时间内泊位的价值收益，同时考虑泊位自身前往虚拟点的时间
-    // float calculateBerthFutureValue(std::vector<Berth> &berths, std::vector<Goods> &goods,int timeSpan);
+    // float calculateBerthFutureValue(std::vector<Berth> &berths, GoodsStore &goods,int timeSpan);
 
     // 判断船只是否需要前往虚拟点
     // 1. 容量满了； 2. 游戏快结束了
@@ -56,22 +56,22 @@ private:
     bool isThereGoodsToLoad(Berth &berth); 
 
     // 判断泊位上短时间内是否有货物可以状态
-    bool isThereGoodsToLoadRecently(Berth &berth, std::vector<Goods> &goods); 
+    bool isThereGoodsToLoadRecently(Berth &berth, GoodsStore &goods); 
 
     // 判断泊位最近有没有货物到来
-    bool isGoodsArrivingSoon(Berth &berth, std::vector<Goods> goods); 
+    bool isGoodsArrivingSoon(Berth &berth, GoodsStore &goods); 
 
     // 为船找到最佳泊位，返回泊位id
-    BerthID findBestBerthForShip(Map& map, Ship &ship, std::vector<Berth> &berths, const std::vector<Goods> &goods);
+    BerthID findBestBerthForShip(Map& map, Ship &ship, std::vector<Berth> &berths, const GoodsStore &goods);
 
     // 当船在虚拟点时，选择最佳调度策略
-    void scheduleShipAtDelivery(Map& map, Ship &ship, std::vector<Berth> &berths, const std::vector<Goods> &goods);
+    void scheduleShipAtDelivery(Map& map, Ship &ship, std::vector<Berth> &berths, const GoodsStore &goods);
 
     // 当船在泊位时（没货），选择最佳调度策略（去泊位|去虚拟点）
-    void scheduleFreeShipAtBerth(Map& map, Ship &ship, std::vector<Berth> &berths, const std::vector<Goods> &goods);
+    void scheduleFreeShipAtBerth(Map& map, Ship &ship, std::vector<Berth> &berths, const GoodsStore &goods);
 
     // 当船在购买点时
-    void scheduleShipAtShipShops(Map& map, Ship &ship, std::vector<Berth> &berths, const std::vector<Goods> &goods);
+    void scheduleShipAtShipShops(Map& map, Ship &ship, std::vector<Berth> &berths, const GoodsStore &goods);
 
     // 计算船在该泊位上能得到多少收益（只考虑泊位上已有的货物）
     std::pair<int, int> calculateShipProfitInBerth(Map &map, Ship &ship, Berth &berth);
@@ -79,17 +79,17 @@ private:
     // 判断船可以前往其他泊位
     bool canMoveBerth(Map &map, Ship &ship,Berth &Berth);
 
-    void handleShipOnRoute(Map& map, Ship &ship,std::vector<Berth> &berths,std::vector<Goods> &goods);
+    void handleShipOnRoute(Map& map, Ship &ship,std::vector<Berth> &berths,GoodsStore &goods);
 
-    void handleShipAtBerth(Map &map, Ship &ship,std::vector<Berth> &berths,std::vector<Goods> &goods);
+    void handleShipAtBerth(Map &map, Ship &ship,std::vector<Berth> &berths,GoodsStore &goods);
 
     // 处理在虚拟点的情况
     ShipActionSpace::ShipAction
-    handleShipInEnd( Ship &ship,std::vector<Berth> &berths,std::vector<Goods> &goods);
+    handleShipInEnd( Ship &ship,std::vector<Berth> &berths,GoodsStore &goods);
 
     // 处理在泊位外等待的情况
     ShipActionSpace::ShipAction
-    handleShipWaiting( Ship &ship,std::vector<Berth> &berths,std::vector<Goods> &goods);
+    handleShipWaiting( Ship &ship,std::vector<Berth> &berths,GoodsStore &goods);
 
     // 比较船去两个泊位的收益
     bool compareBerthsValue(Berth &a,Berth &b);
@@ -0,0 +1,398 @@
+#include "hierarchicalPathfinder.h"
+#include "threadPool.h"
+#include <tuple>
+
+namespace
+{
+    inline const Point2d &corePosition(const Point2d &pos) { return pos; }
+    inline int directionOf(const Point2d &) { return 0; }
+
+    // 可以作为簇间穿越边的动作：四邻域移动
+    template <class Graph, class Visit>
+    inline void crossingMoves(const Graph &graph, const Point2d &pos, Visit &&visit)
+    {
+        BidirectionalMoves<Point2d>::successors(graph, pos, visit);
+    }
+
+    // 簇边界上的一次穿越，同一 key 下 along 连续的穿越组成一段入口
+    struct Crossing
+    {
+        int fromCluster, toCluster, dx, dy, direction, perp, along;
+        int fromState, toState;
+        inline auto key() const { return std::tie(fromCluster, toCluster, dx, dy, direction, perp); }
+        inline bool operator<(const Crossing &rhs) const
+        {
+            return std::tie(fromCluster, toCluster, dx, dy, direction, perp, along) <
+                   std::tie(rhs.fromCluster, rhs.toCluster, rhs.dx, rhs.dy, rhs.direction, rhs.perp, rhs.along);
+        }
+    };
+
+    constexpr int ENTRANCE_SPLIT_LENGTH = 6; // 入口段达到该长度时两端也作为节点
+
+    // 状态层面局部搜索的缓冲区，每个线程一份
+    GridSearchWorkspace &localWorkspace()
+    {
+        static thread_local GridSearchWorkspace ws;
+        return ws;
+    }
+    IndexedDaryHeap<4> &localFrontier()
+    {
+        static thread_local IndexedDaryHeap<4> frontier;
+        return frontier;
+    }
+
+    // 抽象图上 A* 的缓冲区，每个线程一份，最后一个节点为虚拟终点
+    struct RouteWorkspace
+    {
+        std::vector<int> costSoFar;
+        std::vector<int> cameFrom;
+        std::vector<int> toGoal;             // 节点到终点的代价，只对终点簇内连通的节点有效
+        std::vector<uint32_t> visitedStamp;
+        std::vector<uint32_t> goalStamp;
+        uint32_t generation = 0;
+        IndexedDaryHeap<4> frontier;
+
+        void prepare(size_t nodeCount)
+        {
+            if (visitedStamp.size() != nodeCount)
+            {
+                costSoFar.assign(nodeCount, 0);
+                cameFrom.assign(nodeCount, -1);
+                toGoal.assign(nodeCount, 0);
+                visitedStamp.assign(nodeCount, 0);
+                goalStamp.assign(nodeCount, 0);
+                generation = 0;
+            }
+            if (++generation == 0)
+            {
+                std::fill(visitedStamp.begin(), visitedStamp.end(), 0);
+                std::fill(goalStamp.begin(), goalStamp.end(), 0);
+                generation = 1;
+            }
+            frontier.reset(nodeCount);
+        }
+    };
+    RouteWorkspace &routeWorkspace()
+    {
+        static thread_local RouteWorkspace ws;
+        return ws;
+    }
+}
+
+template <class Location>
+void HierarchicalGraph<Location>::build(const Map &map, int clusterSize, const std::vector<Location> &chokepoints,
+                                        int minDistance, int lookahead)
+{
+    this->rows = map.rows;
+    this->cols = map.cols;
+    this->clusterSize = std::max(4, clusterSize);
+    this->clusterRows = (rows + this->clusterSize - 1) / this->clusterSize;
+    this->clusterCols = (cols + this->clusterSize - 1) / this->clusterSize;
+    this->minDistance = minDistance;
+    this->lookahead = static_cast<size_t>(std::max(1, lookahead));
+    nodeState.clear();
+    edges.clear();
+    stateNode.assign(static_cast<size_t>(rows) * cols * Indexer::layers, -1);
+    clusterNodes.assign(static_cast<size_t>(clusterRows) * clusterCols, std::vector<int>());
+
+    StaticMapView view(map);
+    findEntrances(view);
+    for (const Location &loc : chokepoints)
+        if (view.inBounds(loc) && view.passable(loc))
+            addNode(Indexer::toIndex(loc, cols));
+
+    // 各簇的节点只向自己的出边写入，可以并行
+    ThreadPool pool;
+    for (int cluster = 0; cluster < static_cast<int>(clusterNodes.size()); ++cluster)
+        if (clusterNodes[cluster].size() > 1)
+            pool.submit([this, &view, cluster]()
+                        { connectCluster(view, cluster); });
+    pool.wait();
+    built = true;
+}
+
+template <class Location>
+int HierarchicalGraph<Location>::addNode(int state)
+{
+    if (stateNode[state] >= 0)
+        return stateNode[state];
+    int node = static_cast<int>(nodeState.size());
+    stateNode[state] = node;
+    nodeState.push_back(state);
+    edges.emplace_back();
+    clusterNodes[clusterOf(Indexer::fromIndex(state, cols))].push_back(node);
+    return node;
+}
+
+template <class Location>
+void HierarchicalGraph<Location>::findEntrances(const StaticMapView &view)
+{
+    std::vector<Crossing> crossings;
+    const int stateCount = rows * cols * Indexer::layers;
+    for (int state = 0; state < stateCount; ++state)
+    {
+        const Location loc = Indexer::fromIndex(state, cols);
+        if (!view.passable(loc))
+            continue;
+        const Point2d &pos = corePosition(loc);
+        const int fromCluster = clusterOf(pos);
+        crossingMoves(view, loc, [&](const Location &next)
+                      {
+            const Point2d &nextPos = corePosition(next);
+            const int toCluster = clusterOf(nextPos);
+            if (toCluster == fromCluster)
+                return;
+            // 上下相邻的簇沿 y 方向排列入口，其余沿 x 方向
+            const bool horizontalBorder = fromCluster % clusterCols == toCluster % clusterCols;
+            crossings.push_back(Crossing{fromCluster, toCluster, nextPos.x - pos.x, nextPos.y - pos.y, directionOf(loc),
+                                         horizontalBorder ? pos.x : pos.y, horizontalBorder ? pos.y : pos.x,
+                                         state, Indexer::toIndex(next, cols)}); });
+    }
+    std::sort(crossings.begin(), crossings.end());
+
+    auto addCrossing = [&](const Crossing &crossing)
+    {
+        int from = addNode(crossing.fromState), to = addNode(crossing.toState);
+        edges[from].push_back(Edge{to, view.cost(Indexer::fromIndex(crossing.fromState, cols),
+                                                 Indexer::fromIndex(crossing.toState, cols))});
+    };
+    for (size_t begin = 0; begin < crossings.size();)
+    {
+        size_t end = begin + 1;
+        while (end < crossings.size() && crossings[end].key() == crossings[begin].key() &&
+               crossings[end].along == crossings[end - 1].along + 1)
+            ++end;
+        const size_t length = end - begin;
+        addCrossing(crossings[begin + (length - 1) / 2]);
+        if (length >= ENTRANCE_SPLIT_LENGTH)
+        {
+            addCrossing(crossings[begin]);
+            addCrossing(crossings[end - 1]);
+        }
+        begin = end;
+    }
+}
+
+template <class Location>
+void HierarchicalGraph<Location>::connectCluster(const StaticMapView &view, int cluster)
+{
+    const std::vector<int> &nodes = clusterNodes[cluster];
+    const Box box = clusterBox(cluster);
+    for (int from : nodes)
+    {
+        searchNodes<false>(view, Indexer::fromIndex(nodeState[from], cols), box, static_cast<int>(nodes.size()),
+                           [&](int to, int cost)
+                           {
+                               if (to != from)
+                                   edges[from].push_back(Edge{to, cost});
+                           });
+    }
+}
+
+template <class Location>
+template <bool Backward, class Graph, class OnNode>
+void HierarchicalGraph<Location>::searchNodes(const Graph &graph, const Location &source, const Box &box,
+                                              int targetCount, OnNode &&onNode) const
+{
+    const size_t stateCount = stateNode.size();
+    GridSearchWorkspace &ws = localWorkspace();
+    ws.prepare(stateCount);
+    IndexedDaryHeap<4> &frontier = localFrontier();
+    frontier.reset(stateCount);
+
+    const int sourceIndex = Indexer::toIndex(source, cols);
+    ws.visit(sourceIndex, -1, 0);
+    frontier.put(sourceIndex, 0);
+    int found = 0;
+    while (!frontier.empty() && found < targetCount)
+    {
+        const int currentIndex = frontier.get();
+        const int currentCost = ws.costSoFar[currentIndex];
+        if (stateNode[currentIndex] >= 0)
+        {
+            onNode(stateNode[currentIndex], currentCost);
+            ++found;
+        }
+        const Location current = Indexer::fromIndex(currentIndex, cols);
+        auto relax = [&](const Location &next)
+        {
+            if (!box.contains(corePosition(next)))
+                return;
+            int newCost = currentCost + (Backward ? graph.cost(next, current) : graph.cost(current, next));
+            int nextIndex = Indexer::toIndex(next, cols);
+            if (ws.visited(nextIndex) && ws.costSoFar[nextIndex] <= newCost)
+                return;
+            ws.visit(nextIndex, currentIndex, newCost);
+            frontier.put(nextIndex, newCost);
+        };
+        if (Backward)
+            Moves::predecessors(graph, current, relax);
+        else
+            Moves::successors(graph, current, relax);
+    }
+}
+
+template <class Location>
+bool HierarchicalGraph<Location>::accepts(const Location &start, const Location &goal) const
+{
+    return built && clusterOf(start) != clusterOf(goal) &&
+           Point2d::calculateManhattanDistance(corePosition(start), corePosition(goal)) >= minDistance;
+}
+
+template <class Location>
+bool HierarchicalGraph<Location>::findRoute(const Map &map, const Location &start, const Location &goal,
+                                            HierarchicalRoute<Location> &route) const
+{
+    route.clear();
+    if (!built || !map.inBounds(start) || !map.inBounds(goal))
+        return false;
+    const int startCluster = clusterOf(start), goalCluster = clusterOf(goal);
+    if (startCluster == goalCluster)
+        return false;
+
+    const int goalNode = static_cast<int>(nodeState.size());
+    RouteWorkspace &rw = routeWorkspace();
+    rw.prepare(nodeState.size() + 1);
+    auto heuristic = [&](int node)
+    {
+        return node == goalNode ? 0 : Moves::heuristic(Indexer::fromIndex(nodeState[node], cols), goal);
+    };
+    auto relax = [&](int node, int cost, int parent)
+    {
+        if (rw.visitedStamp[node] == rw.generation && rw.costSoFar[node] <= cost)
+            return;
+        rw.visitedStamp[node] = rw.generation;
+        rw.costSoFar[node] = cost;
+        rw.cameFrom[node] = parent;
+        rw.frontier.put(node, cost + heuristic(node));
+    };
+
+    // 终点簇内沿前驱搜索各节点到终点的代价，远处使用原始地图
+    bool goalLinked = false;
+    searchNodes<true>(StaticMapView(map), goal, clusterBox(goalCluster), static_cast<int>(clusterNodes[goalCluster].size()),
+                      [&](int node, int cost)
+                      {
+                          rw.goalStamp[node] = rw.generation;
+                          rw.toGoal[node] = cost;
+                          goalLinked = true;
+                      });
+    if (!goalLinked)
+        return false;
+    // 起点簇内在当前地图上搜索，避开附近的临时障碍物
+    searchNodes<false>(map, start, clusterBox(startCluster), static_cast<int>(clusterNodes[startCluster].size()),
+                       [&](int node, int cost)
+                       { relax(node, cost, -1); });
+
+    bool found = false;
+    while (!rw.frontier.empty())
+    {
+        const int current = rw.frontier.get();
+        if (current == goalNode)
+        {
+            found = true;
+            break;
+        }
+        const int currentCost = rw.costSoFar[current];
+        for (const Edge &edge : edges[current])
+            relax(edge.to, currentCost + edge.cost, current);
+        if (rw.goalStamp[current] == rw.generation)
+            relax(goalNode, currentCost + rw.toGoal[current], current);
+    }
+    if (!found)
+        return false;
+
+    // 从终点回溯得到的顺序正好是逆序存储的路标
+    const int total = rw.costSoFar[goalNode];
+    route.waypoints.push_back(goal);
+    route.costToGoal.push_back(0);
+    for (int node = rw.cameFrom[goalNode]; node != -1; node = rw.cameFrom[node])
+    {
+        Location loc = Indexer::fromIndex(nodeState[node], cols);
+        if (loc == start || loc == route.waypoints.back())
+            continue;
+        route.waypoints.push_back(loc);
+        route.costToGoal.push_back(total - rw.costSoFar[node]);
+    }
+    route.anchor = start;
+    route.pendingCost = total;
+    return true;
+}
+
+template <class Location>
+template <class Graph>
+bool HierarchicalGraph<Location>::refineSegment(const Graph &graph, const Location &from, const Location &to,
+                                                Path<Location> &out) const
+{
+    out.clear();
+    if (!graph.passable(to))
+        return false;
+    const Box a = clusterBox(clusterOf(from)), b = clusterBox(clusterOf(to));
+    const Box box{std::min(a.x0, b.x0), std::min(a.y0, b.y0), std::max(a.x1, b.x1), std::max(a.y1, b.y1)};
+
+    const size_t stateCount = stateNode.size();
+    GridSearchWorkspace &ws = localWorkspace();
+    ws.prepare(stateCount);
+    IndexedDaryHeap<4> &frontier = localFrontier();
+    frontier.reset(stateCount);
+
+    const int fromIndex = Indexer::toIndex(from, cols), toIndex = Indexer::toIndex(to, cols);
+    ws.visit(fromIndex, -1, 0);
+    frontier.put(fromIndex, Moves::heuristic(from, to));
+    while (!frontier.empty())
+    {
+        const int currentIndex = frontier.get();
+        if (currentIndex == toIndex)
+        {
+            for (int index = toIndex; index != fromIndex; index = ws.cameFrom[index])
+                out.push_back(Indexer::fromIndex(index, cols));
+            return true;
+        }
+        const int currentCost = ws.costSoFar[currentIndex];
+        const Location current = Indexer::fromIndex(currentIndex, cols);
+        Moves::successors(graph, current, [&](const Location &next)
+                          {
+            if (!box.contains(corePosition(next)))
+                return;
+            int newCost = currentCost + graph.cost(current, next);
+            int nextIndex = Indexer::toIndex(next, cols);
+            if (ws.visited(nextIndex) && ws.costSoFar[nextIndex] <= newCost)
+                return;
+            ws.visit(nextIndex, currentIndex, newCost);
+            frontier.put(nextIndex, newCost + Moves::heuristic(next, to)); });
+    }
+    return false;
+}
+
+template <class Location>
+bool HierarchicalGraph<Location>::extendPath(const Map &map, const Location &current, HierarchicalRoute<Location> &route,
+                                             Path<Location> &path) const
+{
+    if (route.empty())
+        return true;
+    // 路径末端不是上次细化的位置，说明路径已被其他逻辑替换
+    if (path.empty() ? route.anchor != current : path.front() != route.anchor)
+        return false;
+    StaticMapView view(map);
+    Path<Location> segment;
+    while (!route.empty() && path.size() < lookahead)
+    {
+        const Location from = path.empty() ? current : path.front();
+        const Location &to = route.waypoints.back();
+        if (from != to)
+        {
+            // 只有从当前位置出发的一段需要避开临时障碍物
+            bool refined = path.empty() ? refineSegment(map, from, to, segment) : refineSegment(view, from, to, segment);
+            if (!refined)
+                return false;
+            path.insert(path.begin(), segment.begin(), segment.end());
+        }
+        route.anchor = to;
+        route.pendingCost = route.costToGoal.back();
+        route.waypoints.pop_back();
+        route.costToGoal.pop_back();
+    }
+    return true;
+}
+
+// 显式实例化
+template class HierarchicalGraph<Point2d>;
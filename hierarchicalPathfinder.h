@@ -0,0 +1,126 @@
+#pragma once
+#include "map.h"
+#include "pathFinder.h"
+#include "bidirectionalAStar.h"
+#include "priorityQueue.h"
+#include <vector>
+#include <cstdint>
+
+// 只读原始地图的视图，建图和细化远处路段时使用，不受临时障碍物影响
+struct StaticMapView
+{
+    static constexpr const std::array<Point2d, 4> &DIRS = Map::DIRS;
+    const Map &map;
+    int rows, cols;
+
+    explicit StaticMapView(const Map &map) : map(map), rows(map.rows), cols(map.cols) {}
+
+    inline bool inBounds(const Point2d &pos) const { return map.inBounds(pos); }
+    inline bool passable(const Point2d &pos) const { return map.staticPassable(pos); }
+    template <class Location>
+    inline int cost(const Location &from, const Location &to) const { return map.cost(from, to); }
+};
+
+// 分层寻路的查询结果，路标逆序存储：back 为下一个待细化的路标，front 为终点
+template <class Location>
+struct HierarchicalRoute
+{
+    std::vector<Location> waypoints;
+    std::vector<int> costToGoal; // 与 waypoints 一一对应，该路标到终点的抽象代价
+    Location anchor;             // 已细化路径的末端，路径被外部替换后路标失效
+    int pendingCost = 0;         // anchor 到终点的抽象代价，用于估计剩余路径长度
+
+    inline bool empty() const { return waypoints.empty(); }
+    inline void clear()
+    {
+        waypoints.clear();
+        costToGoal.clear();
+        pendingCost = 0;
+    }
+};
+
+// HPA*：把地图按 clusterSize 划分成簇，簇边界上连续的可穿越段取中点（较长时加上两端）作为入口节点，
+// 单行路两端作为天然的瓶颈也加入节点；簇内节点两两之间的代价在初始化时用限制在簇内的搜索求出
+// 查询时起点和终点先连接到各自簇内的节点，再在抽象图上 A*，路径按路标分段、随着前进逐段细化
+// 只用于机器人，抽象图找不到路径时由调用方退回完整 A*
+template <class Location>
+class HierarchicalGraph
+{
+public:
+    static HierarchicalGraph &getInstance()
+    {
+        static HierarchicalGraph graph;
+        return graph;
+    }
+
+    // 用原始地图建立抽象图，chokepoints 为额外的入口节点，初始化阶段调用一次
+    void build(const Map &map, int clusterSize, const std::vector<Location> &chokepoints, int minDistance, int lookahead);
+
+    inline bool ready() const { return built; }
+
+    // 起点与终点足够远且位于不同簇时才值得分层寻路
+    bool accepts(const Location &start, const Location &goal) const;
+
+    // 抽象层寻路，成功时写入 route（不含起点），起点连接使用当前地图，其余使用原始地图
+    bool findRoute(const Map &map, const Location &start, const Location &goal, HierarchicalRoute<Location> &route) const;
+
+    // 把 path（逆序存储）向终点方向细化到至少 lookahead 步，第一段从 current 出发时考虑临时障碍物
+    // 路标失效或细化失败时返回 false，调用方应重新寻路
+    bool extendPath(const Map &map, const Location &current, HierarchicalRoute<Location> &route, Path<Location> &path) const;
+
+    inline size_t nodeCount() const { return nodeState.size(); }
+    inline size_t edgeCount() const
+    {
+        size_t count = 0;
+        for (const auto &out : edges)
+            count += out.size();
+        return count;
+    }
+
+private:
+    using Indexer = GridIndexer<Location>;
+    using Moves = BidirectionalMoves<Location>;
+
+    struct Edge
+    {
+        int to;
+        int cost;
+    };
+
+    // 核心点坐标的闭区间范围，限制局部搜索
+    struct Box
+    {
+        int x0, y0, x1, y1;
+        inline bool contains(const Point2d &pos) const { return pos.x >= x0 && pos.x <= x1 && pos.y >= y0 && pos.y <= y1; }
+    };
+
+    inline int clusterOf(const Point2d &pos) const { return (pos.x / clusterSize) * clusterCols + pos.y / clusterSize; }
+    inline Box clusterBox(int cluster) const
+    {
+        int x0 = cluster / clusterCols * clusterSize, y0 = cluster % clusterCols * clusterSize;
+        return Box{x0, y0, std::min(x0 + clusterSize, rows) - 1, std::min(y0 + clusterSize, cols) - 1};
+    }
+
+    int addNode(int state);
+    void findEntrances(const StaticMapView &view);
+    void connectCluster(const StaticMapView &view, int cluster);
+
+    // 在 box 内从 source 出发做 Dijkstra（Backward 时沿前驱），对每个出队的抽象节点调用 onNode(node, cost)
+    template <bool Backward, class Graph, class OnNode>
+    void searchNodes(const Graph &graph, const Location &source, const Box &box, int targetCount, OnNode &&onNode) const;
+
+    // 在 from 和 to 所在的两个簇的包围盒内用 A* 细化一段，找不到时返回 false，由调用方放弃分层路线改为完整寻路，out 逆序不含 from
+    template <class Graph>
+    bool refineSegment(const Graph &graph, const Location &from, const Location &to, Path<Location> &out) const;
+
+private:
+    bool built = false;
+    int rows = 0, cols = 0;
+    int clusterSize = 20, clusterRows = 0, clusterCols = 0;
+    int minDistance = 0;
+    size_t lookahead = 0;
+    std::vector<int> nodeState;                // 抽象节点对应的状态下标
+    std::vector<int> stateNode;                // 状态下标对应的抽象节点，-1 表示不是节点
+    std::vector<std::vector<Edge>> edges;      // 簇间穿越边和簇内最短路边
+    std::vector<std::vector<int>> clusterNodes; // 每个簇内的抽象节点
+};
@@ -6,7 +6,7 @@ class LateGameAssetManager : public AssetManager
 {
 public:
     std::vector<PurchaseDecision> makePurchaseDecision(const Map &gameMap,
-                                                       const std::vector<Goods> &goods,
+                                                       const GoodsStore &goods,
                                                        const std::vector<Robot> &robots,
                                                        const std::vector<Ship> &ships,
                                                        const std::vector<Berth> &berths,
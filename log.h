@@ -6,7 +6,11 @@
 #include <cstring>
 #include <sstream>
 #include <iomanip>
-#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <type_traits>
 #include "assert.h"
 
 // 定义日志级别
@@ -15,31 +19,31 @@
 #define LOG_LEVEL_ERROR 2
 #define LOG_LEVEL_NONE 3
 
-// 在这里设置当前的日志级别
+// 在这里设置当前的日志级别，低于该级别的日志调用在编译期被去掉
 #define LOG_LEVEL LOG_LEVEL_INFO
 
-#ifdef DEBUG
-// 定义记录宏
+// 使用do { } while(0)是为了确保宏在使用时的语义正确性，比如在if语句中不会出现语法错误
+#define LOG_DISABLED(...) \
+    do                    \
+    {                     \
+    } while (0)
+
+#if defined(DEBUG) && LOG_LEVEL <= LOG_LEVEL_INFO
 #define LOGI(...) Log::logWriteFormatted(LogLevel::INFO, __VA_ARGS__)
-#define LOGW(...) Log::logWriteFormatted(LogLevel::WARNING, __VA_ARGS__)
-#define LOGE(...) Log::logWriteFormatted(LogLevel::ERROR, __VA_ARGS__)
+#else
+#define LOGI(...) LOG_DISABLED(__VA_ARGS__)
+#endif
 
+#if defined(DEBUG) && LOG_LEVEL <= LOG_LEVEL_WARNING
+#define LOGW(...) Log::logWriteFormatted(LogLevel::WARNING, __VA_ARGS__)
 #else
-// 如果没有定义DEBUG，则将LOG宏定义为不执行任何操作的宏
-// 使用do { } while(0)是为了确保宏在使用时的语义正确性，比如在if语句中不会出现语法错误
-#define LOGI(...) \
-    do            \
-    {             \
-    } while (0)
-#define LOGW(...) \
-    do            \
-    {             \
-    } while (0)
-#define LOGE(...) \
-    do            \
-    {             \
-    } while (0)
+#define LOGW(...) LOG_DISABLED(__VA_ARGS__)
+#endif
 
+#if defined(DEBUG) && LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOGE(...) Log::logWriteFormatted(LogLevel::ERROR, __VA_ARGS__)
+#else
+#define LOGE(...) LOG_DISABLED(__VA_ARGS__)
 #endif
 
 enum class LogLevel
@@ -53,12 +57,120 @@ extern int CURRENT_FRAME;
 extern int FINAL_FRAME;
 extern int CURRENT_MONEY;
 
+// 参数编码：数值类型按原始字节保存，字符串保存长度和内容，其他类型在调用线程格式化成字符串后保存
+// 解码在后台线程进行，与编码一一对应
+namespace LogCodec
+{
+    // 写入游标，空间不足时标记溢出，之后的写入全部忽略
+    struct Writer
+    {
+        char *p;
+        char *end;
+        bool overflow = false;
+
+        inline void put(const void *data, size_t n)
+        {
+            if (overflow || static_cast<size_t>(end - p) < n)
+            {
+                overflow = true;
+                return;
+            }
+            std::memcpy(p, data, n);
+            p += n;
+        }
+        inline void putString(const char *s, uint32_t n)
+        {
+            put(&n, sizeof(n));
+            put(s, n);
+        }
+    };
+
+    inline void decodeString(std::ostream &os, const char *&p)
+    {
+        uint32_t n;
+        std::memcpy(&n, p, sizeof(n));
+        os.write(p + sizeof(n), n);
+        p += sizeof(n) + n;
+    }
+
+    template <typename T, typename = void>
+    struct Codec
+    {
+        // 通用类型：按 operator<< 格式化
+        static void encode(Writer &w, const T &value)
+        {
+            std::ostringstream oss;
+            oss << value;
+            const std::string s = oss.str();
+            w.putString(s.data(), static_cast<uint32_t>(s.size()));
+        }
+        static void decode(std::ostream &os, const char *&p) { decodeString(os, p); }
+    };
+
+    template <typename T>
+    struct Codec<T, std::enable_if_t<std::is_arithmetic_v<T>>>
+    {
+        static void encode(Writer &w, const T &value) { w.put(&value, sizeof(T)); }
+        static void decode(std::ostream &os, const char *&p)
+        {
+            T value;
+            std::memcpy(&value, p, sizeof(T));
+            os << value;
+            p += sizeof(T);
+        }
+    };
+
+    template <>
+    struct Codec<std::string>
+    {
+        static void encode(Writer &w, const std::string &value) { w.putString(value.data(), static_cast<uint32_t>(value.size())); }
+        static void decode(std::ostream &os, const char *&p) { decodeString(os, p); }
+    };
+
+    // 字符串字面量按 decay 后的 char* 处理
+    template <>
+    struct Codec<const char *>
+    {
+        static void encode(Writer &w, const char *value) { w.putString(value, static_cast<uint32_t>(std::strlen(value))); }
+        static void decode(std::ostream &os, const char *&p) { decodeString(os, p); }
+    };
+    template <>
+    struct Codec<char *> : Codec<const char *>
+    {
+    };
+
+    template <typename... Args>
+    void decodeAll(std::ostream &os, const char *p)
+    {
+        (Codec<Args>::decode(os, p), ...);
+    }
+}
+
 class Log
 {
+public:
+    static constexpr size_t RING_SIZE = 1 << 14; // 日志记录槽数，必须为 2 的幂
+    static constexpr size_t PAYLOAD_SIZE = 232;  // 每条记录内联保存的参数字节数
+
 private:
+    // 一条日志记录，序号用于多生产者单消费者的无锁环形队列
+    struct Record
+    {
+        std::atomic<size_t> sequence;
+        LogLevel level;
+        int frame;
+        void (*decode)(std::ostream &, const char *); // 与调用点参数类型对应的解码函数，为空时 payload 保存一个 std::string*
+        char payload[PAYLOAD_SIZE];
+    };
+
     std::ofstream m_OutputStream;
     LogLevel m_LogLevel = LogLevel::INFO;
-    std::mutex writeMutex;
+    std::unique_ptr<Record[]> ring;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) size_t dequeuePos = 0;
+    std::atomic<size_t> droppedRecords{0};
+    std::atomic<bool> running{false};
+    std::thread writer;
 
     Log() {}
     Log(const Log &) = delete;
@@ -85,31 +197,39 @@ public:
     }
     static void logWrite(const std::string &message, LogLevel level = LogLevel::INFO)
     {
-        auto &instance = getInstance();
-        std::lock_guard<std::mutex> lock(instance.writeMutex);
-        instance.logWriteImpl(message, level);
-    }
-
-    // 一个辅助函数，用于递归终止
-    static void logMessage(std::ostringstream &stream)
-    {
-        // 递归终止时不做任何事
-    }
-
-    // 递归地将参数添加到输出流中
-    template <typename T, typename... Args>
-    static void logMessage(std::ostringstream &stream, const T &value, const Args &...args)
-    {
-        stream << value;
-        logMessage(stream, args...);
+        logWriteFormatted(level, message);
     }
 
+    // 在调用线程只做参数编码，格式化和写文件由后台线程完成
     template <typename... Args>
     static void logWriteFormatted(LogLevel level, const Args &...args)
     {
-        std::ostringstream stream;
-        logMessage(stream, args...);
-        logWrite(stream.str(), level);
+        auto &instance = getInstance();
+        if (!instance.running.load(std::memory_order_relaxed) || level < instance.m_LogLevel)
+            return;
+        size_t pos;
+        Record *record = instance.claim(pos);
+        if (record == nullptr)
+        {
+            instance.droppedRecords.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        record->level = level;
+        record->frame = CURRENT_FRAME;
+        LogCodec::Writer w{record->payload, record->payload + PAYLOAD_SIZE};
+        (LogCodec::Codec<std::decay_t<Args>>::encode(w, args), ...);
+        if (!w.overflow)
+            record->decode = &LogCodec::decodeAll<std::decay_t<Args>...>;
+        else
+        {
+            // 参数太长时退化为在调用线程格式化
+            std::ostringstream stream;
+            (stream << ... << args);
+            std::string *message = new std::string(stream.str());
+            std::memcpy(record->payload, &message, sizeof(message));
+            record->decode = nullptr;
+        }
+        record->sequence.store(pos + 1, std::memory_order_release);
     }
 
     template <typename T>
@@ -122,15 +242,78 @@ public:
     }
 
 private:
+    // 申请一个空槽，队列满时返回 nullptr，不阻塞调用线程
+    Record *claim(size_t &pos)
+    {
+        pos = enqueuePos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Record *record = &ring[pos & (RING_SIZE - 1)];
+            size_t seq = record->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    return record;
+            }
+            else if (diff < 0)
+                return nullptr;
+            else
+                pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    // 取出并写入所有已提交的记录，返回写入条数
+    size_t drain()
+    {
+        size_t count = 0;
+        while (true)
+        {
+            Record *record = &ring[dequeuePos & (RING_SIZE - 1)];
+            if (record->sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+                break;
+            writeRecord(*record);
+            record->sequence.store(dequeuePos + RING_SIZE, std::memory_order_release);
+            ++dequeuePos;
+            ++count;
+        }
+        size_t dropped = droppedRecords.exchange(0, std::memory_order_relaxed);
+        if (dropped)
+            m_OutputStream << "[LOG] 日志队列已满，丢弃 " << dropped << " 条\n";
+        return count;
+    }
+
+    void writerLoop()
+    {
+        while (running.load(std::memory_order_acquire))
+        {
+            if (drain() == 0)
+            {
+                m_OutputStream.flush();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        drain();
+        m_OutputStream.flush();
+    }
+
     void initLogImpl(const std::string &filepath = "log.log")
     {
         m_OutputStream.open(filepath, std::ios::out); // 设置 app 就是为追加模式
         assert(m_OutputStream);
         writeHeader();
+        ring.reset(new Record[RING_SIZE]);
+        for (size_t i = 0; i < RING_SIZE; ++i)
+            ring[i].sequence.store(i, std::memory_order_relaxed);
+        running.store(true, std::memory_order_release);
+        writer = std::thread([this]()
+                             { writerLoop(); });
     }
 
     void endLogImpl()
     {
+        if (running.exchange(false))
+            writer.join();
         if (m_OutputStream.is_open())
         {
             m_OutputStream.close();
@@ -147,26 +330,12 @@ private:
         m_OutputStream.flush();
     }
 
-    void logWriteImpl(const std::string &message, LogLevel level)
+    void writeRecord(const Record &record)
     {
-        if (level < m_LogLevel) // 如果日志级别低于当前设置的级别，则不记录
-            return;
-
-        // auto now = std::chrono::system_clock::now();
-        // std::time_t now_time = std::chrono::system_clock::to_time_t(now);
-
-        // std::string timeStr = std::ctime(&now_time);
-        // if (!timeStr.empty() && timeStr[timeStr.length() - 1] == '\n')
-        // {
-        //     timeStr.erase(timeStr.length() - 1); // 去除换行符
-        // }
-
-        // m_OutputStream << "[" << timeStr << "] ";
-
-        m_OutputStream << "[" << std::setw(5) << CURRENT_FRAME << "] ";
+        m_OutputStream << "[" << std::setw(5) << record.frame << "] ";
 
         // 根据日志级别添加不同的前缀
-        switch (level)
+        switch (record.level)
         {
         case LogLevel::INFO:
             m_OutputStream << "[INFO]    ";
@@ -179,7 +348,15 @@ private:
             break;
         }
 
-        m_OutputStream << message << "\n";
-        m_OutputStream.flush();
+        if (record.decode)
+            record.decode(m_OutputStream, record.payload);
+        else
+        {
+            std::string *message;
+            std::memcpy(&message, record.payload, sizeof(message));
+            m_OutputStream << *message;
+            delete message;
+        }
+        m_OutputStream << "\n";
     }
-};
\ No newline at end of file
+};
@@ -17,6 +17,8 @@ int main()
     auto start = std::chrono::high_resolution_clock::now();
 
     GameManager gameManager;
+    // 预计算快照目录，目录不存在时不读写快照
+    gameManager.artifactDirectory = "../artifacts";
     gameManager.initializeGame();
     
     auto stop = std::chrono::high_resolution_clock::now();
@@ -82,12 +84,8 @@ int main()
         //     }
         //     break;
         // }
-        auto start = std::chrono::steady_clock::now();
         gameManager.update();
-        auto end = std::chrono::steady_clock::now();
-        int time = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-        LOGI("本帧处理时间：",time,"ms");
-        
+
         gameManager.outputCommands();
     }
 
@@ -8,50 +8,28 @@
 #include "log.h"
 #include <unordered_set>
 #include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <numeric>
 
 
 std::array<Point2d, 4> Map::DIRS = {
     /* East, West, North, South */
     Point2d{1, 0}, Point2d{-1, 0}, Point2d{0, -1}, Point2d{0, 1}};
 
-std::vector<Point2d> Map::neighbors(const Point2d &pos) const
+NeighborList<Point2d, 4> Map::neighbors(const Point2d &pos) const
 {
-    std::vector<Point2d> results;
-    results.reserve(4);
-
-    for (const Point2d &dir : DIRS)
-    {
-        Point2d next{pos.x + dir.x, pos.y + dir.y};
-        if (inBounds(next) && passable(next))
-        {
-            results.push_back(next);
-        }
-    }
-
-    if ((pos.x + pos.y) % (rand()%3+1) == 0)
-    {
-        // see "Ugly paths" section for an explanation:
-        std::reverse(results.begin(), results.end());
-    }
-
+    NeighborList<Point2d, 4> results;
+    forEachNeighbor(pos, [&results](const Point2d &next, int)
+                    { results.push_back(next); });
     return results;
 }
 
-std::vector<VectorPosition> Map::neighbors(const VectorPosition &vp) const
+NeighborList<VectorPosition, 3> Map::neighbors(const VectorPosition &vp) const
 {
-    std::vector<VectorPosition> results;
-    results.reserve(3);
-    // 前进 1 格或者旋转一次
-    // TODO: 某些区域进行了多次检查，可以进行优化
-    VectorPosition moveForward = SpatialUtils::moveForward(vp);
-    if(inBounds(moveForward) && passable(moveForward))
-        results.push_back(moveForward);
-    VectorPosition rotate = SpatialUtils::anticlockwiseRotation(vp);
-    if(inBounds(rotate) && passable(rotate))
-        results.push_back(rotate);
-    rotate = SpatialUtils::clockwiseRotation(vp);
-    if(inBounds(rotate) && passable(rotate))
-        results.push_back(rotate);
+    NeighborList<VectorPosition, 3> results;
+    forEachNeighbor(vp, [&results](const VectorPosition &next, int)
+                    { results.push_back(next); });
     return results;
 }
 
@@ -66,43 +44,30 @@ bool Map::isInMainRoad(const Point2d &pos) const
 
 bool Map::isInSealane(const Point2d &pos) const
 {
-    MapItemSpace::MapItem item = getCell(pos);
-    return (item == MapItemSpace::MapItem::SEA_LANE ||
-            item == MapItemSpace::MapItem::SHIP_SHOP ||
-            item == MapItemSpace::MapItem::BERTH ||
-            item == MapItemSpace::MapItem::MOORING_AREA ||
-            item == MapItemSpace::MapItem::HYBRID_LANE ||
-            item == MapItemSpace::MapItem::DELIVERY_POINT);
+    return isSealaneItem(readOnlyGrid[pos.x][pos.y]);
 }
 
 bool Map::inBounds(const VectorPosition &vp) const
 {
-    auto [topLeft, bottomRight] = SpatialUtils::getShipOccupancyRect(vp);
-    for (int x = topLeft.x; x <= bottomRight.x; ++x)
-    {
-        for (int y = topLeft.y; y <= bottomRight.y; ++y)
-        {
-            if (!inBounds(Point2d(x, y)))
-            {
-                return false;
-            }
-        }
-    }
-    return true;
+    // 矩形的两个角都在地图内即可
+    const SpatialUtils::RectOffset &rect = SpatialUtils::SHIP_RECT[static_cast<int>(vp.direction)];
+    return inBounds(vp.pos.x + rect.topLeft.dx, vp.pos.y + rect.topLeft.dy) &&
+           inBounds(vp.pos.x + rect.bottomRight.dx, vp.pos.y + rect.bottomRight.dy);
 }
 
 bool Map::passable(const VectorPosition &vp) const
 {
-    auto [topLeft, bottomRight] = SpatialUtils::getShipOccupancyRect(vp);
-    for (int x = topLeft.x; x <= bottomRight.x; ++x)
+    if (!staticShipPassable(vp))
+        return false;
+    if (shipObstacleCells.empty())
+        return true;
+    // 只考虑其他船舶的临时障碍，船体压到任何一个就不可达
+    const uint8_t *counts = shipObstacleCount.data();
+    const int core = vp.pos.x * cols + vp.pos.y;
+    for (const SpatialUtils::Offset &offset : SpatialUtils::SHIP_FOOTPRINT[static_cast<int>(vp.direction)])
     {
-        for (int y = topLeft.y; y <= bottomRight.y; ++y)
-        {
-            if (!seaPassable(Point2d(x, y)))
-            {
-                return false;
-            }
-        }
+        if (counts[core + offset.dx * cols + offset.dy] != 0)
+            return false;
     }
     return true;
 }
@@ -182,70 +147,300 @@ std::string Map::drawMap(std::unordered_map<Point2d, double> *distances,
     return result;
 }
 
-void Map::computeDistancesToBerthViaBFS(BerthID id, const std::vector<Point2d> &positions)
+// 在行主序网格上做多源 BFS，结果写入 dis，queue 由调用方提供以复用内存，positions 为任意 Point2d 序列
+template <typename Sources, typename SourcePred, typename EnterPred>
+static void flatGridBFS(int rows, int cols, const Sources &positions, uint16_t *dis,
+                        std::vector<int> &queue, SourcePred canStart, EnterPred canEnter)
 {
-    using std::vector, std::queue;
-    vector<vector<int>> dis(rows, vector<int>(cols, INT_MAX));
-    queue<Point2d> nextToVisitQueue;
+    std::fill(dis, dis + rows * cols, DistanceTensor::UNREACHABLE);
+    queue.resize(static_cast<size_t>(rows) * cols);
+    int head = 0, tail = 0;
     for (const Point2d &pos : positions)
     {
-        if (inBounds(pos) && passable(pos))
+        if (pos.x < 0 || pos.x >= rows || pos.y < 0 || pos.y >= cols || !canStart(pos))
+            continue;
+        int index = pos.x * cols + pos.y;
+        if (dis[index] == DistanceTensor::UNREACHABLE)
         {
-            dis[pos.x][pos.y] = 0;
-            nextToVisitQueue.push(pos);
+            dis[index] = 0;
+            queue[tail++] = index;
         }
     }
-    while (!nextToVisitQueue.empty())
+    while (head < tail)
     {
-        Point2d current = nextToVisitQueue.front();
-        nextToVisitQueue.pop();
-        for (const Point2d &dir : DIRS)
+        int current = queue[head++];
+        int x = current / cols, y = current % cols;
+        uint16_t nextDis = dis[current] + 1;
+        for (const Point2d &dir : Map::DIRS)
         {
-            Point2d next{current.x + dir.x, current.y + dir.y};
-            if (inBounds(next) && passable(next) && dis[next.x][next.y] == INT_MAX)
+            int nx = x + dir.x, ny = y + dir.y;
+            if (nx < 0 || nx >= rows || ny < 0 || ny >= cols)
+                continue;
+            int next = nx * cols + ny;
+            if (dis[next] == DistanceTensor::UNREACHABLE && canEnter(Point2d(nx, ny)))
             {
-                dis[next.x][next.y] = dis[current.x][current.y] + 1;
-                nextToVisitQueue.push(next);
+                dis[next] = nextDis;
+                queue[tail++] = next;
             }
         }
     }
-    berthDistanceMap[id] = dis;
+}
+
+void Map::computeDistancesToBerthViaBFS(BerthID id, const std::vector<Point2d> &positions)
+{
+    std::vector<int> queue;
+    auto landPassable = [this](const Point2d &pos) { return passable(pos); };
+    flatGridBFS(rows, cols, positions, berthDistanceMap.layer(id), queue, landPassable, landPassable);
+}
+
+void Map::computeLandDistanceField(const Point2d &start, uint16_t *dis, std::vector<int> &queue) const
+{
+    // 只看原始地图，其他机器人的位置每帧都在变化，不应影响距离场
+    auto landPassable = [this](const Point2d &pos) { return staticPassable(pos); };
+    flatGridBFS(rows, cols, std::array<Point2d, 1>{start}, dis, queue, landPassable, landPassable);
 }
 
 void Map::computeMaritimeBerthDistanceViaBFS(BerthID id, const std::vector<Point2d> &positions)
 {
-    using std::vector, std::queue;
-    vector<vector<int>> dis(rows, vector<int>(cols, INT_MAX));
-    queue<Point2d> nextToVisitQueue;
-    for (const Point2d &pos : positions)
+    if (shipPoseMask.size() == 0)
+        computeShipPoseMask();
+    std::vector<int> queue;
+    flatGridBFS(rows, cols, positions, maritimeBerthDistanceMap.layer(id), queue,
+                [this](const Point2d &pos) { return seaPassable(pos); },
+                [this](const Point2d &pos) { return canShipOccupy(pos); });
+}
+
+void Map::computeShipPoseMask()
+{
+    shipPoseMask = GridBuffer<uint16_t>(rows, cols, 0);
+    for (int x = 0; x < rows; ++x)
     {
-        if (inBounds(pos) && seaPassable(pos))
+        for (int y = 0; y < cols; ++y)
         {
-            dis[pos.x][pos.y] = 0;
-            nextToVisitQueue.push(pos);
+            uint16_t mask = 0;
+            for (int d = 0; d < 4; ++d)
+            {
+                const SpatialUtils::RectOffset &rect = SpatialUtils::SHIP_RECT[d];
+                bool legal = true;
+                int sealaneRows = 0;
+                for (int cx = x + rect.topLeft.dx; cx <= x + rect.bottomRight.dx; ++cx)
+                {
+                    bool rowInSealane = false;
+                    for (int cy = y + rect.topLeft.dy; cy <= y + rect.bottomRight.dy; ++cy)
+                    {
+                        if (!inBounds(cx, cy))
+                        {
+                            legal = false;
+                            continue;
+                        }
+                        legal = legal && isSeaPassable(readOnlyGrid[cx][cy]);
+                        rowInSealane = rowInSealane || isSealaneItem(readOnlyGrid[cx][cy]);
+                    }
+                    sealaneRows += rowInSealane;
+                }
+                if (legal)
+                    mask |= POSE_LEGAL << d;
+                if (sealaneRows > 0)
+                    mask |= POSE_SEALANE << d;
+                mask |= sealaneRows << (POSE_SEALANE_ROWS_SHIFT + 2 * d);
+            }
+            shipPoseMask[x][y] = mask;
         }
     }
-    while (!nextToVisitQueue.empty())
+}
+
+void Map::computeAllBerthDistanceFields(const std::vector<std::pair<BerthID, std::vector<Point2d>>> &berthAreas)
+{
+    if (berthAreas.empty())
+        return;
+    if (shipPoseMask.size() == 0)
+        computeShipPoseMask();
+    // 先分配好所有层，工作线程只写各自的层，不会触发扩容
+    int maxID = 0;
+    for (const auto &[id, positions] : berthAreas)
+        maxID = std::max(maxID, id);
+    berthDistanceMap.layer(maxID);
+    maritimeBerthDistanceMap.layer(maxID);
+
+    // 每个任务是一个泊位的一张距离场，偶数为陆地，奇数为海洋
+    const int jobNum = static_cast<int>(berthAreas.size()) * 2;
+    std::atomic<int> nextJob(0);
+    auto worker = [&]()
+    {
+        std::vector<int> queue;
+        auto landPassable = [this](const Point2d &pos) { return passable(pos); };
+        auto seaStart = [this](const Point2d &pos) { return seaPassable(pos); };
+        auto seaEnter = [this](const Point2d &pos) { return canShipOccupy(pos); };
+        for (int job = nextJob++; job < jobNum; job = nextJob++)
+        {
+            const auto &[id, positions] = berthAreas[job / 2];
+            if (job % 2 == 0)
+                flatGridBFS(rows, cols, positions, berthDistanceMap.layer(id), queue, landPassable, landPassable);
+            else
+                flatGridBFS(rows, cols, positions, maritimeBerthDistanceMap.layer(id), queue, seaStart, seaEnter);
+        }
+    };
+    int threadNum = std::min<int>(jobNum, std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threadNum; ++i)
+        workers.emplace_back(worker);
+    worker();
+    for (auto &t : workers)
+        t.join();
+}
+
+// 并查集，根为集合中最小的下标，标号顺序与扫描顺序一致
+namespace
+{
+    struct DisjointSet
     {
-        Point2d current = nextToVisitQueue.front();
-        nextToVisitQueue.pop();
-        for (const Point2d &dir : DIRS)
+        std::vector<int> parent;
+
+        explicit DisjointSet(int n) : parent(n) { std::iota(parent.begin(), parent.end(), 0); }
+        int find(int x)
+        {
+            while (parent[x] != x)
+            {
+                parent[x] = parent[parent[x]];
+                x = parent[x];
+            }
+            return x;
+        }
+        void unite(int a, int b)
         {
-            Point2d next{current.x + dir.x, current.y + dir.y};
-            if (inBounds(next) && seaPassable(next) && dis[next.x][next.y] == INT_MAX)
+            a = find(a);
+            b = find(b);
+            if (a != b)
+                parent[std::max(a, b)] = std::min(a, b);
+        }
+    };
+}
+
+void Map::computeConnectedComponents(const std::vector<std::pair<BerthID, std::vector<Point2d>>> &berthAreas)
+{
+    if (shipPoseMask.size() == 0)
+        computeShipPoseMask();
+    const int cellNum = rows * cols;
+    int berthNum = 0;
+    for (const auto &[id, positions] : berthAreas)
+        berthNum = std::max(berthNum, id + 1);
+
+    // 与距离场的 BFS 相同：member 为可以进入的格子，source 为可以作为起点的泊位格子
+    // 泊位作为额外的节点 cellNum + id，与它的起点格子能进入的连通块合并
+    auto label = [&](auto member, auto source, GridBuffer<int> &components, std::vector<int> &berthComponents)
+    {
+        DisjointSet set(cellNum + berthNum);
+        for (int x = 0; x < rows; ++x)
+            for (int y = 0; y < cols; ++y)
+            {
+                if (!member(x, y))
+                    continue;
+                if (x + 1 < rows && member(x + 1, y))
+                    set.unite(x * cols + y, (x + 1) * cols + y);
+                if (y + 1 < cols && member(x, y + 1))
+                    set.unite(x * cols + y, x * cols + y + 1);
+            }
+        for (const auto &[id, positions] : berthAreas)
+            for (const Point2d &pos : positions)
             {
-                if ((inBounds(VectorPosition(next, Direction::EAST)) && passable(VectorPosition(next, Direction::EAST))) ||
-                    (inBounds(VectorPosition(next, Direction::WEST)) && passable(VectorPosition(next, Direction::WEST))) ||
-                    (inBounds(VectorPosition(next, Direction::NORTH)) && passable(VectorPosition(next, Direction::NORTH))) ||
-                    (inBounds(VectorPosition(next, Direction::SOUTH)) && passable(VectorPosition(next, Direction::SOUTH))))
+                if (!inBounds(pos) || !source(pos.x, pos.y))
+                    continue;
+                if (member(pos.x, pos.y))
                 {
-                    dis[next.x][next.y] = dis[current.x][current.y] + 1;
-                    nextToVisitQueue.push(next);
+                    set.unite(cellNum + id, pos.x * cols + pos.y);
+                    continue;
+                }
+                for (const Point2d &dir : DIRS)
+                {
+                    int nx = pos.x + dir.x, ny = pos.y + dir.y;
+                    if (inBounds(nx, ny) && member(nx, ny))
+                        set.unite(cellNum + id, nx * cols + ny);
                 }
             }
+
+        // 根压缩为连续的标号
+        std::vector<int> rootLabel(cellNum + berthNum, -1);
+        int componentNum = 0;
+        auto labelOf = [&](int node)
+        {
+            int root = set.find(node);
+            if (rootLabel[root] == -1)
+                rootLabel[root] = componentNum++;
+            return rootLabel[root];
+        };
+        components = GridBuffer<int>(rows, cols, -1);
+        for (int x = 0; x < rows; ++x)
+            for (int y = 0; y < cols; ++y)
+                if (member(x, y))
+                    components[x][y] = labelOf(x * cols + y);
+        berthComponents.assign(berthNum, -1);
+        for (const auto &[id, positions] : berthAreas)
+        {
+            berthComponents[id] = labelOf(cellNum + id);
+            for (const Point2d &pos : positions)
+                if (inBounds(pos) && source(pos.x, pos.y))
+                    components[pos.x][pos.y] = berthComponents[id];
+        }
+        return componentNum;
+    };
+
+    int landNum = label([this](int x, int y) { return isLandPassable(grid[x][y]); },
+                        [this](int x, int y) { return isLandPassable(grid[x][y]); },
+                        landComponent, berthLandComponent);
+    // 海洋直接由距离场推出：同一泊位距离场覆盖的格子同标号，两个泊位的距离场有公共格子时合并
+    // 没有任何泊位能到达的格子标为 -1，船从那里出发哪里也去不了
+    DisjointSet berthSet(berthNum);
+    std::vector<int> firstBerth(cellNum, -1);
+    for (const auto &[id, positions] : berthAreas)
+    {
+        if (!maritimeBerthDistanceMap.contains(id))
+            continue;
+        const uint16_t *dis = maritimeBerthDistanceMap.layer(id);
+        for (int index = 0; index < cellNum; ++index)
+        {
+            if (dis[index] == DistanceTensor::UNREACHABLE)
+                continue;
+            if (firstBerth[index] == -1)
+                firstBerth[index] = id;
+            else
+                berthSet.unite(firstBerth[index], id);
         }
     }
-    maritimeBerthDistanceMap[id] = dis;
+    std::vector<int> seaRootLabel(berthNum, -1);
+    int seaNum = 0;
+    auto seaLabelOf = [&](int id)
+    {
+        int root = berthSet.find(id);
+        if (seaRootLabel[root] == -1)
+            seaRootLabel[root] = seaNum++;
+        return seaRootLabel[root];
+    };
+    seaComponent = GridBuffer<int>(rows, cols, -1);
+    for (int x = 0; x < rows; ++x)
+        for (int y = 0; y < cols; ++y)
+            if (firstBerth[x * cols + y] != -1)
+                seaComponent[x][y] = seaLabelOf(firstBerth[x * cols + y]);
+    berthSeaComponent.assign(berthNum, -1);
+    for (const auto &[id, positions] : berthAreas)
+        berthSeaComponent[id] = seaLabelOf(id);
+
+    landComponentSize.assign(landNum, 0);
+    for (int x = 0; x < rows; ++x)
+        for (int y = 0; y < cols; ++y)
+            if (landComponent[x][y] != -1)
+                ++landComponentSize[landComponent[x][y]];
+    landComponentHasBerth.assign(landNum, false);
+    for (int component : berthLandComponent)
+        if (component != -1)
+            landComponentHasBerth[component] = true;
+
+    // 泊位之间的陆地距离，泊位左上角为目标点
+    berthToBerthLandDistance.assign(berthNum, std::vector<int>(berthNum, INT_MAX));
+    for (const auto &[from, fromPositions] : berthAreas)
+        for (const auto &[to, toPositions] : berthAreas)
+            if (!toPositions.empty())
+                berthToBerthLandDistance[from][to] = berthDistanceMap.get(from, toPositions.front());
+    LOGI("陆地连通块数量：", landNum, "，海洋连通块数量：", seaNum);
 }
 
 Direction Map::computeBerthOrientation(const Point2d &pos)
@@ -335,14 +530,14 @@ std::string Map::drawMap(std::vector<std::vector<int>> map, int field_width)
 
 bool Map::isBerthReachable(BerthID id, Point2d &position) const
 {
-    if (berthDistanceMap.at(id)[position.x][position.y] != INT_MAX)
+    if (berthDistanceMap.get(id, position) != INT_MAX)
         return true;
     return false;
 }
 
 int Map::getDistanceToBerth(BerthID id, Point2d &position) const
 {
-    return berthDistanceMap.at(id)[position.x][position.y];
+    return berthDistanceMap.get(id, position);
 }
 
 
@@ -370,6 +565,22 @@ int Map::getDistanceToBerth(BerthID id, Point2d &position) const
 //     return obstacle;
 // }
 
+// 在格子上叠加一个临时障碍，计数从 0 变为 1 时写入 grid 并记下格子
+void Map::pushTemporaryObstacle(const Point2d &pos, MapItemSpace::MapItem item)
+{
+    uint8_t &count = temporaryObstacleCount[pos.x][pos.y];
+    if (count == UINT8_MAX)
+    {
+        LOGE("临时障碍计数溢出, pos: ", pos);
+        return;
+    }
+    if (count++ == 0)
+    {
+        grid[pos.x][pos.y] = item;
+        temporaryObstacleCells.push_back(pos.x * cols + pos.y);
+    }
+}
+
 void Map::addTemporaryObstacle(const Point2d& pos) {
     if (inBounds(pos)) {
         MapItemSpace::MapItem item = getCell(pos);
@@ -381,22 +592,16 @@ void Map::addTemporaryObstacle(const Point2d& pos) {
             // LOGE("往主干道上放置临时障碍, pos: ", pos);
             return;
         }
-        grid[pos.x][pos.y] = MapItemSpace::MapItem::ROBOT; // 标记为障碍物
-        temporaryObstacles.push_back(pos); // 添加到临时障碍物列表
-        temporaryObstaclesRefCount[pos]++;
+        pushTemporaryObstacle(pos, MapItemSpace::MapItem::ROBOT); // 标记为障碍物
     }
 }
 
 
 void Map::removeTemporaryObstacle(const Point2d& pos) {
     if (inBounds(pos)) {
-        auto it = temporaryObstaclesRefCount.find(pos);
-        if (it != temporaryObstaclesRefCount.end()) {
-            if (--it->second <= 0) {
-                temporaryObstaclesRefCount.erase(it);
-                grid[pos.x][pos.y] = readOnlyGrid[pos.x][pos.y];  // 恢复为原始元素
-            }
-        }
+        uint8_t &count = temporaryObstacleCount[pos.x][pos.y];
+        if (count > 0 && --count == 0)
+            grid[pos.x][pos.y] = readOnlyGrid[pos.x][pos.y];  // 恢复为原始元素，格子留在清理列表中，清理时重复恢复无影响
     }
 }
 
@@ -408,7 +613,8 @@ void Map::addTemporaryObstacle(const VectorPosition& vecPos) {
             Point2d pos(x, y);
             if (inBounds(pos))
             {
-                MapItemSpace::MapItem item = getCell(pos);
+                // 只读原始地图，grid 可能正被机器人控制并行修改
+                MapItemSpace::MapItem item = readOnlyGrid[x][y];
                 if (item == MapItemSpace::MapItem::OBSTACLE || item == MapItemSpace::MapItem::SPACE)
                 {
                     LOGE("往船舶不可通行位置上放置临时障碍, pos: ", pos);
@@ -419,9 +625,14 @@ void Map::addTemporaryObstacle(const VectorPosition& vecPos) {
                     // LOGE("往海洋主干道上放置临时障碍, pos: ", pos);
                     continue;
                 }
-                grid[pos.x][pos.y] = MapItemSpace::MapItem::SHIP; // 标记为障碍物
-                temporaryObstacles.push_back(pos);                 // 添加到临时障碍物列表
-                temporaryObstaclesRefCount[pos]++;
+                uint8_t &count = shipObstacleCount[x][y];
+                if (count == UINT8_MAX)
+                {
+                    LOGE("船舶临时障碍计数溢出, pos: ", pos);
+                    continue;
+                }
+                if (count++ == 0)
+                    shipObstacleCells.push_back(x * cols + y);
             }
         }
     }
@@ -433,25 +644,36 @@ void Map::removeTemporaryObstacle(const VectorPosition& vecPos) {
     std::pair<Point2d, Point2d> shipSpace = SpatialUtils::getShipOccupancyRect(vecPos);
     for (int x = shipSpace.first.x; x <= shipSpace.second.x; x++){
         for (int y= shipSpace.first.y; y <= shipSpace.second.y; y++)
-            removeTemporaryObstacle({x, y});
+            if (inBounds({x, y}) && shipObstacleCount[x][y] > 0)
+                --shipObstacleCount[x][y];
     }
 }
 
 void Map::clearTemporaryObstacles() {
-    for (const Point2d& pos : temporaryObstacles) {
-        grid[pos.x][pos.y] = readOnlyGrid[pos.x][pos.y];  // 恢复为原始元素
+    MapItemSpace::MapItem *cells = grid.data();
+    const MapItemSpace::MapItem *origin = readOnlyGrid.data();
+    uint8_t *counts = temporaryObstacleCount.data();
+    for (int index : temporaryObstacleCells) {
+        cells[index] = origin[index];  // 恢复为原始元素
+        counts[index] = 0;
     }
-    temporaryObstacles.clear(); // 清空临时障碍物列表
-    temporaryObstaclesRefCount.clear();
+    temporaryObstacleCells.clear();
+    uint8_t *shipCounts = shipObstacleCount.data();
+    for (int index : shipObstacleCells)
+        shipCounts[index] = 0;
+    shipObstacleCells.clear();
 }
 
 std::vector<Point2d> Map::getNearbyTemporaryObstacles(const Point2d& robotPos, int n) const {
+    // 只扫描以 robotPos 为中心、裁剪到地图范围内的 (2n+1)x(2n+1) 窗口
     std::vector<Point2d> nearbyObstacles;
-    for (int j = -n; j <= n; ++j){
-        for (int k = -n; k <= n; ++k){
-            Point2d next(robotPos + Point2d(j,k));
-            if (inBounds(next) && next!=robotPos && getCell(next) == MapItemSpace::MapItem::ROBOT)
-                nearbyObstacles.push_back(next);
+    const int x0 = std::max(0, robotPos.x - n), x1 = std::min(rows - 1, robotPos.x + n);
+    const int y0 = std::max(0, robotPos.y - n), y1 = std::min(cols - 1, robotPos.y + n);
+    for (int x = x0; x <= x1; ++x){
+        const MapItemSpace::MapItem *row = grid[x];
+        for (int y = y0; y <= y1; ++y){
+            if (row[y] == MapItemSpace::MapItem::ROBOT && (x != robotPos.x || y != robotPos.y))
+                nearbyObstacles.emplace_back(x, y);
         }
     }
     return nearbyObstacles;
@@ -462,9 +684,9 @@ int Map::getNearestBerthID(const Point2d& pos) const
     int result = -1;
     int distance = INT_MAX;
     if(inBounds(pos)) {
-        for (const auto &[ID, map] : berthDistanceMap) {
-            if (map.at(pos.x).at(pos.y) < distance) {
-                distance = map.at(pos.x).at(pos.y);
+        for (int ID = 0; ID < berthDistanceMap.layers(); ++ID) {
+            if (berthDistanceMap.get(ID, pos) < distance) {
+                distance = berthDistanceMap.get(ID, pos);
                 result = ID;
             }
         }
@@ -475,8 +697,8 @@ int Map::getNearestBerthID(const Point2d& pos) const
 std::vector<std::pair<int, int>> Map::computePointToBerthsDistances(Point2d position) const
 {
     std::vector<std::pair<int, int>> result;
-    for (const auto& [berthID, map] : berthDistanceMap) {
-        int dist = berthDistanceMap.at(berthID)[position.x][position.y];
+    for (int berthID = 0; berthID < berthDistanceMap.layers(); ++berthID) {
+        int dist = berthDistanceMap.get(berthID, position);
         if (dist != INT_MAX)
             result.emplace_back(berthID, dist);
     }
@@ -488,31 +710,10 @@ std::vector<std::pair<int, int>> Map::computePointToBerthsDistances(Point2d posi
     return result;
 }
 
-int Map::cost(const VectorPosition &e1, const VectorPosition &e2) const
-{
-    // 邻居节点的代价为 1，处在主航道则为 2
-    // TODO: 下面的计算方法不能处理旋转后核心点的变化问题，会增加旋转的代价
-    // int result = cost(e1.pos, e2.pos) + abs(VectorPosition::minimalRotationStep(e1.direction, e2.direction));
-    int result = 1;
-    auto [topLeft, bottomRight] = SpatialUtils::getShipOccupancyRect(e2);
-    for (int x = topLeft.x; x <= bottomRight.x; ++x)
-    {
-        for (int y = topLeft.y; y <= bottomRight.y; ++y)
-        {
-            if (isInSealane(Point2d(x, y)))
-            {
-                result += 1;
-                break;
-            }
-        }
-    }
-    return result;
-}
-
 float Map::costCosin(const Point2d &robotPos, const Point2d &goodPos, const Point2d &berthPos, const int berthID)
 {
-    int berth2good = berthDistanceMap.at(berthID)[goodPos.x][goodPos.y];
-    int berth2robot = berthDistanceMap.at(berthID)[robotPos.x][robotPos.y];
+    int berth2good = berthDistanceMap.get(berthID, goodPos.x, goodPos.y);
+    int berth2robot = berthDistanceMap.get(berthID, robotPos.x, robotPos.y);
 
     float cosin = Vec2f::cosineOf2Vec(Vec2f(berthPos, robotPos), Vec2f(berthPos, goodPos));
     int cost = static_cast<int>(std::sqrt(berth2good * berth2good + berth2robot * berth2robot - 2 * berth2good * berth2robot * cosin));
@@ -532,7 +733,7 @@ std::vector<std::pair<int, int>> Map::initializeBerthToDeliveryDistances(BerthID
     std::vector<std::pair<int, int>> distsToDelivery;
     for(int deliveryId = 0;deliveryId < deliveryLocations.size(); deliveryId++){
         Point2d pos = deliveryLocations[deliveryId];
-        distsToDelivery.push_back({deliveryId, maritimeBerthDistanceMap[berthId][pos.x][pos.y]});
+        distsToDelivery.push_back({deliveryId, maritimeBerthDistanceMap.get(berthId, pos.x, pos.y)});
     }
     // 升序排列
     std::sort(distsToDelivery.begin(), distsToDelivery.end(), [](std::pair<int, int>& a,std::pair<int, int> &b){
@@ -584,34 +785,17 @@ Direction Map::evaluateBestApproachDirection(const VectorPosition &shipPosition,
 
 // 判断两艘船是否重合，在主航道上的体积不计入，true 是有重叠
 bool Map::hasOverlap(VectorPosition &a, VectorPosition &b) {
-    std::pair<Point2d, Point2d> ship1 = SpatialUtils::getShipOccupancyRect(a);
-    std::pair<Point2d, Point2d> ship2 = SpatialUtils::getShipOccupancyRect(b);
-    std::unordered_set<Point2d> shipSpace;
-    // 遍历第一个船空间
-    for (int x = ship1.first.x; x <= ship1.second.x; x++){
-        for (int y = ship1.first.y; y <= ship1.second.y; y++){
-            shipSpace.insert(Point2d(x, y));
-        }
-    }
-    // 遍历第二个船空间，判断和第一个船空间是否重合
-    for (int x = ship2.first.x; x <= ship2.second.x; x++){
-        for (int y = ship2.first.y; y <= ship2.second.y; y++){
+    // 两个矩形求交，只检查交集里的格子
+    auto [topLeft1, bottomRight1] = SpatialUtils::getShipOccupancyRect(a);
+    auto [topLeft2, bottomRight2] = SpatialUtils::getShipOccupancyRect(b);
+    const int x0 = std::max(topLeft1.x, topLeft2.x), x1 = std::min(bottomRight1.x, bottomRight2.x);
+    const int y0 = std::max(topLeft1.y, topLeft2.y), y1 = std::min(bottomRight1.y, bottomRight2.y);
+    for (int x = x0; x <= x1; x++){
+        for (int y = y0; y <= y1; y++){
             // 重合并且不是主航道，返回true
-            if(shipSpace.find(Point2d(x, y)) != shipSpace.end() && !isInSealane(Point2d(x, y)))
+            if (!inBounds(x, y) || !staticInSealane(Point2d(x, y)))
                 return true;
         }
     }
     return false;
 }
-
-// 给定船核心点，判断船是否位于主航道
-bool Map::isShipInSeaLane(VectorPosition &vecPos){
-    std::pair<Point2d, Point2d> shipSpace = SpatialUtils::getShipOccupancyRect(vecPos);
-    for (int x = shipSpace.first.x; x <= shipSpace.second.x; x++){
-        for (int y = shipSpace.first.y; y <= shipSpace.second.y; y++){
-            if (isInSealane({x, y})) 
-                return true;
-        }
-    }
-    return false;
-}
\ No newline at end of file
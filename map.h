@@ -5,10 +5,13 @@
 #include <string>
 #include <unordered_map>
 #include <functional>
+#include <cstdint>
+#include <climits>
+#include <cstdlib>
 #include "utils.h"
 namespace MapItemSpace
 {
-    enum class MapItem
+    enum class MapItem : int8_t
     {
         // 当机器人和船舶位于主干道或主航道时，地图不应该绘制
         SPACE = 0,      // 空地
@@ -40,23 +43,143 @@ enum class MapFlag
 };
 
 
+// 行主序连续存储的二维网格，grid[x] 返回第 x 行首地址，保留 grid[x][y] 的访问方式
+template <typename T>
+class GridBuffer
+{
+public:
+    GridBuffer() = default;
+    GridBuffer(int rows, int cols, T value) : rows(rows), cols(cols), cells(static_cast<size_t>(rows) * cols, value) {}
+
+    inline T *operator[](int x) { return cells.data() + static_cast<size_t>(x) * cols; }
+    inline const T *operator[](int x) const { return cells.data() + static_cast<size_t>(x) * cols; }
+    inline T *data() { return cells.data(); }
+    inline const T *data() const { return cells.data(); }
+    inline size_t size() const { return cells.size(); }
+    inline int rowCount() const { return rows; }
+    inline int colCount() const { return cols; }
+
+private:
+    int rows = 0, cols = 0;
+    std::vector<T> cells;
+};
+
+// 固定容量的邻居列表，直接存放在栈上，接口与 vector 的只读部分一致
+template <class Location, int Capacity>
+struct NeighborList
+{
+    std::array<Location, Capacity> items;
+    int count = 0;
+
+    inline void push_back(const Location &location) { items[count++] = location; }
+    inline const Location *begin() const { return items.data(); }
+    inline const Location *end() const { return items.data() + count; }
+    inline size_t size() const { return count; }
+    inline bool empty() const { return count == 0; }
+    inline const Location &operator[](int i) const { return items[i]; }
+};
+
+// 所有泊位的距离场，按 [泊位][格子] 连续存储，格子为行主序下标
+class DistanceTensor
+{
+public:
+    static constexpr uint16_t UNREACHABLE = UINT16_MAX; // 不可达，对外统一返回 INT_MAX
+
+    DistanceTensor() = default;
+    DistanceTensor(int rows, int cols) : rows(rows), cols(cols) {}
+
+    // 返回第 id 层的距离场，不存在时扩充层数，新层全部不可达
+    uint16_t *layer(int id)
+    {
+        if (id >= layerNum)
+        {
+            layerNum = id + 1;
+            distances.resize(static_cast<size_t>(layerNum) * rows * cols, UNREACHABLE);
+        }
+        return distances.data() + static_cast<size_t>(id) * rows * cols;
+    }
+    inline const uint16_t *layer(int id) const { return distances.data() + static_cast<size_t>(id) * rows * cols; }
+
+    inline bool contains(int id) const { return id >= 0 && id < layerNum; }
+    inline int layers() const { return layerNum; }
+
+    // 所有层连续存储的原始数据，用于保存和恢复预计算结果
+    inline const uint16_t *data() const { return distances.data(); }
+    inline size_t size() const { return distances.size(); }
+    void assign(int layers, const uint16_t *source)
+    {
+        layerNum = layers;
+        distances.assign(source, source + static_cast<size_t>(layers) * rows * cols);
+    }
+
+    // 距离，不可达返回 INT_MAX
+    inline int get(int id, int x, int y) const
+    {
+        uint16_t d = distances[(static_cast<size_t>(id) * rows + x) * cols + y];
+        return d == UNREACHABLE ? INT_MAX : d;
+    }
+    inline int get(int id, const Point2d &pos) const { return get(id, pos.x, pos.y); }
+
+private:
+    int rows = 0, cols = 0;
+    int layerNum = 0;
+    std::vector<uint16_t> distances;
+};
+
 class Map
 {
     // 地图坐标系原点在左上角，往下为 X 轴正方向，往右为 Y 轴正方向
 public:
     static std::array<Point2d, 4> DIRS;
+
+private:
+    // xorshift32，每个线程一份
+    static inline thread_local uint32_t neighborOrderState = 1;
+    static inline uint32_t nextNeighborOrder()
+    {
+        uint32_t x = neighborOrderState;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return neighborOrderState = x;
+    }
+
+public:
     int rows, cols;
-    std::vector<std::vector<MapItemSpace::MapItem>> grid;                            // 地图
-    std::vector<std::vector<MapItemSpace::MapItem>> readOnlyGrid;                    // 地图的拷贝，只读
-    std::unordered_map<int, std::vector<std::vector<int>>> berthDistanceMap;         // 陆地上所有点到泊位距离图
-    std::unordered_map<int, std::vector<std::vector<int>>> maritimeBerthDistanceMap; // 海洋上所有点到泊位距离图
+    GridBuffer<MapItemSpace::MapItem> grid;         // 地图
+    GridBuffer<MapItemSpace::MapItem> readOnlyGrid; // 地图的拷贝，只读
+    DistanceTensor berthDistanceMap;                // 陆地上所有点到泊位距离图
+    DistanceTensor maritimeBerthDistanceMap;        // 海洋上所有点到泊位距离图
+    // 以该点为核心点时每个朝向 d 的船舶位姿信息：第 d 位为船体在原始地图上可以停留，第 4 + d 位为船体接触主航道，
+    // 第 8 + 2d 起的两位为船体接触主航道的行数
+    GridBuffer<uint16_t> shipPoseMask;
+    static constexpr uint16_t POSE_LEGAL = 0x0001, POSE_SEALANE = 0x0010;
+    static constexpr uint16_t POSE_LEGAL_ANY = 0x000F;
+    static constexpr int POSE_SEALANE_ROWS_SHIFT = 8;
 
     std::vector<std::vector<int>> berthToBerthDistance;    // 第一维是起始泊位id，第二维是目标泊位id
     std::vector<std::vector<int>> berthToDeliveryDistance; // 第一位是起始泊位id，第二维是目标交货点id
+    std::vector<std::vector<int>> berthToBerthLandDistance; // 泊位之间的陆地距离，第一维是起始泊位id，不可达为 INT_MAX
+
+    // 连通块标号，初始化时由并查集一次算出，-1 表示不属于任何连通块
+    // 陆地：可通行格子按四邻接合并；海洋：由泊位的航行距离场推出，距离场有公共格子的泊位合并为一个连通块
+    // 陆地与距离场的可达性一致：berthDistanceMap.get(id, p) 可达当且仅当 landComponent[p] == berthLandComponent[id]
+    // 海洋上 maritimeBerthDistanceMap.get(id, p) 可达时 seaComponent[p] == berthSeaComponent[id]，没有泊位到达的点为 -1；
+    // 反过来标号相同只说明经某个泊位中转能到，需要确切可达性时查距离场
+    GridBuffer<int> landComponent;
+    GridBuffer<int> seaComponent;
+    std::vector<int> berthLandComponent; // 泊位所在的陆地连通块
+    std::vector<int> berthSeaComponent;  // 泊位所在的海洋连通块
+    std::vector<int> landComponentSize;  // 陆地连通块的格子数
+    std::vector<bool> landComponentHasBerth; // 陆地连通块内是否有泊位
 public:
     // std::vector<std::reference_wrapper<Point2d>> robotPosition;  // 实时记录机器人位置（不建议使用）
-    std::vector<Point2d> temporaryObstacles;                     // 临时障碍物的位置
-    std::unordered_map<Point2d, int> temporaryObstaclesRefCount; // 对障碍物进行计数
+    // 临时障碍物直接叠加写在 grid 上，查询可达性只需读一次 grid
+    GridBuffer<uint8_t> temporaryObstacleCount;                  // 每个格子上临时障碍物的引用计数
+    std::vector<int> temporaryObstacleCells;                     // 计数曾从 0 变为 1 的格子，清理时只恢复这些格子
+    // 船舶的临时障碍单独计数，不写入 grid：机器人与船互不碰撞，两边的控制可以并行读写各自的一层
+    GridBuffer<uint8_t> shipObstacleCount;
+    std::vector<int> shipObstacleCells;
     std::vector<Point2d> deliveryLocations;                      // 交货点位置
     std::vector<Point2d> robotShops;                             // 机器人购买位置
     std::vector<Point2d> shipShops;                              // 船舶购买位置
@@ -65,7 +188,11 @@ public:
     Map(int rows, int cols)
         : rows(rows),
           cols(cols),
-          grid(std::vector(rows, std::vector<MapItemSpace::MapItem>(cols, MapItemSpace::MapItem::ERROR)))
+          grid(rows, cols, MapItemSpace::MapItem::ERROR),
+          temporaryObstacleCount(rows, cols, 0),
+          shipObstacleCount(rows, cols, 0),
+          berthDistanceMap(rows, cols),
+          maritimeBerthDistanceMap(rows, cols)
     {
     }
 
@@ -112,7 +239,17 @@ public:
     // 查询 pos 位置在陆地上是否可达
     inline bool passable(const Point2d &pos) const
     {
-        MapItemSpace::MapItem item = getCell(pos);
+        return isLandPassable(getCell(pos));
+    }
+
+    // 查询 pos 位置在原始地图（不含临时障碍物）的陆地上是否可达
+    inline bool staticPassable(const Point2d &pos) const
+    {
+        return isLandPassable(readOnlyGrid[pos.x][pos.y]);
+    }
+
+    static inline bool isLandPassable(MapItemSpace::MapItem item)
+    {
         return (item == MapItemSpace::MapItem::SPACE ||
                 item == MapItemSpace::MapItem::MAIN_ROAD ||
                 item == MapItemSpace::MapItem::ROBOT_SHOP ||
@@ -127,7 +264,17 @@ public:
     // 查询 pos 位置在海洋上是否可达
     inline bool seaPassable(const Point2d &pos) const
     {
-        MapItemSpace::MapItem item = getCell(pos);
+        return isSeaPassable(getCell(pos));
+    }
+
+    // 查询 pos 位置在原始地图（不含临时障碍物）的海洋上是否可达
+    inline bool staticSeaPassable(const Point2d &pos) const
+    {
+        return isSeaPassable(readOnlyGrid[pos.x][pos.y]);
+    }
+
+    static inline bool isSeaPassable(MapItemSpace::MapItem item)
+    {
         return (item == MapItemSpace::MapItem::SEA ||
                 item == MapItemSpace::MapItem::SEA_LANE ||
                 item == MapItemSpace::MapItem::SHIP_SHOP ||
@@ -142,17 +289,61 @@ public:
     bool isInMainRoad(const Point2d &pos) const;
     // 判断是否在主航道上
     bool isInSealane(const Point2d &pos) const;
+    // 判断原始地图上是否是主航道，不受临时障碍物影响
+    inline bool staticInSealane(const Point2d &pos) const
+    {
+        return isSealaneItem(readOnlyGrid[pos.x][pos.y]);
+    }
+    static inline bool isSealaneItem(MapItemSpace::MapItem item)
+    {
+        return (item == MapItemSpace::MapItem::SEA_LANE ||
+                item == MapItemSpace::MapItem::SHIP_SHOP ||
+                item == MapItemSpace::MapItem::BERTH ||
+                item == MapItemSpace::MapItem::MOORING_AREA ||
+                item == MapItemSpace::MapItem::HYBRID_LANE ||
+                item == MapItemSpace::MapItem::DELIVERY_POINT);
+    }
 
     float costCosin(const Point2d &robotPos, const Point2d &goodPos, const Point2d &berthPos, const int berthID);
 
-    // 判断船是否有区域位于主航道
-    bool isShipInSeaLane(VectorPosition &vecPos);
+    // 判断船是否有区域位于主航道，主航道上不会放置临时障碍物，直接查原始地图的掩码
+    inline bool isShipInSeaLane(const VectorPosition &vecPos) const
+    {
+        return inBounds(vecPos.pos) &&
+               (shipPoseMask[vecPos.pos.x][vecPos.pos.y] & (POSE_SEALANE << static_cast<int>(vecPos.direction)));
+    }
 
 public:
     // 计算泊位到地图上所有陆地点的距离，不可通行的记录为 INT_MAX
     void computeDistancesToBerthViaBFS(BerthID id, const std::vector<Point2d> &positions);
     // 计算泊位到地图上所有海洋点的距离，不可通行的记录为 INT_MAX
     void computeMaritimeBerthDistanceViaBFS(BerthID id, const std::vector<Point2d> &positions);
+    // 批量计算所有泊位的陆地和海洋距离场，每个元素为泊位 ID 和泊位占据的坐标
+    void computeAllBerthDistanceFields(const std::vector<std::pair<BerthID, std::vector<Point2d>>> &berthAreas);
+    // 计算陆地和海洋的连通块标号，以及泊位之间的陆地距离矩阵，需要在距离场算好（或从快照恢复）之后调用
+    void computeConnectedComponents(const std::vector<std::pair<BerthID, std::vector<Point2d>>> &berthAreas);
+    inline int landComponentOf(const Point2d &pos) const { return inBounds(pos) ? landComponent[pos.x][pos.y] : -1; }
+    inline int seaComponentOf(const Point2d &pos) const { return inBounds(pos) ? seaComponent[pos.x][pos.y] : -1; }
+    // pos 在陆地上能否到达至少一个泊位
+    inline bool reachesAnyBerthByLand(const Point2d &pos) const
+    {
+        int component = landComponentOf(pos);
+        return component != -1 && landComponentHasBerth[component];
+    }
+    // 计算 start 到原始地图上所有陆地点的距离，写入 dis（大小为 rows * cols），queue 由调用方复用
+    void computeLandDistanceField(const Point2d &start, uint16_t *dis, std::vector<int> &queue) const;
+    // 预计算船舶位姿掩码，只依赖原始地图，读入地图后调用一次
+    void computeShipPoseMask();
+    // 以 pos 为核心点时船舶至少有一个朝向可以停留
+    inline bool canShipOccupy(const Point2d &pos) const
+    {
+        return (shipPoseMask[pos.x][pos.y] & POSE_LEGAL_ANY) != 0;
+    }
+    // 船体在原始地图（不含临时障碍物）上是否可以停留
+    inline bool staticShipPassable(const VectorPosition &vp) const
+    {
+        return inBounds(vp.pos) && (shipPoseMask[vp.pos.x][vp.pos.y] & (POSE_LEGAL << static_cast<int>(vp.direction)));
+    }
     // 计算泊位朝向
     Direction computeBerthOrientation(const Point2d &pos);
     // 获取当前帧地图的变化，即机器人的位置，将其视为障碍（除自己外），预测未来 n 帧是否有碰撞风险
@@ -196,20 +387,66 @@ public:
     int getDistanceToBerth(BerthID id, Point2d &position) const;
     // 计算一个点到所有泊位的距离，以降序输出，第一个是泊位 ID，第二个是距离，不包含不可达泊位
     std::vector<std::pair<int, int>> computePointToBerthsDistances(Point2d position) const;
+    // 依次访问上下左右四个可达的邻居，visit(next, cost)，不分配内存
+    // 部分格子上逆序访问，让等代价的路径交替转向，避免先走完一个方向再转弯
+    // 逆序的选择来自每个线程自己的随机数，寻路开始时由 seedNeighborOrder 按起点终点播种，多线程并行寻路时结果与串行一致
+    template <class Visitor>
+    inline void forEachNeighbor(const Point2d &pos, Visitor &&visit) const
+    {
+        NeighborList<Point2d, 4> found;
+        for (const Point2d &dir : DIRS)
+        {
+            Point2d next{pos.x + dir.x, pos.y + dir.y};
+            if (inBounds(next) && passable(next))
+                found.push_back(next);
+        }
+        if ((pos.x + pos.y) % static_cast<int>(nextNeighborOrder() % 3 + 1) == 0)
+        {
+            for (int i = found.count - 1; i >= 0; --i)
+                visit(found[i], 1);
+        }
+        else
+        {
+            for (int i = 0; i < found.count; ++i)
+                visit(found[i], 1);
+        }
+    }
+    // 为当前线程之后的 forEachNeighbor 设置随机数种子
+    static inline void seedNeighborOrder(uint32_t seed) { neighborOrderState = seed * 2654435761u | 1u; }
+    // 依次访问船舶可以到达的位姿：前进一格、逆时针旋转、顺时针旋转
+    template <class Visitor>
+    inline void forEachNeighbor(const VectorPosition &vp, Visitor &&visit) const
+    {
+        // 位姿是否合法直接查掩码，掩码合法时船体一定在地图内
+        const VectorPosition moves[3] = {SpatialUtils::moveForward(vp), SpatialUtils::anticlockwiseRotation(vp),
+                                         SpatialUtils::clockwiseRotation(vp)};
+        for (const VectorPosition &next : moves)
+            if (passable(next))
+                visit(next, cost(vp, next));
+    }
     // 返回当前节点上下左右的四个可达的邻居
-    std::vector<Point2d> neighbors(const Point2d &pos) const;
+    NeighborList<Point2d, 4> neighbors(const Point2d &pos) const;
     // 返回 vp 的邻居状态
-    std::vector<VectorPosition> neighbors(const VectorPosition &vp) const;
+    NeighborList<VectorPosition, 3> neighbors(const VectorPosition &vp) const;
     // 使用曼哈顿距离计算两个点之间的代价
     inline int cost(const Point2d &pos1, const Point2d &pos2) const
     {
         return Point2d::calculateManhattanDistance(pos1, pos2);
     }
-    // 使用曼哈顿距离计算两个 VectorPosition 之间的代价，包含了转向代价
-    int cost(const VectorPosition &e1, const VectorPosition &e2) const;
+    // 两个相邻 VectorPosition 之间的代价为 1，到达的船体每有一行接触主航道代价加 1
+    inline int cost(const VectorPosition &e1, const VectorPosition &e2) const
+    {
+        if (!inBounds(e2.pos))
+            return 1;
+        const uint16_t mask = shipPoseMask[e2.pos.x][e2.pos.y];
+        return 1 + ((mask >> (POSE_SEALANE_ROWS_SHIFT + 2 * static_cast<int>(e2.direction))) & 0x3);
+    }
     // 判断两个船空间是否重叠（冲突）
     bool hasOverlap(VectorPosition &a, VectorPosition &b);
-    
+
+private:
+    // 叠加一层临时障碍，item 为写入 grid 的障碍类型
+    void pushTemporaryObstacle(const Point2d &pos, MapItemSpace::MapItem item);
 };
 
 std::string printVector(const std::vector<Point2d> &path);
@@ -0,0 +1,274 @@
+#include "mapArtifacts.h"
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include "ship.h"
+#include "log.h"
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+    // 文件头，之后依次为陆地距离场、海洋距离场、航线记录、航线上的位姿
+    struct ArtifactHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t mapHash;
+        uint32_t rows, cols;
+        uint32_t landLayers, seaLayers;
+        uint32_t routeNum, routeCells;
+    };
+
+    // 位姿按 16 位存储，地图坐标不超过 200
+    struct PackedPose
+    {
+        int16_t x, y, direction;
+    };
+
+    struct RouteRecord
+    {
+        PackedPose start, destination;
+        int32_t cost;
+        uint32_t length;
+    };
+
+    constexpr char MAGIC[4] = {'S', 'P', 'M', 'A'};
+
+    inline PackedPose pack(const VectorPosition &vp)
+    {
+        return {static_cast<int16_t>(vp.pos.x), static_cast<int16_t>(vp.pos.y), static_cast<int16_t>(vp.direction)};
+    }
+    inline VectorPosition unpack(const PackedPose &p)
+    {
+        return VectorPosition(p.x, p.y, static_cast<Direction>(p.direction));
+    }
+
+    inline void fnv(uint64_t &hash, uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            hash ^= (value >> (i * 8)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    }
+
+    template <typename T>
+    inline void append(std::vector<char> &out, const T *data, size_t count)
+    {
+        const char *bytes = reinterpret_cast<const char *>(data);
+        out.insert(out.end(), bytes, bytes + sizeof(T) * count);
+    }
+
+    // 只读打开整个文件，POSIX 下用 mmap，其他平台读入缓冲区
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(const std::string &path)
+        {
+#ifndef _WIN32
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return;
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size > 0)
+            {
+                void *p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED)
+                {
+                    mapped = static_cast<const char *>(p);
+                    length = static_cast<size_t>(st.st_size);
+                }
+            }
+            close(fd);
+#else
+            std::ifstream file(path, std::ios::binary);
+            if (!file)
+                return;
+            buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            length = buffer.size();
+#endif
+        }
+        ~MappedFile()
+        {
+#ifndef _WIN32
+            if (mapped)
+                munmap(const_cast<char *>(mapped), length);
+#endif
+        }
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        inline const char *data() const
+        {
+#ifndef _WIN32
+            return mapped;
+#else
+            return buffer.data();
+#endif
+        }
+        inline size_t size() const { return length; }
+
+    private:
+#ifndef _WIN32
+        const char *mapped = nullptr;
+#else
+        std::vector<char> buffer;
+#endif
+        size_t length = 0;
+    };
+}
+
+uint64_t MapArtifactStore::mapHash(const Map &map, const std::vector<Berth> &berths)
+{
+    uint64_t hash = 14695981039346656037ull;
+    fnv(hash, VERSION);
+    fnv(hash, ALGORITHM_VERSION);
+    fnv(hash, (static_cast<uint64_t>(map.rows) << 32) | static_cast<uint32_t>(map.cols));
+    for (int i = 0; i < map.rows; ++i)
+        for (int j = 0; j < map.cols; ++j)
+            fnv(hash, static_cast<uint64_t>(map.readOnlyGrid[i][j]));
+    for (const Berth &berth : berths)
+    {
+        fnv(hash, static_cast<uint64_t>(berth.id));
+        fnv(hash, (static_cast<uint64_t>(berth.pos.x) << 32) | static_cast<uint32_t>(berth.pos.y));
+        fnv(hash, static_cast<uint64_t>(berth.orientation));
+    }
+    return hash;
+}
+
+std::string MapArtifactStore::path(uint64_t hash) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%016llx.bin", static_cast<unsigned long long>(hash));
+    return directory + name;
+}
+
+std::vector<char> MapArtifactStore::serialize(uint64_t hash, const Map &map)
+{
+    std::vector<RouteRecord> records;
+    std::vector<PackedPose> cells;
+    SeaRoute::forEachRoute([&](const VectorPosition &start, const VectorPosition &destination, const SeaRouteView &route)
+                           {
+                               records.push_back({pack(start), pack(destination), route.cost, static_cast<uint32_t>(route.size())});
+                               for (const VectorPosition &vp : route)
+                                   cells.push_back(pack(vp)); });
+
+    ArtifactHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.mapHash = hash;
+    header.rows = map.rows;
+    header.cols = map.cols;
+    header.landLayers = map.berthDistanceMap.layers();
+    header.seaLayers = map.maritimeBerthDistanceMap.layers();
+    header.routeNum = static_cast<uint32_t>(records.size());
+    header.routeCells = static_cast<uint32_t>(cells.size());
+
+    std::vector<char> out;
+    out.reserve(sizeof(header) + (map.berthDistanceMap.size() + map.maritimeBerthDistanceMap.size()) * sizeof(uint16_t) +
+                records.size() * sizeof(RouteRecord) + cells.size() * sizeof(PackedPose));
+    append(out, &header, 1);
+    append(out, map.berthDistanceMap.data(), map.berthDistanceMap.size());
+    append(out, map.maritimeBerthDistanceMap.data(), map.maritimeBerthDistanceMap.size());
+    append(out, records.data(), records.size());
+    append(out, cells.data(), cells.size());
+    return out;
+}
+
+bool MapArtifactStore::deserialize(uint64_t hash, const char *data, size_t size, Map &map)
+{
+    if (size < sizeof(ArtifactHeader))
+        return false;
+    ArtifactHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.mapHash != hash ||
+        header.rows != static_cast<uint32_t>(map.rows) || header.cols != static_cast<uint32_t>(map.cols))
+        return false;
+    const size_t layerCells = static_cast<size_t>(map.rows) * map.cols;
+    const size_t landBytes = header.landLayers * layerCells * sizeof(uint16_t);
+    const size_t seaBytes = header.seaLayers * layerCells * sizeof(uint16_t);
+    const size_t expected = sizeof(header) + landBytes + seaBytes + header.routeNum * sizeof(RouteRecord) +
+                            static_cast<size_t>(header.routeCells) * sizeof(PackedPose);
+    if (size != expected)
+        return false;
+
+    // 距离场为 uint16 数组，文件中的偏移都是 2 的倍数，映射的起始地址按页对齐
+    const char *p = data + sizeof(header);
+    map.berthDistanceMap.assign(header.landLayers, reinterpret_cast<const uint16_t *>(p));
+    p += landBytes;
+    map.maritimeBerthDistanceMap.assign(header.seaLayers, reinterpret_cast<const uint16_t *>(p));
+    p += seaBytes;
+    std::vector<RouteRecord> records(header.routeNum);
+    std::memcpy(records.data(), p, records.size() * sizeof(RouteRecord));
+    p += records.size() * sizeof(RouteRecord);
+    std::vector<PackedPose> cells(header.routeCells);
+    std::memcpy(cells.data(), p, cells.size() * sizeof(PackedPose));
+
+    std::vector<VectorPosition> route;
+    size_t offset = 0;
+    for (const RouteRecord &record : records)
+    {
+        if (offset + record.length > cells.size())
+            return false;
+        route.clear();
+        for (size_t i = 0; i < record.length; ++i)
+            route.push_back(unpack(cells[offset + i]));
+        offset += record.length;
+        SeaRoute::insertRoute(unpack(record.start), unpack(record.destination), route.data(), route.size(), record.cost);
+    }
+    return true;
+}
+
+bool MapArtifactStore::load(uint64_t hash, Map &map) const
+{
+    if (directory.empty())
+        return false;
+    MappedFile file(path(hash));
+    if (file.size() == 0)
+        return false;
+    if (!deserialize(hash, file.data(), file.size(), map))
+    {
+        // 航线记录可能已经插入了一部分，清空后由调用方完整计算
+        SeaRoute::clear();
+        LOGW("预计算快照不匹配: ", path(hash));
+        return false;
+    }
+    return true;
+}
+
+bool MapArtifactStore::writeFile(const std::vector<char> &bytes, const std::string &target)
+{
+    std::string temporary = target + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!file)
+            return false;
+    }
+    return std::rename(temporary.c_str(), target.c_str()) == 0;
+}
+
+bool MapArtifactStore::save(uint64_t hash, const Map &map) const
+{
+    return !directory.empty() && writeFile(serialize(hash, map), path(hash));
+}
+
+void MapArtifactStore::saveAsync(uint64_t hash, const Map &map) const
+{
+    if (directory.empty())
+        return;
+    // 进程可能在写完前退出，改名前的临时文件不会被读取
+    std::thread([bytes = serialize(hash, map), target = path(hash)]()
+                { writeFile(bytes, target); })
+        .detach();
+}
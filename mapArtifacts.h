@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "map.h"
+#include "berth.h"
+
+// 与参数无关的地图预计算结果的快照：陆地和海洋上到各泊位的距离场、所有预存航线
+// 文件名由地图和泊位计算的哈希决定，格式为文件头加连续的原始数组，加载时整块映射到内存后直接拷贝
+// 同一张地图重复运行时跳过 BFS 和航线搜索；找不到或不匹配时照常计算，算完后在后台线程写出快照
+// 单行路（毫秒级）和泊位聚类（依赖参数）不在快照中
+class MapArtifactStore
+{
+public:
+    static constexpr uint32_t VERSION = 1;
+    // 距离场或航线的计算方式变化（寻路算法、搜索顺序、代价）时必须加一，否则会读到旧算法算出的快照
+    static constexpr uint32_t ALGORITHM_VERSION = 2;
+
+    // directory 为空时不读写快照
+    explicit MapArtifactStore(std::string directory) : directory(std::move(directory)) {}
+
+    // 地图格子、泊位位置和朝向的哈希，带格式和算法版本号，任一变化后旧快照自动失效
+    static uint64_t mapHash(const Map &map, const std::vector<Berth> &berths);
+
+    // 读取与 hash 匹配的快照并恢复到 map 和 SeaRoute，成功返回 true
+    bool load(uint64_t hash, Map &map) const;
+    // 把 map 的距离场和 SeaRoute 的航线写入快照，先写临时文件再改名，不会留下不完整的快照
+    bool save(uint64_t hash, const Map &map) const;
+    // 在当前线程序列化，在后台线程写文件
+    void saveAsync(uint64_t hash, const Map &map) const;
+
+    std::string path(uint64_t hash) const;
+
+private:
+    // 序列化到内存，保存和后台写文件分开，写文件时游戏已经开始修改状态
+    static std::vector<char> serialize(uint64_t hash, const Map &map);
+    static bool deserialize(uint64_t hash, const char *data, size_t size, Map &map);
+    static bool writeFile(const std::vector<char> &bytes, const std::string &target);
+
+private:
+    std::string directory;
+};
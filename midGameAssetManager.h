@@ -10,11 +10,11 @@ private:
     // 计算投资回报率（ROI），帮助决策是否进行购买。
     float calculateROI(const Asset &asset, int quantity, int futureGoodsValue, int futureGoodsNum);
     // 预测未来产生的货物数量和价值
-    std::pair<int, int> predictFutureGoods(const std::vector<Goods> &goods, int currentTime);
+    std::pair<int, int> predictFutureGoods(const GoodsStore &goods, int currentTime);
     // 预测未来泊位堆积货物的情况
 public:
     std::vector<PurchaseDecision> makePurchaseDecision(const Map &gameMap,
-                                                       const std::vector<Goods> &goods,
+                                                       const GoodsStore &goods,
                                                        const std::vector<Robot> &robots,
                                                        const std::vector<Ship> &ships,
                                                        const std::vector<Berth> &berths,
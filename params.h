@@ -27,6 +27,22 @@ struct Params
     float robotReleaseBound = 0.8;          //低于平均泊位价值的比值时，释放机器人去其他泊位
     int DynamicSchedulingInterval = 200;    // 动态调度间隔
     bool FinalgameScheduling = false;        // 是否终局调度
+    bool BatchedRobotScheduling = false;    // 是否使用批量拍卖调度代替逐个贪心调度
+    int AuctionCandidateNum = 16;           // 拍卖时每个机器人保留的候选货物数
+    float AuctionEpsilon = 0.001;           // 拍卖每次出价的最小加价
+    float AuctionPriceDecay = 0.5;          // 货物价格每帧的衰减系数
+    int AuctionMaxBids = 2000;              // 每帧最多出价次数
+    bool CooperativePathfinding = false;    // 是否使用时空预约表协同寻路代替事后冲突处理
+    int ReservationHorizon = 16;            // 预约表的时间窗口帧数
+    int CooperativeExpansionLimit = 4000;   // 单个机器人时空搜索的最大扩展节点数
+    bool DistanceFieldFollowing = true;    // 前往泊位时是否沿泊位距离场下降生成路径代替 A*
+    bool RobotPathRepair = true;           // 重新寻路时是否先局部修复原路径
+    int RobotRepairWindow = 6;              // 局部修复检查的路径步数
+    bool ParallelRobotPathfinding = true;   // 多核时同一帧需要寻路的机器人是否分给线程池并行寻路
+    int ParallelPathfindingMinBatch = 4;    // 需要寻路的机器人不少于该数目时才并行
+    int RobotPathTimeoutLimit = 8;          // 机器人连续寻路超时这么多次后放弃目标
+    bool SpawnHeatmapPositioning = true;    // 没有货物可分配的机器人是否按货物生成热力图提前移动到预计会生成货物的区域
+    int SpawnHeatmapTileSize = 10;          // 热力图区域的边长（格）
     
     // 购买策略超参
     int maxRobotNum = 14;                   // 最多购买机器人数目
@@ -58,6 +74,21 @@ struct Params
     
     int SHIP_STILL_FRAMES_LIMIE = 5;    // 船阻塞帧数限制
 
+    // 分层寻路超参
+    bool HierarchicalPathfinding = true;    // 机器人远距离寻路是否先在簇的抽象图上寻路，再随着前进逐段细化
+    int HierarchicalClusterSize = 20;       // 簇的边长
+    int HierarchicalMinDistance = 40;       // 起终点曼哈顿距离不小于该值时才分层寻路
+    int HierarchicalLookahead = 30;         // 已细化路径保持的最少步数
+    bool ParallelFramePipeline = true;      // 多核时机器人与船舶的寻路和冲突处理是否在常驻线程上并行
+
+    // 帧内时间预算，单位微秒，从读到帧号开始计时
+    int FrameBudgetMicros = 13000;          // 整帧预算，留出输出指令的时间
+    int RobotScheduleBudgetMicros = 4000;   // 机器人调度
+    int RobotPathfindingBudgetMicros = 5000; // 机器人寻路，超时的 A* 返回部分路径
+    int RobotConflictBudgetMicros = 2000;   // 机器人冲突处理
+    int ShipConflictBudgetMicros = 2000;    // 船舶冲突处理
+    int DeferredWorkSlackMicros = 8000;     // 剩余时间不少于该值时才执行可推迟的工作（动态分区、统计输出）
+
     Params(MapFlag mapFalg)
     {
         if (mapFalg == MapFlag::MAP1)
@@ -114,6 +145,9 @@ public:
         return true;
     }
     
+    // 直接设置一个参数，与文件中的一行等价
+    void setParam(const std::string &key, const std::string &value) { params_[key] = value; }
+
     // 设置地图的超参数类
     void setParams(Params &param){
         auto setIntParam = [this](int& param, const std::string& key) {
@@ -144,10 +178,37 @@ public:
         setBoolParam(param.DynamicPartitionScheduling, "DynamicPartitionScheduling");
         setFloatParam(param.robotReleaseBound, "robotReleaseBound");
         setBoolParam(param.FinalgameScheduling, "FinalgameScheduling");
+        setBoolParam(param.BatchedRobotScheduling, "BatchedRobotScheduling");
+        setIntParam(param.AuctionCandidateNum, "AuctionCandidateNum");
+        setFloatParam(param.AuctionEpsilon, "AuctionEpsilon");
+        setFloatParam(param.AuctionPriceDecay, "AuctionPriceDecay");
+        setIntParam(param.AuctionMaxBids, "AuctionMaxBids");
+        setBoolParam(param.CooperativePathfinding, "CooperativePathfinding");
+        setIntParam(param.ReservationHorizon, "ReservationHorizon");
+        setIntParam(param.CooperativeExpansionLimit, "CooperativeExpansionLimit");
+        setBoolParam(param.DistanceFieldFollowing, "DistanceFieldFollowing");
+        setBoolParam(param.RobotPathRepair, "RobotPathRepair");
+        setIntParam(param.RobotRepairWindow, "RobotRepairWindow");
+        setBoolParam(param.ParallelRobotPathfinding, "ParallelRobotPathfinding");
+        setIntParam(param.ParallelPathfindingMinBatch, "ParallelPathfindingMinBatch");
+        setIntParam(param.RobotPathTimeoutLimit, "RobotPathTimeoutLimit");
+        setBoolParam(param.SpawnHeatmapPositioning, "SpawnHeatmapPositioning");
+        setIntParam(param.SpawnHeatmapTileSize, "SpawnHeatmapTileSize");
         setIntParam(param.SHIP_WAIT_TIME_LIMIT, "SHIP_WAIT_TIME_LIMIT");
         setIntParam(param.GOOD_DISTANCE_LIMIT, "GOOD_DISTANCE_LIMIT");
         setIntParam(param.EARLY_DELIVERT_FRAME_LIMIT, "EARLY_DELIVERT_FRAME_LIMIT");
         setIntParam(param.EARLY_DELIVERY_VALUE_LIMIT, "EARLY_DELIVERY_VALUE_LIMIT");
+        setBoolParam(param.HierarchicalPathfinding, "HierarchicalPathfinding");
+        setIntParam(param.HierarchicalClusterSize, "HierarchicalClusterSize");
+        setIntParam(param.HierarchicalMinDistance, "HierarchicalMinDistance");
+        setIntParam(param.HierarchicalLookahead, "HierarchicalLookahead");
+        setBoolParam(param.ParallelFramePipeline, "ParallelFramePipeline");
+        setIntParam(param.FrameBudgetMicros, "FrameBudgetMicros");
+        setIntParam(param.RobotScheduleBudgetMicros, "RobotScheduleBudgetMicros");
+        setIntParam(param.RobotPathfindingBudgetMicros, "RobotPathfindingBudgetMicros");
+        setIntParam(param.RobotConflictBudgetMicros, "RobotConflictBudgetMicros");
+        setIntParam(param.ShipConflictBudgetMicros, "ShipConflictBudgetMicros");
+        setIntParam(param.DeferredWorkSlackMicros, "DeferredWorkSlackMicros");
     }
 
     void logParams(const Params &param){
@@ -162,10 +223,27 @@ public:
         LOGI(param.DynamicPartitionScheduling, "DynamicPartitionScheduling");
         LOGI(param.robotReleaseBound, "robotReleaseBound");
         LOGI(param.FinalgameScheduling, "FinalgameScheduling");
+        LOGI(param.BatchedRobotScheduling, "BatchedRobotScheduling");
+        LOGI(param.AuctionCandidateNum, "AuctionCandidateNum");
+        LOGI(param.AuctionEpsilon, "AuctionEpsilon");
+        LOGI(param.AuctionPriceDecay, "AuctionPriceDecay");
+        LOGI(param.CooperativePathfinding, "CooperativePathfinding");
+        LOGI(param.DistanceFieldFollowing, "DistanceFieldFollowing");
+        LOGI(param.RobotPathRepair, "RobotPathRepair");
+        LOGI(param.ParallelRobotPathfinding, "ParallelRobotPathfinding");
+        LOGI(param.ParallelPathfindingMinBatch, "ParallelPathfindingMinBatch");
+        LOGI(param.RobotPathTimeoutLimit, "RobotPathTimeoutLimit");
+        LOGI(param.SpawnHeatmapPositioning, "SpawnHeatmapPositioning");
+        LOGI(param.SpawnHeatmapTileSize, "SpawnHeatmapTileSize");
+        LOGI(param.ReservationHorizon, "ReservationHorizon");
         LOGI(param.SHIP_WAIT_TIME_LIMIT, "SHIP_WAIT_TIME_LIMIT");
         LOGI(param.GOOD_DISTANCE_LIMIT, "GOOD_DISTANCE_LIMIT");
         LOGI(param.EARLY_DELIVERT_FRAME_LIMIT, "EARLY_DELIVERT_FRAME_LIMIT");
         LOGI(param.EARLY_DELIVERY_VALUE_LIMIT, "EARLY_DELIVERY_VALUE_LIMIT");
+        LOGI(param.HierarchicalPathfinding, "HierarchicalPathfinding");
+        LOGI(param.ParallelFramePipeline, "ParallelFramePipeline");
+        LOGI(param.FrameBudgetMicros, "FrameBudgetMicros");
+        LOGI(param.HierarchicalClusterSize, "HierarchicalClusterSize");
     }
 
     const std::unordered_map<std::string, std::string>& getParams() const {
@@ -91,17 +91,17 @@ void AStarPathfinder<Location, Graph>::aStarSearch(const Graph &graph,
 #ifdef DEBUG
         calTime += 4;
 #endif
-        for (const Location &next : graph.neighbors(current))
+        graph.forEachNeighbor(current, [&](const Location &next, int stepCost)
         {
             if (cost_so_far.find(next) != cost_so_far.end())
-                continue;
-            int new_cost = cost_so_far[current] + graph.cost(current, next);
+                return;
+            int new_cost = cost_so_far[current] + stepCost;
             // if (cost_so_far.find(next) == cost_so_far.end() || new_cost < cost_so_far[next])
             cost_so_far[next] = new_cost;
             int priority = new_cost + heuristic(next, goal);
             frontier.put(next, priority);
             came_from[next] = current;
-        }
+        });
     }
     // LOGI("A* 搜索节点个数：", calTime);
     // LOGI("优先队列长度：",frontier.elements.size());
@@ -129,6 +129,125 @@ Path<Location> AStarPathfinder<Location, Graph>::reconstruct_path(
     return path;
 }
 
+template <class Location, class Graph, class OpenList>
+GridSearchWorkspace &GridAStarPathfinder<Location, Graph, OpenList>::workspace()
+{
+    // 航线预计算会在多个线程中同时寻路，每个线程使用各自的缓冲区
+    static thread_local GridSearchWorkspace ws;
+    return ws;
+}
+
+template <class Location, class Graph, class OpenList>
+OpenList &GridAStarPathfinder<Location, Graph, OpenList>::openList()
+{
+    static thread_local OpenList frontier;
+    return frontier;
+}
+
+template <class Location, class Graph, class OpenList>
+std::variant<Path<Location>, PathfindingFailureReason>
+GridAStarPathfinder<Location, Graph, OpenList>::findPath(const Location &start,
+                                                         const Location &goal,
+                                                         const Graph &graph)
+{
+    if (!graph.inBounds(start) || !graph.inBounds(goal))
+        return PathfindingFailureReason::OUT_OF_BOUNDS;
+    if (!graph.passable(start))
+        return PathfindingFailureReason::START_POINT_INVALID;
+    if (!graph.passable(goal))
+        return PathfindingFailureReason::END_POINT_INVALID;
+    if (start == goal)
+        return PathfindingFailureReason::START_AND_END_POINT_SAME;
+
+    // 同样的起点终点在任何线程上都得到同样的路径
+    Graph::seedNeighborOrder(static_cast<uint32_t>(Indexer::toIndex(start, graph.cols)) * 40503u ^ static_cast<uint32_t>(Indexer::toIndex(goal, graph.cols)));
+    const size_t stateCount = static_cast<size_t>(graph.rows) * graph.cols * Indexer::layers;
+    GridSearchWorkspace &ws = workspace();
+    ws.prepare(stateCount);
+    OpenList &frontier = openList();
+    frontier.reset(stateCount);
+
+    const int endIndex = aStarSearch(graph, start, goal, ws, frontier);
+    if (endIndex == -1)
+        return PathfindingFailureReason::NO_PATH_EXISTS;
+    // 超时的部分路径只有明显靠近终点才值得走，否则走完还要从差不多的位置重新寻路
+    if (endIndex != Indexer::toIndex(goal, graph.cols) &&
+        heuristic(start, goal) - heuristic(Indexer::fromIndex(endIndex, graph.cols), goal) < MIN_PARTIAL_PROGRESS)
+        return PathfindingFailureReason::DEADLINE_EXCEEDED;
+
+    return reconstruct_path(graph, start, Indexer::fromIndex(endIndex, graph.cols), ws);
+}
+
+template <class Location, class Graph, class OpenList>
+int GridAStarPathfinder<Location, Graph, OpenList>::aStarSearch(const Graph &graph,
+                                                                const Location &start,
+                                                                const Location &goal,
+                                                                GridSearchWorkspace &ws,
+                                                                OpenList &frontier)
+{
+    const int cols = graph.cols;
+    const int startIndex = Indexer::toIndex(start, cols);
+    const int goalIndex = Indexer::toIndex(goal, cols);
+    const bool timed = deadline != std::chrono::steady_clock::time_point::max();
+    int expansions = 0;
+    int bestIndex = startIndex, bestHeuristic = heuristic(start, goal);
+
+    frontier.put(startIndex, 0);
+    ws.visit(startIndex, startIndex, 0);
+
+    while (!frontier.empty())
+    {
+        int currentIndex = frontier.get();
+        if (currentIndex == goalIndex)
+            return goalIndex;
+
+        Location current = Indexer::fromIndex(currentIndex, cols);
+        if (timed)
+        {
+            int h = heuristic(current, goal);
+            if (h < bestHeuristic)
+            {
+                bestHeuristic = h;
+                bestIndex = currentIndex;
+            }
+            if (++expansions % DEADLINE_CHECK_INTERVAL == 0 && std::chrono::steady_clock::now() >= deadline)
+                return bestIndex;
+        }
+        int currentCost = ws.costSoFar[currentIndex];
+        graph.forEachNeighbor(current, [&](const Location &next, int stepCost)
+        {
+            int nextIndex = Indexer::toIndex(next, cols);
+            // 与 AStarPathfinder 一致，首次访问即确定父节点，每个状态只入队一次
+            if (ws.visited(nextIndex))
+                return;
+            int new_cost = currentCost + stepCost;
+            ws.visit(nextIndex, currentIndex, new_cost);
+            frontier.put(nextIndex, new_cost + heuristic(next, goal));
+        });
+    }
+    return ws.visited(goalIndex) ? goalIndex : -1;
+}
+
+template <class Location, class Graph, class OpenList>
+Path<Location> GridAStarPathfinder<Location, Graph, OpenList>::reconstruct_path(const Graph &graph,
+                                                                                const Location &start,
+                                                                                const Location &goal,
+                                                                                const GridSearchWorkspace &ws)
+{
+    const int cols = graph.cols;
+    const int startIndex = Indexer::toIndex(start, cols);
+    Path<Location> path;
+    for (int index = Indexer::toIndex(goal, cols); index != startIndex; index = ws.cameFrom[index])
+    {
+        path.push_back(Indexer::fromIndex(index, cols));
+    }
+    return path;
+}
+
 // 显式实例化
 template class AStarPathfinder<VectorPosition, Map>;
-template class AStarPathfinder<Point2d, Map>;
\ No newline at end of file
+template class AStarPathfinder<Point2d, Map>;
+template class GridAStarPathfinder<VectorPosition, Map, IndexedDaryHeap<4>>;
+template class GridAStarPathfinder<Point2d, Map, IndexedDaryHeap<4>>;
+template class GridAStarPathfinder<VectorPosition, Map, BucketQueue>;
+template class GridAStarPathfinder<Point2d, Map, BucketQueue>;
\ No newline at end of file
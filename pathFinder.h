@@ -6,6 +6,8 @@
 #include <variant>
 #include <algorithm>
 #include <limits>
+#include <cstdint>
+#include <chrono>
 
 template <typename Location>
 using Path = std::vector<Location>;
@@ -18,6 +20,7 @@ enum class PathfindingFailureReason
     PATH_BLOCKED,             // 路径被阻挡
     NO_PATH_EXISTS,           // 不存在路径（被障碍物阻挡）
     OUT_OF_BOUNDS,            // 起点或终点超出搜索范围
+    DEADLINE_EXCEEDED,        // 达到截止时刻时还没有明显靠近终点
     OTHER                     // 其他原因
 };
 
@@ -62,3 +65,116 @@ public:
         return Point2d::calculateManhattanDistance(vp1.pos, vp2.pos);
     }
 };
+
+
+// 网格坐标与稠密数组下标之间的映射，Point2d 每格一个状态，VectorPosition 每格四个朝向
+template <class Location>
+struct GridIndexer;
+
+template <>
+struct GridIndexer<Point2d>
+{
+    static constexpr int layers = 1;
+    static inline int toIndex(const Point2d &pos, int cols) { return pos.x * cols + pos.y; }
+    static inline Point2d fromIndex(int index, int cols) { return Point2d(index / cols, index % cols); }
+};
+
+template <>
+struct GridIndexer<VectorPosition>
+{
+    static constexpr int layers = 4;
+    static inline int toIndex(const VectorPosition &vp, int cols)
+    {
+        return (vp.pos.x * cols + vp.pos.y) * layers + static_cast<int>(vp.direction);
+    }
+    static inline VectorPosition fromIndex(int index, int cols)
+    {
+        int cell = index / layers;
+        return VectorPosition(cell / cols, cell % cols, static_cast<Direction>(index % layers));
+    }
+};
+
+// 网格 A* 的搜索缓冲区，每个线程一份，通过 generation 标记失效，不需要每次清空
+struct GridSearchWorkspace
+{
+    std::vector<int> costSoFar;         // 到达每个状态的成本
+    std::vector<int> cameFrom;          // 每个状态的父节点下标
+    std::vector<uint32_t> visitedStamp; // 等于 generation 时表示本次搜索已访问
+    uint32_t generation = 0;
+
+    // 开始一次新的搜索，状态数变化时重新分配
+    void prepare(size_t stateCount)
+    {
+        if (visitedStamp.size() != stateCount)
+        {
+            costSoFar.assign(stateCount, 0);
+            cameFrom.assign(stateCount, -1);
+            visitedStamp.assign(stateCount, 0);
+            generation = 0;
+        }
+        if (++generation == 0)
+        {
+            // 计数回绕后旧标记可能与新 generation 相同，统一清零
+            std::fill(visitedStamp.begin(), visitedStamp.end(), 0);
+            generation = 1;
+        }
+    }
+
+    inline bool visited(int index) const { return visitedStamp[index] == generation; }
+
+    inline void visit(int index, int parent, int cost)
+    {
+        visitedStamp[index] = generation;
+        cameFrom[index] = parent;
+        costSoFar[index] = cost;
+    }
+};
+
+// 使用稠密数组代替 unordered_map 记录搜索状态的 A*，接口与 AStarPathfinder 一致
+// OpenList 为开放列表类型：IndexedDaryHeap 与原 PriorityQueue 出队顺序一致，BucketQueue 适合代价为小整数的搜索
+template <class Location, class Graph, class OpenList = IndexedDaryHeap<4>>
+class GridAStarPathfinder : public Pathfinder<Location, Graph>
+{
+public:
+    // Path 第一个元素是终点，逆序存储
+    virtual std::variant<Path<Location>, PathfindingFailureReason>
+    findPath(const Location &start,
+             const Location &goal,
+             const Graph &graph) override;
+
+    // 设置搜索截止时刻，超时后返回到已访问状态中离终点最近者的部分路径，靠近得不够时返回 DEADLINE_EXCEEDED
+    inline void setDeadline(std::chrono::steady_clock::time_point deadline) { this->deadline = deadline; }
+
+private:
+    using Indexer = GridIndexer<Location>;
+    static constexpr int DEADLINE_CHECK_INTERVAL = 128; // 每扩展若干个状态检查一次时间
+    static constexpr int MIN_PARTIAL_PROGRESS = 5;      // 超时的部分路径至少要比起点离终点近这么多格，否则按超时返回
+
+    // 当前线程的搜索缓冲区和开放列表
+    static GridSearchWorkspace &workspace();
+    static OpenList &openList();
+
+    // 返回路径末端的状态下标：找到时为终点，超时时为离终点最近的已访问状态，找不到时为 -1
+    int aStarSearch(const Graph &graph,
+                    const Location &start,
+                    const Location &goal,
+                    GridSearchWorkspace &ws,
+                    OpenList &frontier);
+
+    Path<Location> reconstruct_path(const Graph &graph,
+                                    const Location &start,
+                                    const Location &goal,
+                                    const GridSearchWorkspace &ws);
+
+    inline int heuristic(const Point2d &pos1, const Point2d &pos2)
+    {
+        return Point2d::calculateManhattanDistance(pos1, pos2);
+    }
+    inline int heuristic(const VectorPosition &vp1, const VectorPosition &vp2)
+    {
+        return Point2d::calculateManhattanDistance(vp1.pos, vp2.pos);
+    }
+
+private:
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+};
@@ -4,6 +4,8 @@
 #include <unordered_map>
 #include <vector>
 #include <queue>
+#include <cstdint>
+#include <algorithm>
 
 template <typename T, typename priority_t>
 struct PriorityQueue
@@ -28,3 +30,190 @@ struct PriorityQueue
         return best_item;
     }
 };
+
+// 以下开放列表的元素都是 [0, capacity) 内的稠密状态下标，优先级为非负整数
+// 接口一致：reset / empty / put / get，put 已在队列中的状态时只会降低其优先级（decrease-key）
+// 内部数组跨搜索复用，通过 generation 标记失效，reset 不需要清空
+
+// 带索引的 D 叉小顶堆，优先级相同时下标小的先出队，与 PriorityQueue<int, int> 的出队顺序一致
+template <int Arity = 4>
+class IndexedDaryHeap
+{
+public:
+    // 开始一次新的搜索，状态数变化时重新分配
+    void reset(size_t capacity)
+    {
+        if (stamp.size() != capacity)
+        {
+            stamp.assign(capacity, 0);
+            position.assign(capacity, -1);
+            priority.assign(capacity, 0);
+            generation = 0;
+        }
+        if (++generation == 0)
+        {
+            std::fill(stamp.begin(), stamp.end(), 0);
+            generation = 1;
+        }
+        heap.clear();
+    }
+
+    inline bool empty() const { return heap.empty(); }
+    inline size_t size() const { return heap.size(); }
+
+    inline void put(int item, int itemPriority)
+    {
+        if (stamp[item] != generation)
+        {
+            stamp[item] = generation;
+            priority[item] = itemPriority;
+            position[item] = static_cast<int>(heap.size());
+            heap.push_back(item);
+            siftUp(position[item]);
+        }
+        else if (position[item] >= 0 && itemPriority < priority[item])
+        {
+            priority[item] = itemPriority;
+            siftUp(position[item]);
+        }
+    }
+
+    inline int get()
+    {
+        int best = heap.front();
+        position[best] = -1; // 出队后 stamp 保留，本次搜索不会再入队
+        int last = heap.back();
+        heap.pop_back();
+        if (!heap.empty())
+        {
+            heap.front() = last;
+            position[last] = 0;
+            siftDown(0);
+        }
+        return best;
+    }
+
+private:
+    inline bool before(int a, int b) const
+    {
+        return priority[a] < priority[b] || (priority[a] == priority[b] && a < b);
+    }
+
+    void siftUp(int index)
+    {
+        int item = heap[index];
+        while (index > 0)
+        {
+            int parent = (index - 1) / Arity;
+            if (!before(item, heap[parent]))
+                break;
+            heap[index] = heap[parent];
+            position[heap[index]] = index;
+            index = parent;
+        }
+        heap[index] = item;
+        position[item] = index;
+    }
+
+    void siftDown(int index)
+    {
+        const int count = static_cast<int>(heap.size());
+        int item = heap[index];
+        while (true)
+        {
+            int first = index * Arity + 1;
+            if (first >= count)
+                break;
+            int best = first;
+            for (int child = first + 1; child < first + Arity && child < count; ++child)
+                if (before(heap[child], heap[best]))
+                    best = child;
+            if (!before(heap[best], item))
+                break;
+            heap[index] = heap[best];
+            position[heap[index]] = index;
+            index = best;
+        }
+        heap[index] = item;
+        position[item] = index;
+    }
+
+private:
+    std::vector<int> heap;
+    std::vector<int> position;   // 状态在 heap 中的位置，-1 表示已出队
+    std::vector<int> priority;
+    std::vector<uint32_t> stamp; // 等于 generation 时表示本次搜索入过队
+    uint32_t generation = 0;
+};
+
+// 桶队列：每个整数优先级一个桶，入队和出队均摊 O(1)，适合代价为小整数的网格 A*
+// 桶内后进先出；decrease-key 时旧记录留在桶里，出队时按优先级是否匹配丢弃
+class BucketQueue
+{
+public:
+    void reset(size_t capacity)
+    {
+        if (stamp.size() != capacity)
+        {
+            stamp.assign(capacity, 0);
+            priority.assign(capacity, 0);
+            generation = 0;
+        }
+        if (++generation == 0)
+        {
+            std::fill(stamp.begin(), stamp.end(), 0);
+            generation = 1;
+        }
+        for (int bucket = cursor; bucket <= maxBucket; ++bucket)
+            buckets[bucket].clear();
+        cursor = 0;
+        maxBucket = -1;
+        count = 0;
+    }
+
+    inline bool empty() const { return count == 0; }
+    inline size_t size() const { return count; }
+
+    inline void put(int item, int itemPriority)
+    {
+        if (stamp[item] == generation && (priority[item] < 0 || priority[item] <= itemPriority))
+            return;
+        if (stamp[item] != generation)
+            ++count;
+        stamp[item] = generation;
+        priority[item] = itemPriority;
+        if (itemPriority >= static_cast<int>(buckets.size()))
+            buckets.resize(std::max<size_t>(itemPriority + 1, buckets.size() * 2));
+        buckets[itemPriority].push_back(item);
+        maxBucket = std::max(maxBucket, itemPriority);
+        cursor = std::min(cursor, itemPriority); // 启发式不一致时优先级可能低于当前最小值
+    }
+
+    inline int get()
+    {
+        while (true)
+        {
+            std::vector<int> &bucket = buckets[cursor];
+            while (!bucket.empty())
+            {
+                int item = bucket.back();
+                bucket.pop_back();
+                if (priority[item] == cursor)
+                {
+                    priority[item] = -1; // 已出队
+                    --count;
+                    return item;
+                }
+            }
+            ++cursor;
+        }
+    }
+
+private:
+    std::vector<std::vector<int>> buckets;
+    std::vector<int> priority;   // 状态当前的优先级，-1 表示已出队
+    std::vector<uint32_t> stamp; // 等于 generation 时表示本次搜索入过队
+    uint32_t generation = 0;
+    int cursor = 0, maxBucket = -1;
+    size_t count = 0;
+};
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include "utils.h"
+#include "log.h"
+
+// 帧内各阶段，阶段之间可以嵌套，统计的都是阶段自身的总耗时
+enum class ProfileStage
+{
+    FRAME,             // 整帧，从读到帧号到输出 OK
+    PARSE,             // 读取帧数据（不含等待判题器）
+    GOODS_TTL,         // 货物生命周期维护
+    ROBOT_SCHEDULE,    // 机器人调度
+    ROBOT_PATHFINDING, // 机器人寻路
+    ROBOT_CONFLICT,    // 机器人冲突处理
+    LANE_LOCK,         // 单行路锁维护
+    SHIP_SCHEDULE,     // 船舶调度
+    SHIP_CONTROL,      // 船舶寻路和冲突处理
+    ASSET,             // 购买决策
+    OUTPUT,            // 指令输出
+    COUNT
+};
+
+inline const char *profileStageName(ProfileStage stage)
+{
+    static const char *names[] = {"frame", "parse", "goodsTTL", "robotSchedule", "robotPathfinding",
+                                  "robotConflict", "laneLock", "shipSchedule", "shipControl", "asset", "output"};
+    return names[static_cast<int>(stage)];
+}
+
+// 对数分桶直方图，单位微秒，小于 64 的值精确记录，之后每个 2 的幂区间分 32 个桶，相对误差不超过 3%
+class MicrosHistogram
+{
+public:
+    static constexpr int LINEAR = 64;
+    static constexpr int SUB_BUCKETS = 32;
+    static constexpr int BUCKETS = LINEAR + (32 - 6) * SUB_BUCKETS;
+
+    void add(uint32_t micros)
+    {
+        ++buckets[bucketOf(micros)];
+        ++count;
+        total += micros;
+        maxValue = std::max(maxValue, micros);
+    }
+
+    // 返回第 p 分位所在桶的下界
+    uint32_t percentile(double p) const
+    {
+        if (count == 0)
+            return 0;
+        uint64_t rank = static_cast<uint64_t>(p * (count - 1));
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; ++i)
+        {
+            seen += buckets[i];
+            if (seen > rank)
+                return lowerBound(i);
+        }
+        return maxValue;
+    }
+
+    inline uint64_t samples() const { return count; }
+    inline uint32_t max() const { return maxValue; }
+    inline double mean() const { return count ? static_cast<double>(total) / count : 0; }
+
+private:
+    static int bucketOf(uint32_t v)
+    {
+        if (v < LINEAR)
+            return v;
+        int exponent = 31 - __builtin_clz(v); // v >= 64 时 exponent >= 6
+        int sub = (v >> (exponent - 5)) & (SUB_BUCKETS - 1);
+        return LINEAR + (exponent - 6) * SUB_BUCKETS + sub;
+    }
+    static uint32_t lowerBound(int bucket)
+    {
+        if (bucket < LINEAR)
+            return bucket;
+        int exponent = (bucket - LINEAR) / SUB_BUCKETS + 6;
+        int sub = (bucket - LINEAR) % SUB_BUCKETS;
+        return (1u << exponent) | (static_cast<uint32_t>(sub) << (exponent - 5));
+    }
+
+private:
+    std::array<uint64_t, BUCKETS> buckets{};
+    uint64_t count = 0;
+    uint64_t total = 0;
+    uint32_t maxValue = 0;
+};
+
+// 一帧中各阶段的耗时，单位微秒
+struct ProfileFrameRecord
+{
+    int frame = -1;
+    std::array<uint32_t, static_cast<int>(ProfileStage::COUNT)> micros{};
+};
+
+// 帧级性能统计：当前帧各阶段耗时累加到原子计数器，帧结束时写入环形缓冲和直方图
+// 检测到跳帧时，把上一帧标记为导致跳帧的帧，结束时按阶段统计跳帧帧的耗时分布
+class FrameProfiler
+{
+public:
+    static constexpr int STAGES = static_cast<int>(ProfileStage::COUNT);
+    static constexpr int RING_SIZE = 256;        // 保留最近若干帧的明细
+    static constexpr int MAX_SKIP_RECORDS = 32;  // 报告中最多列出的跳帧帧数
+
+    static FrameProfiler &instance()
+    {
+        static FrameProfiler profiler;
+        return profiler;
+    }
+
+    // 读到帧号后调用，frame 与上一帧不连续时说明上一帧超时
+    void beginFrame(int frame)
+    {
+        if (lastFrame >= 0 && frame - lastFrame > 1)
+            onSkipped(frame - lastFrame - 1);
+        currentFrame = frame;
+        frameStart = std::chrono::steady_clock::now();
+        for (auto &stage : current)
+            stage.store(0, std::memory_order_relaxed);
+    }
+
+    // 输出 OK 之后调用
+    void endFrame()
+    {
+        if (currentFrame < 0)
+            return;
+        add(ProfileStage::FRAME, elapsedMicros(frameStart));
+        ProfileFrameRecord &record = ring[ringHead];
+        ringHead = (ringHead + 1) % RING_SIZE;
+        record.frame = currentFrame;
+        for (int i = 0; i < STAGES; ++i)
+        {
+            record.micros[i] = static_cast<uint32_t>(current[i].load(std::memory_order_relaxed));
+            histograms[i].add(record.micros[i]);
+        }
+        lastRecord = &record;
+        lastFrame = currentFrame;
+        currentFrame = -1;
+    }
+
+    // 累加阶段耗时，可以在工作线程中调用
+    inline void add(ProfileStage stage, uint64_t micros)
+    {
+        current[static_cast<int>(stage)].fetch_add(micros, std::memory_order_relaxed);
+    }
+
+    static inline uint64_t elapsedMicros(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // 生成报告：每个阶段的 p50/p99/max/mean，以及跳帧帧中耗时最长的阶段
+    std::string report() const
+    {
+        std::ostringstream oss;
+        oss << "帧性能统计（us）\n";
+        oss << std::left << std::setw(18) << "stage" << std::right << std::setw(10) << "p50" << std::setw(10) << "p99"
+            << std::setw(10) << "max" << std::setw(10) << "mean" << std::setw(12) << "skipMean" << "\n";
+        for (int i = 0; i < STAGES; ++i)
+        {
+            const MicrosHistogram &h = histograms[i];
+            oss << std::left << std::setw(18) << profileStageName(static_cast<ProfileStage>(i)) << std::right
+                << std::setw(10) << h.percentile(0.5) << std::setw(10) << h.percentile(0.99)
+                << std::setw(10) << h.max() << std::setw(10) << static_cast<uint64_t>(h.mean())
+                << std::setw(12) << (skippedFrames ? skipStageTotal[i] / skippedFrames : 0) << "\n";
+        }
+        oss << "跳帧次数: " << skippedFrames << ", 跳过帧数: " << droppedFrames << "\n";
+        for (int i = 1; i < STAGES; ++i)
+            if (dominantCount[i])
+                oss << "  主要耗时阶段 " << profileStageName(static_cast<ProfileStage>(i)) << ": " << dominantCount[i] << " 次\n";
+        for (int i = 0; i < skipRecordNum; ++i)
+        {
+            const auto &[record, dropped] = skipRecords[i];
+            oss << "  帧 " << record.frame << " 跳过 " << dropped << " 帧:";
+            for (int s = 0; s < STAGES; ++s)
+                if (record.micros[s])
+                    oss << " " << profileStageName(static_cast<ProfileStage>(s)) << "=" << record.micros[s];
+            oss << "\n";
+        }
+        return oss.str();
+    }
+
+    // 最近 RING_SIZE 帧的明细，按时间顺序访问
+    template <typename Visitor>
+    void forEachRecentFrame(Visitor visit) const
+    {
+        for (int i = 0; i < RING_SIZE; ++i)
+        {
+            const ProfileFrameRecord &record = ring[(ringHead + i) % RING_SIZE];
+            if (record.frame >= 0)
+                visit(record);
+        }
+    }
+
+private:
+    FrameProfiler() = default;
+
+    void onSkipped(int dropped)
+    {
+        ++skippedFrames;
+        droppedFrames += dropped;
+        if (lastRecord == nullptr)
+            return;
+        int dominant = 1;
+        for (int i = 1; i < STAGES; ++i)
+        {
+            skipStageTotal[i] += lastRecord->micros[i];
+            if (lastRecord->micros[i] > lastRecord->micros[dominant])
+                dominant = i;
+        }
+        skipStageTotal[0] += lastRecord->micros[0];
+        ++dominantCount[dominant];
+        if (skipRecordNum < MAX_SKIP_RECORDS)
+            skipRecords[skipRecordNum++] = {*lastRecord, dropped};
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, STAGES> current{};
+    std::array<MicrosHistogram, STAGES> histograms;
+    std::array<ProfileFrameRecord, RING_SIZE> ring;
+    int ringHead = 0;
+    const ProfileFrameRecord *lastRecord = nullptr;
+    int currentFrame = -1, lastFrame = -1;
+    std::chrono::steady_clock::time_point frameStart;
+
+    int skippedFrames = 0, droppedFrames = 0;
+    std::array<uint64_t, STAGES> skipStageTotal{};
+    std::array<int, STAGES> dominantCount{};
+    std::array<std::pair<ProfileFrameRecord, int>, MAX_SKIP_RECORDS> skipRecords;
+    int skipRecordNum = 0;
+};
+
+// 作用域计时器，析构时把耗时累加到对应阶段
+class ScopedStageTimer
+{
+public:
+    explicit ScopedStageTimer(ProfileStage stage) : stage(stage), start(std::chrono::steady_clock::now()) {}
+    ~ScopedStageTimer() { FrameProfiler::instance().add(stage, FrameProfiler::elapsedMicros(start)); }
+    ScopedStageTimer(const ScopedStageTimer &) = delete;
+    ScopedStageTimer &operator=(const ScopedStageTimer &) = delete;
+
+private:
+    ProfileStage stage;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef DEBUG
+#define PROFILE_SCOPE(stage) ScopedStageTimer PROFILE_CONCAT(profileTimer, __LINE__)(ProfileStage::stage)
+#define PROFILE_BEGIN_FRAME(frame) FrameProfiler::instance().beginFrame(frame)
+#define PROFILE_END_FRAME() FrameProfiler::instance().endFrame()
+#else
+#define PROFILE_SCOPE(stage) \
+    do                       \
+    {                        \
+    } while (0)
+#define PROFILE_BEGIN_FRAME(frame) \
+    do                             \
+    {                              \
+    } while (0)
+#define PROFILE_END_FRAME() \
+    do                      \
+    {                       \
+    } while (0)
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+// 时空预约表：记录未来 horizon 帧内每个格子被哪个机器人占用，t = 0 为当前帧
+// 每帧重建，只清理上一帧写过的位置
+class ReservationTable
+{
+public:
+    static constexpr int FREE = -1;
+
+    // 开始新的一帧，尺寸变化时重新分配
+    void reset(int rows, int cols, int horizon)
+    {
+        int newCells = rows * cols;
+        if (newCells != cells || horizon != steps)
+        {
+            cells = newCells;
+            steps = horizon;
+            owners.assign(static_cast<size_t>(cells) * (steps + 1), FREE);
+            touched.clear();
+            return;
+        }
+        for (int index : touched)
+            owners[index] = FREE;
+        touched.clear();
+    }
+
+    inline int horizon() const { return steps; }
+
+    inline int owner(int cell, int t) const { return owners[t * cells + cell]; }
+
+    inline void reserve(int cell, int t, int robotId)
+    {
+        int index = t * cells + cell;
+        if (owners[index] == FREE)
+            touched.push_back(index);
+        owners[index] = static_cast<int16_t>(robotId);
+    }
+
+    // 在 [from, horizon] 帧内一直占用 cell
+    inline void reserveFrom(int cell, int from, int robotId)
+    {
+        for (int t = from; t <= steps; ++t)
+            reserve(cell, t, robotId);
+    }
+
+    // 机器人在 t - 1 帧位于 from，t 帧移动到 to，是否与其他机器人的预约冲突（同格或对穿）
+    // shareCell 为真时允许与其他机器人同格，shareEdge 为真时允许对穿，用于主干道等不会碰撞的格子
+    inline bool canMove(int from, int to, int t, int robotId, bool shareCell = false, bool shareEdge = false) const
+    {
+        int o = owner(to, t);
+        if (o != FREE && o != robotId && !shareCell)
+            return false;
+        if (from != to && !shareEdge)
+        {
+            int a = owner(to, t - 1), b = owner(from, t);
+            if (a != FREE && a != robotId && a == b)
+                return false;
+        }
+        return true;
+    }
+
+private:
+    int cells = 0, steps = 0;
+    std::vector<int16_t> owners;
+    std::vector<int> touched;
+};
@@ -5,6 +5,7 @@
 #include "map.h"
 #include "utils.h"
 #include "pathFinder.h"
+#include "hierarchicalPathfinder.h"
 #include "assert.h"
 #include "log.h"
 
@@ -37,11 +38,14 @@ public:
     // BerthID assignedBerthID; // 机器人被分配的泊位 ID
 public:
     Point2d nextPos;           // 机器人下一帧前往的位置
+    // 以上为每帧都要读写的状态，放在对象开头；以下的路径和寻路器只在移动和寻路时访问
     std::vector<Point2d> path; // 机器人运行路径
     int avoidNum = 0;          //  避让的次数
+    int pathTimeouts = 0;      // 连续超时的寻路次数，得到完整路径时清零
+    HierarchicalRoute<Point2d> route; // 分层寻路时尚未细化的路标
 private:
     // DStarPathfinder pathFinder; // 每个机器人都要存储寻路状态
-    AStarPathfinder<Point2d, Map> pathFinder;
+    GridAStarPathfinder<Point2d, Map> pathFinder;
 
 public:
     Robot(int id, Point2d pos, int type_)
@@ -56,14 +60,6 @@ public:
     {
     }
 
-    //  购买机器人
-    static std::string lbot(const Point2d &pos, const int type)
-    {
-        using namespace std::string_literals;
-        // LOGI("lbot "s + std::to_string(pos.x) + " "s + std::to_string(pos.y) + " "s + std::to_string(type));
-        return "lbot "s + std::to_string(pos.x) + " "s + std::to_string(pos.y) + " "s + std::to_string(type);
-    }
-
     void assignGoodOrBerth()
     {
         targetid = -1;
@@ -73,6 +69,7 @@ public:
     {
         targetid = Id;
         destination = dest;
+        pathTimeouts = 0;
     }
 
     void updatePath()
@@ -108,59 +105,59 @@ public:
         nextPos = tempPos;
     }
 
-    std::string move(int direction)
-    {
-        // 向特定方向移动
-        using namespace std::string_literals;
-#ifdef DEBUG
-        assert(direction >= 0 && direction <= 3);
-#endif
-        return "move "s + std::to_string(id) + " "s + std::to_string(direction);
-    }
-
-    std::string move(const Point2d &nextPos)
+    // 移动到相邻位置 nextPos 的方向，原地不动返回 -1
+    int moveDirection(const Point2d &nextPos) const
     {
-        std::string instruction;
         if (nextPos.x > pos.x)
-            instruction = move(3); // 向下
+            return 3; // 向下
         else if (nextPos.x < pos.x)
-            instruction = move(2); // 向上
+            return 2; // 向上
         else if (nextPos.y > pos.y)
-            instruction = move(0); // 向右
+            return 0; // 向右
         else if (nextPos.y < pos.y)
-            instruction = move(1); // 向左
-        return instruction;
+            return 1; // 向左
+        return -1;
     }
 
-    std::string movetoNextPosition()
+    // 移动到 nextPos 的方向，不需要移动或 nextPos 不相邻时返回 -1
+    int nextMoveDirection() const
     {
         if (nextPos != Point2d(-1, -1) && Point2d::calculateManhattanDistance(nextPos, pos) <= 1)
-            return move(nextPos);
+            return moveDirection(nextPos);
         LOGW("robot ", id, " from: ", pos, " to ", nextPos);
-        return "";
-    }
-
-    std::string get()
-    {
-        // 生成取货指令
-        using namespace std::string_literals;
-        return "get "s + std::to_string(id);
-    }
-
-    std::string pull()
-    {
-        // 生成放置指令
-        using namespace std::string_literals;
-        return "pull "s + std::to_string(id);
+        return -1;
     }
 
     bool findPath(const Map &map, Point2d dst)
     {
         destination = dst;
+        route.clear();
+        // 远距离先在抽象图上寻路，只细化前面几段
+        const HierarchicalGraph<Point2d> &hierarchy = HierarchicalGraph<Point2d>::getInstance();
+        if (hierarchy.accepts(pos, destination))
+        {
+            Path<Point2d> refined;
+            if (hierarchy.findRoute(map, pos, destination, route) && hierarchy.extendPath(map, pos, route, refined))
+            {
+                this->path = std::move(refined);
+                pathTimeouts = 0;
+                return true;
+            }
+            route.clear();
+        }
         std::variant<Path<Point2d>, PathfindingFailureReason> path = pathFinder.findPath(pos, destination, map);
         if (std::holds_alternative<Path<Point2d>>(path))
         {
+            // 超时时是朝向终点的部分路径，走完后重新寻路
             this->path = std::get<Path<Point2d>>(path);
+            pathTimeouts = this->path.front() == destination ? 0 : pathTimeouts + 1;
+            return true;
+        }
+        else if (std::get<PathfindingFailureReason>(path) == PathfindingFailureReason::DEADLINE_EXCEEDED)
+        {
+            // 本帧没有时间寻路，保留目标原地等一帧，连续超时由控制器放弃目标
+            this->path = Path<Point2d>{pos};
+            ++pathTimeouts;
             return true;
         }
         else
@@ -201,6 +198,97 @@ public:
         return findPath(map, destination);
     }
 
+    // 设置本帧寻路的截止时刻
+    inline void setSearchDeadline(std::chrono::steady_clock::time_point deadline) { pathFinder.setDeadline(deadline); }
+
+    // 分层寻路时把路径向前细化，路标失效或细化失败时重新完整寻路
+    void extendPath(const Map &map)
+    {
+        if (route.empty())
+            return;
+        if (path.empty())
+        {
+            route.clear();
+            return;
+        }
+        if (!HierarchicalGraph<Point2d>::getInstance().extendPath(map, pos, route, path))
+        {
+            route.clear();
+            findPath(map);
+        }
+    }
+
+    // 剩余路径长度，包含尚未细化部分的估计
+    inline size_t remainingPathLength() const
+    {
+        return path.size() + (route.empty() ? 0 : route.pendingCost);
+    }
+
+    // 沿泊位距离场下降生成到泊位的最短路径，每一步只比较四个邻居，不需要搜索
+    // 终点为该泊位最近的格子；当前地图上无法继续下降（被临时障碍物挡住）时返回 false
+    // 成功时 destination 由调度器给的 berth.pos 改为这个格子：泊位的任一格子都能卸货，
+    // 而冲突处理用 destination 判断机器人是否停在终点，必须与路径终点一致；targetid 不变
+    bool followDistanceField(const Map &map, int berthId)
+    {
+        if (!map.berthDistanceMap.contains(berthId))
+            return false;
+        int distance = map.berthDistanceMap.get(berthId, pos);
+        if (distance == INT_MAX || distance == 0)
+            return false;
+        Path<Point2d> descent;
+        descent.reserve(distance);
+        Point2d current = pos;
+        while (distance > 0)
+        {
+            bool moved = false;
+            for (const Point2d &dir : Map::DIRS)
+            {
+                Point2d next = current + dir;
+                if (map.inBounds(next) && map.berthDistanceMap.get(berthId, next) == distance - 1 && map.passable(next))
+                {
+                    current = next;
+                    moved = true;
+                    break;
+                }
+            }
+            if (!moved)
+                return false;
+            descent.push_back(current);
+            --distance;
+        }
+        std::reverse(descent.begin(), descent.end());
+        path = std::move(descent);
+        destination = current;
+        route.clear();
+        return true;
+    }
+
+    // 局部修复：路径前 window 步内有格子被临时障碍物占据时，只重新规划到被挡格子之后第一个路径点的一段，
+    // 其余部分沿用原路径；窗口内没有被挡的格子或绕行失败时返回 false
+    bool repairPath(const Map &map, int window)
+    {
+        if (path.empty())
+            return false;
+        const int size = static_cast<int>(path.size());
+        int blocked = -1;
+        for (int i = size - 1; i >= std::max(0, size - window); --i)
+            if (!map.passable(path[i]))
+                blocked = i;
+        if (blocked <= 0 || !map.passable(path[blocked - 1]))
+            return false;
+        const int rejoin = blocked - 1;
+        std::variant<Path<Point2d>, PathfindingFailureReason> detour = pathFinder.findPath(pos, path[rejoin], map);
+        if (!std::holds_alternative<Path<Point2d>>(detour))
+            return false;
+        const Path<Point2d> &detourPath = std::get<Path<Point2d>>(detour);
+        // 超时返回的部分路径接不上原路径
+        if (detourPath.front() != path[rejoin])
+            return false;
+        path.erase(path.begin() + rejoin, path.end());
+        path.insert(path.end(), detourPath.begin(), detourPath.end());
+        return true;
+    }
+
     bool refindPath(const Map &map)
     {
         std::vector<Point2d> potentialObstacle = map.getNearbyTemporaryObstacles(pos, 2);
@@ -218,8 +306,8 @@ public:
     {
         if (carryingItem != rhs.carryingItem)
             return carryingItem < rhs.carryingItem;
-        else if (path.size() != rhs.path.size())
-            return path.size() < rhs.path.size();
+        else if (remainingPathLength() != rhs.remainingPathLength())
+            return remainingPathLength() < rhs.remainingPathLength();
         else
             return id < rhs.id;
     }
@@ -1,35 +1,65 @@
 #include "robotController.h"
 #include <utility>
-#include <chrono>
+#include <cstdlib>
+#include <atomic>
+#include <thread>
+#include "profiler.h"
+#include "frameDeadline.h"
+void RobotController::setParameter(const Params &params)
+{
+    CooperativePathfinding = params.CooperativePathfinding;
+    ReservationHorizon = std::max(1, params.ReservationHorizon);
+    CooperativeExpansionLimit = params.CooperativeExpansionLimit;
+    DistanceFieldFollowing = params.DistanceFieldFollowing;
+    RobotPathRepair = params.RobotPathRepair;
+    RobotRepairWindow = std::max(1, params.RobotRepairWindow);
+    ParallelPathfindingMinBatch = std::max(2, params.ParallelPathfindingMinBatch);
+    RobotPathTimeoutLimit = std::max(1, params.RobotPathTimeoutLimit);
+    if (params.ParallelRobotPathfinding && std::thread::hardware_concurrency() > 1)
+        pathfindingPool = std::make_unique<ThreadPool>();
+}
+
 void RobotController::runController(Map &map, const SingleLaneManager &singleLaneManager)
 {
-    auto start = std::chrono::steady_clock::now();
+    // 本帧寻路的截止时刻，超时的搜索返回部分路径
+    setSearchDeadline(FrameDeadline::instance().startStage(DeadlineStage::ROBOT_PATHFINDING));
+    // 分层寻路的机器人在规划前把路径细化到足够的步数
+    for (Robot &robot : robots)
+        if (robot.status != DEATH)
+            robot.extendPath(map);
+
+    if (CooperativePathfinding)
+    {
+        runCooperativeController(map, singleLaneManager);
+        return;
+    }
+
     // 为所有需要寻路算法的机器人调用寻路算法，给定新目标位置
-    for (Robot &robot : robots){
-        if (robot.status==DEATH) continue;
-        if (needPathfinding(robot)){
-            // LOGI("機器人",robot.id,"需要尋路");
-            runPathfinding(map, robot);
-            // LOGI(robot);
-        }
+    {
+        PROFILE_SCOPE(ROBOT_PATHFINDING);
+        runPathfindingBatch(map);
     }
-    auto end = std::chrono::steady_clock::now();
-    int countTime = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-    if(countTime > 10)
-        LOGI("robotController 尋路时间: ",countTime," ms");
 
     // 更新所有机器人下一步位置
     for (Robot &robot : robots)
         robot.updateNextPos();
 
-    start = std::chrono::steady_clock::now();
+    PROFILE_SCOPE(ROBOT_CONFLICT);
+    // 冲突处理中的重新寻路使用冲突处理阶段的截止时刻，超时后不再进行下一轮
+    FrameDeadline &deadline = FrameDeadline::instance();
+    setSearchDeadline(deadline.startStage(DeadlineStage::ROBOT_CONFLICT));
     int tryTime = 0;
+    // 下一帧位置作为临时障碍只加入一次，之后由 rePlanRobotMove 按动作增量更新
+    updateTemporaryObstacles(map);
     // 尝试次数大于 0 就出错
     for(; tryTime <= 2; ++tryTime){
+        if (tryTime > 0 && deadline.expired(DeadlineStage::ROBOT_CONFLICT)) {
+            LOGW("机器人冲突处理超时，第 ", tryTime, " 轮后停止");
+            break;
+        }
         reset();
-        updateTemporaryObstacles(map);
         // 考虑下一步机器人的行动是否会冲突
-        std::set<CollisionEvent, CollisionEventCompare> collisions = detectNextFrameConflict(map, singleLaneManager);
+        FrameVector<CollisionEvent> collisions = detectNextFrameConflict(map, singleLaneManager);
         if(collisions.empty())
             break;
         LOGI("发现冲突");
@@ -44,27 +74,23 @@ void RobotController::runController(Map &map, const SingleLaneManager &singleLan
 
         // 权衡机器人的规划，设置设定合理的指令
         rePlanRobotMove(map);
-
-        map.clearTemporaryObstacles();
         // 直至解决冲突
     }
 
     // for(const auto &robot : robots)
     //     LOGI(robot);
-    end = std::chrono::steady_clock::now();
-    countTime = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-    if(countTime > 10)
-        LOGI("robotController 冲突处理时间: ",countTime," ms, i: ", tryTime);
+    if(tryTime > 2)
+        LOGI("robotController 冲突处理未完全解决");
 
     // 返回给 gameManager 以输出所有机器人的行动指令
 }
 
 void RobotController::rePlanRobotMove(Map &map)
 {
-    std::vector<std::pair<int, ResolutionAction>> refindPathActions; // 存储需要重新寻路的动作及其机器人ID
+    FrameVector<std::pair<int, ResolutionAction>> refindPathActions(FrameArena::resource()); // 存储需要重新寻路的动作及其机器人ID
     // 排序
     for (auto& [key, value] : robotResolutionActions) {
-        std::vector<ResolutionAction>& actions = value;
+        auto &actions = value;
         std::sort(actions.begin(), actions.end(), [](const ResolutionAction& a, const ResolutionAction& b) {
             return a.method > b.method; // 直接根据枚举值的整数比较进行排序
         });
@@ -117,70 +143,121 @@ void RobotController::rePlanRobotMove(Map &map)
     for (auto& pair : refindPathActions) {
         Robot &robot = robots.at(pair.first);
         map.removeTemporaryObstacle(robot.nextPos);
-        runPathfinding(map, robot);
+        // 只有冲突中重新寻路的机器人还留着原路径，先尝试局部修复；批量寻路的机器人路径为空，不走这里
+        if (!(RobotPathRepair && robot.repairPath(map, RobotRepairWindow)))
+            runPathfinding(map, robot);
         robot.updateNextPos();
         map.addTemporaryObstacle(robot.nextPos);
 
     }
 }
 
-std::set<RobotController::CollisionEvent, RobotController::CollisionEventCompare>
+FrameVector<RobotController::CollisionEvent>
 RobotController::detectNextFrameConflict(const Map &map, const SingleLaneManager &singleLaneManager)
 {
-    std::set<CollisionEvent, CollisionEventCompare> collision; // 使用 set 保证输出的机器人对不重复
-    for(size_t i = 0; i < robots.size(); ++i){
-        const Robot& robot1 = robots[i];
-        int currentSingleLaneID1 = singleLaneManager.getSingleLaneId(robot1.pos);
-        int nextFrameSingleLaneID1 = singleLaneManager.getSingleLaneId(robot1.nextPos);
-
-        for(size_t j = i + 1; j < robots.size(); ++j){
-            const Robot& robot2 = robots[j];
-            int currentSingleLaneID2 = singleLaneManager.getSingleLaneId(robot2.pos);
-            int nextFrameSingleLaneID2 = singleLaneManager.getSingleLaneId(robot2.nextPos);
-            // 检测下一帧是否同时在主干道上，如果是，则不会发生碰撞
-            if(map.isInMainRoad(robot1.nextPos) && map.isInMainRoad(robot2.nextPos)){
-                continue;
-            }
-            // 检查下一帧前往位置是否相同，移动机器人撞上静止机器人也在这种情况内
-            else if(robot1.nextPos == robot2.nextPos){
-                CollisionEvent event(robot1.id, robot2.id, CollisionEvent::TargetOverlap);
-                collision.insert(event);
-            }
-            // 检查是否互相前往对方当前所在地
-            else if(robot1.nextPos == robot2.pos && robot1.pos == robot2.nextPos){
-                CollisionEvent event(robot1.id, robot2.id, CollisionEvent::SwapPositions);
-                collision.insert(event);
-            }
-            // 检查机器人下一帧是否尝试进入加锁的单行道
-            else if(nextFrameSingleLaneID1 >=1 && 
-                    currentSingleLaneID1 == 0 && 
-                    singleLaneManager.isLocked(nextFrameSingleLaneID1, robot1.nextPos)){
-                // const SingleLaneLock& lock = singleLaneManager.getLock(nextFrameSingleLaneID);
-                CollisionEvent event(robot1.id, CollisionEvent::EntryAttemptWhileOccupied);
-                collision.insert(event);
-            }
-            // 检查机器人下一帧是否尝试同时相向进入单行道，同时从同一位置进入单行道已经被 TargetOverlap 排除
-            else if(nextFrameSingleLaneID1 >=1 &&
-                    currentSingleLaneID1 == 0 &&
-                    currentSingleLaneID2 == 0 &&
-                    nextFrameSingleLaneID1 == nextFrameSingleLaneID2 &&
-                    singleLaneManager.isEnteringSingleLane(nextFrameSingleLaneID1, robot1.nextPos) &&
-                    singleLaneManager.isEnteringSingleLane(nextFrameSingleLaneID2, robot2.nextPos)){
-                CollisionEvent event(robot1.id, robot2.id, CollisionEvent::HeadOnAttempt);
-                collision.insert(event);
-            }
+    // 按 nextPos 和 pos 所在格子给机器人分桶，只检查同一格子里的机器人，总开销与机器人数成正比
+    const int robotNum = robots.size();
+    const int cellNum = map.rows * map.cols;
+    if (nextPosHead.size() != cellNum)
+    {
+        nextPosHead.assign(cellNum, -1);
+        posOwner.assign(cellNum, -1);
+    }
+    nextPosLink.assign(robotNum, -1);
+    currentCell.resize(robotNum);
+    nextCell.resize(robotNum);
+    currentLane.resize(robotNum);
+    nextLane.resize(robotNum);
+    nextInMainRoad.resize(robotNum);
+    lockedEntry.resize(robotNum);
+    touchedCells.clear();
+
+    auto cellOf = [&map](const Point2d &pos)
+    {
+        return (pos.x >= 0 && pos.x < map.rows && pos.y >= 0 && pos.y < map.cols) ? pos.x * map.cols + pos.y : -1;
+    };
+
+    // 只在这一遍读取分散的 Robot 对象，后面的判断只用下标连续存放的格子编号和标记
+    FrameVector<CollisionEvent> collision(FrameArena::resource());
+    for (int i = 0; i < robotNum; ++i)
+    {
+        const Robot &robot = robots[i];
+        currentCell[i] = cellOf(robot.pos);
+        nextCell[i] = cellOf(robot.nextPos);
+        currentLane[i] = singleLaneManager.getSingleLaneId(robot.pos);
+        nextLane[i] = singleLaneManager.getSingleLaneId(robot.nextPos);
+        nextInMainRoad[i] = map.isInMainRoad(robot.nextPos);
+        // 检查机器人下一帧是否尝试进入加锁的单行道
+        lockedEntry[i] = nextLane[i] >= 1 && currentLane[i] == 0 && singleLaneManager.isLocked(nextLane[i], robot.nextPos);
+        if (lockedEntry[i])
+            collision.emplace_back(robot.id, CollisionEvent::EntryAttemptWhileOccupied);
+
+        const int next = nextCell[i], cell = currentCell[i];
+        if (next != -1)
+        {
+            // 头插法，nextPosLink[i] 指向同一格子中编号更小的机器人，每对只枚举一次
+            nextPosLink[i] = nextPosHead[next];
+            nextPosHead[next] = i;
+            touchedCells.push_back(next);
+        }
+        if (cell != -1)
+        {
+            posOwner[cell] = i;
+            touchedCells.push_back(cell);
+        }
+    }
+
+    // 下一帧同时在主干道上不会发生碰撞
+    auto bothInMainRoad = [this](int a, int b)
+    { return nextInMainRoad[a] && nextInMainRoad[b]; };
+
+    for (int i = 0; i < robotNum; ++i)
+    {
+        // 检查下一帧前往位置是否相同，移动机器人撞上静止机器人也在这种情况内
+        const int next = nextCell[i];
+        if (next == -1)
+            continue;
+        for (int j = nextPosLink[i]; j != -1; j = nextPosLink[j])
+            if (!bothInMainRoad(i, j))
+                collision.emplace_back(robots[i].id, robots[j].id, CollisionEvent::TargetOverlap);
+
+        // 检查是否互相前往对方当前所在地
+        if (next != currentCell[i])
+        {
+            int j = posOwner[next];
+            if (j > i && nextCell[j] == currentCell[i] && !bothInMainRoad(i, j))
+                collision.emplace_back(robots[i].id, robots[j].id, CollisionEvent::SwapPositions);
         }
+    }
 
-        // id 为最后一个时单独进行一次判断
-        if( i == robots.size()-1 &&
-            nextFrameSingleLaneID1 >=1 && 
-            currentSingleLaneID1 == 0 && 
-            singleLaneManager.isLocked(nextFrameSingleLaneID1, robot1.nextPos)){
-            // const SingleLaneLock& lock = singleLaneManager.getLock(nextFrameSingleLaneID);
-            CollisionEvent event(robot1.id, CollisionEvent::EntryAttemptWhileOccupied);
-            collision.insert(event);
+    // 检查机器人下一帧是否尝试同时相向进入单行道，同时从同一位置进入单行道已经被 TargetOverlap 排除
+    laneEntries.clear();
+    for (int i = 0; i < robotNum; ++i)
+        if (nextLane[i] >= 1 && currentLane[i] == 0 && singleLaneManager.isEnteringSingleLane(nextLane[i], robots[i].nextPos))
+            laneEntries.emplace_back(nextLane[i], i);
+    std::sort(laneEntries.begin(), laneEntries.end());
+    for (size_t a = 0; a < laneEntries.size(); ++a)
+    {
+        for (size_t b = a + 1; b < laneEntries.size() && laneEntries[b].first == laneEntries[a].first; ++b)
+        {
+            int i = laneEntries[a].second, j = laneEntries[b].second;
+            // 与逐对判断保持一致：编号小的机器人已经因进入加锁单行道产生事件时不再重复
+            if (lockedEntry[i] || bothInMainRoad(i, j) || nextCell[i] == nextCell[j] ||
+                (nextCell[i] == currentCell[j] && currentCell[i] == nextCell[j]))
+                continue;
+            collision.emplace_back(robots[i].id, robots[j].id, CollisionEvent::HeadOnAttempt);
         }
     }
+
+    for (int cell : touchedCells)
+    {
+        nextPosHead[cell] = -1;
+        posOwner[cell] = -1;
+    }
+
+    // 按优先级从低到高排序，同优先级按机器人编号，保证处理顺序稳定
+    std::sort(collision.begin(), collision.end(), [](const CollisionEvent &a, const CollisionEvent &b)
+              { return std::tie(a.type, a.robotId1, a.robotId2) < std::tie(b.type, b.robotId1, b.robotId2); });
     return collision;
 }
 
@@ -310,8 +387,8 @@ const Robot & RobotController::decideWhoWaits(const Robot &robot1, const Robot &
 void RobotController::decideWhoToWaitAndRefindWhenTargetOverlap(Map &map, Robot &robot1, Robot &robot2)
 {
     // 首先获取两个机器人周围可移动的位置
-    const std::vector<Point2d> robot1Neighbors = map.neighbors(robot1.pos);
-    const std::vector<Point2d> robot2Neighbors = map.neighbors(robot2.pos);
+    const NeighborList<Point2d, 4> robot1Neighbors = map.neighbors(robot1.pos);
+    const NeighborList<Point2d, 4> robot2Neighbors = map.neighbors(robot2.pos);
     LOGI("robo1 旁边空位: ", robot1Neighbors.size(), "; ", robot1);
     LOGI("robo2 旁边空位: ", robot2Neighbors.size(), "; ", robot2);
 
@@ -392,7 +469,7 @@ void RobotController::makeRobotWait(const Robot &robot)
         it->second.push_back(ResolutionAction::Wait);
     } else {
         // 如果没有找到，就创建一个新的向量，并添加解决方案
-        robotResolutionActions[robot.id] = std::vector<ResolutionAction>{ResolutionAction::Wait};
+        robotResolutionActions[robot.id].assign(1, ResolutionAction::Wait);
     }
 }
 void RobotController::makeRobotRefindPath(const Robot &robot)
@@ -403,7 +480,7 @@ void RobotController::makeRobotRefindPath(const Robot &robot)
         it->second.push_back(ResolutionAction::RefindPath);
     } else {
         // 如果没有找到，就创建一个新的向量，并添加解决方案
-        robotResolutionActions[robot.id] = std::vector<ResolutionAction>{ResolutionAction::RefindPath};
+        robotResolutionActions[robot.id].assign(1, ResolutionAction::RefindPath);
     }
 }
 void RobotController::makeRobotMoveToTempPos(const Robot &robot)
@@ -414,15 +491,15 @@ void RobotController::makeRobotMoveToTempPos(const Robot &robot)
         it->second.push_back(ResolutionAction::MoveAside);
     } else {
         // 如果没有找到，就创建一个新的向量，并添加解决方案
-        robotResolutionActions[robot.id] = std::vector<ResolutionAction>{ResolutionAction::MoveAside};
+        robotResolutionActions[robot.id].assign(1, ResolutionAction::MoveAside);
     }
 }
 
 
 void RobotController::resolveDeadlocks(Map &map, Robot &robot1, Robot &robot2)
 {
-    const std::vector<Point2d> robot1Neighbors = map.neighbors(robot1.pos);
-    const std::vector<Point2d> robot2Neighbors = map.neighbors(robot2.pos);
+    const NeighborList<Point2d, 4> robot1Neighbors = map.neighbors(robot1.pos);
+    const NeighborList<Point2d, 4> robot2Neighbors = map.neighbors(robot2.pos);
     LOGI("resolveDeadlocks");
     LOGI("robo1 旁边空位: ", robot1Neighbors.size(), " ",robot1);
     LOGI("robo2 旁边空位: ", robot2Neighbors.size(), " ", robot2);
@@ -447,8 +524,17 @@ void RobotController::resolveDeadlocks(Map &map, Robot &robot1, Robot &robot2)
 
 void RobotController::runPathfinding(const Map &map, Robot &robot)
 {
+    // 前往泊位时沿距离场下降，不行再完整寻路
+    bool found = (DistanceFieldFollowing && robot.status == MOVING_TO_BERTH && robot.followDistanceField(map, robot.targetid)) ||
+                 robot.findPath(map);
+    // 连续多帧超时说明目标太远，本帧也没有余量找到，与寻路失败一样放弃
+    if (found && robot.pathTimeouts >= RobotPathTimeoutLimit){
+        LOGW("机器人 ", robot.id, " 连续 ", robot.pathTimeouts, " 次寻路超时，放弃目标");
+        robot.pathTimeouts = 0;
+        found = false;
+    }
     // 寻路不成功，设置机器人状态
-    if (!robot.findPath(map)){
+    if (!found){
         robot.path = Path<Point2d>();
         robot.targetid = -1;
         robot.destination = Point2d(-1,-1);
@@ -461,6 +547,47 @@ void RobotController::runPathfinding(const Map &map, Robot &robot)
     }
 }
 
+void RobotController::runPathfindingBatch(const Map &map)
+{
+    pathfindingBatch.clear();
+    const int robotNum = robots.size();
+    if (robotNum == 0)
+        return;
+    pathfindingRotation = (pathfindingRotation + 1) % robotNum;
+    for (int k = 0; k < robotNum; ++k)
+    {
+        const int i = (pathfindingRotation + k) % robotNum;
+        if (robots[i].status != DEATH && needPathfinding(robots[i]))
+            pathfindingBatch.push_back(i);
+    }
+    const int batchSize = pathfindingBatch.size();
+    if (!pathfindingPool || batchSize < ParallelPathfindingMinBatch)
+    {
+        for (int index : pathfindingBatch)
+            runPathfinding(map, robots[index]);
+        return;
+    }
+    // 临时障碍物在寻路之后才加入，批内所有请求看到的是同一张地图，结果与串行寻路一致
+    // 搜索工作区是 thread_local 的，每个线程使用自己的一份；主线程也参与取任务
+    std::atomic<int> next{0};
+    auto worker = [this, &map, &next, batchSize]()
+    {
+        for (int i = next.fetch_add(1, std::memory_order_relaxed); i < batchSize; i = next.fetch_add(1, std::memory_order_relaxed))
+            runPathfinding(map, robots[pathfindingBatch[i]]);
+    };
+    const int helpers = std::min<int>(pathfindingPool->size(), batchSize - 1);
+    for (int i = 0; i < helpers; ++i)
+        pathfindingPool->submit(worker);
+    worker();
+    pathfindingPool->wait();
+}
+
+void RobotController::setSearchDeadline(std::chrono::steady_clock::time_point deadline)
+{
+    for (Robot &robot : robots)
+        robot.setSearchDeadline(deadline);
+}
+
 void RobotController::stopRobot(Robot &robot)
 {
     robot.nextPos = robot.pos;
@@ -525,3 +652,233 @@ void RobotController::updateTemporaryObstacles(Map &map)
         map.addTemporaryObstacle(robot.nextPos);
     }
 }
+
+void RobotController::runCooperativeController(Map &map, const SingleLaneManager &singleLaneManager)
+{
+    PROFILE_SCOPE(ROBOT_PATHFINDING);
+    const int robotNum = robots.size();
+    reservations.reset(map.rows, map.cols, ReservationHorizon);
+    if (goalDistanceFields.layers() == 0)
+        goalDistanceFields = DistanceTensor(map.rows, map.cols);
+    planned.assign(robotNum, 0);
+    cooperativeLaneEntries.clear();
+
+    // 先占住所有机器人的当前位置，没有移动计划的机器人占住整个窗口
+    planOrder.clear();
+    for (const Robot &robot : robots)
+    {
+        int cell = robot.pos.x * map.cols + robot.pos.y;
+        if (robot.status == DEATH || (robot.path.empty() && !needPathfinding(robot)))
+        {
+            reservations.reserveFrom(cell, 0, robot.id);
+            planned[robot.id] = 1;
+        }
+        else
+        {
+            reservations.reserve(cell, 0, robot.id);
+            planOrder.push_back(robot.id);
+        }
+    }
+
+    // 按优先级从高到低规划，优先级高的机器人先占用时空格子
+    std::sort(planOrder.begin(), planOrder.end(), [this](int a, int b)
+              { return robots[a].comparePriority(robots[b]); });
+    for (int id : planOrder)
+    {
+        Robot &robot = robots[id];
+        if (needPathfinding(robot) || !cooperativePlanValid(map, singleLaneManager, robot))
+        {
+            if (!planCooperativePath(map, singleLaneManager, robot))
+            {
+                // 窗口内找不到无冲突的路径，原地等待，下一帧重新规划
+                LOGI("协同寻路失败，原地等待: ", robot);
+                robot.path.clear();
+            }
+        }
+        reserveRobotPath(map, robot);
+        planned[id] = 1;
+
+        // 记录下一帧进入单行路的入口，防止其他机器人从另一端同时进入
+        if (!robot.path.empty())
+        {
+            const Point2d &next = robot.path.back();
+            int nextLaneId = singleLaneManager.getSingleLaneId(next);
+            if (nextLaneId >= 1 && singleLaneManager.getSingleLaneId(robot.pos) == 0 &&
+                singleLaneManager.isEnteringSingleLane(nextLaneId, next))
+                cooperativeLaneEntries.emplace_back(nextLaneId, next.x * map.cols + next.y);
+        }
+    }
+
+    for (Robot &robot : robots)
+        robot.updateNextPos();
+}
+
+bool RobotController::cooperativePlanValid(const Map &map, const SingleLaneManager &singleLaneManager, const Robot &robot)
+{
+    if (robot.path.empty())
+        return true;
+    const Point2d &first = robot.path.back();
+    // 机器人被撞开或者路径与当前位置不再相连
+    if (std::abs(first.x - robot.pos.x) + std::abs(first.y - robot.pos.y) > 1)
+        return false;
+    if (!cooperativeFirstStepAllowed(map, singleLaneManager, robot, first))
+        return false;
+
+    const int steps = std::min<int>(ReservationHorizon, robot.path.size());
+    Point2d prev = robot.pos;
+    for (int t = 1; t <= steps; ++t)
+    {
+        const Point2d &cur = robot.path[robot.path.size() - t];
+        bool curInMainRoad = map.isInMainRoad(cur);
+        if (!reservations.canMove(prev.x * map.cols + prev.y, cur.x * map.cols + cur.y, t, robot.id,
+                                  curInMainRoad, curInMainRoad && map.isInMainRoad(prev)))
+            return false;
+        prev = cur;
+    }
+    return true;
+}
+
+bool RobotController::cooperativeFirstStepAllowed(const Map &map, const SingleLaneManager &singleLaneManager, const Robot &robot, const Point2d &to)
+{
+    if (to == robot.pos)
+        return true;
+    int currentLaneId = singleLaneManager.getSingleLaneId(robot.pos);
+    int nextLaneId = singleLaneManager.getSingleLaneId(to);
+    int cell = to.x * map.cols + to.y;
+    if (nextLaneId >= 1 && currentLaneId == 0)
+    {
+        // 单行路已被占据
+        if (singleLaneManager.isLocked(nextLaneId, to))
+            return false;
+        // 已有机器人从另一端进入同一条单行路
+        if (singleLaneManager.isEnteringSingleLane(nextLaneId, to))
+            for (const auto &[laneId, entryCell] : cooperativeLaneEntries)
+                if (laneId == nextLaneId && entryCell != cell)
+                    return false;
+    }
+
+    // 目标格子上还没规划的机器人，只有在它准备离开并且不与本机器人对穿时才能跟进
+    int other = reservations.owner(cell, 0);
+    if (other != ReservationTable::FREE && other != robot.id && !planned[other] &&
+        !(map.isInMainRoad(to) && map.isInMainRoad(robot.pos)))
+    {
+        const Robot &occupant = robots[other];
+        if (occupant.path.empty() || occupant.path.back() == occupant.pos || occupant.path.back() == robot.pos)
+            return false;
+    }
+    return true;
+}
+
+bool RobotController::planCooperativePath(const Map &map, const SingleLaneManager &singleLaneManager, Robot &robot)
+{
+    if (!map.inBounds(robot.destination) || robot.pos == robot.destination)
+    {
+        robot.path.clear();
+        return true;
+    }
+    const uint16_t *field = getGoalDistanceField(map, robot);
+    const int cols = map.cols, cells = map.rows * map.cols, horizon = ReservationHorizon;
+    const int start = robot.pos.x * cols + robot.pos.y, goal = robot.destination.x * cols + robot.destination.y;
+    if (field[start] == DistanceTensor::UNREACHABLE)
+    {
+        // 终点不可达，与普通寻路失败的处理一致
+        robot.path = Path<Point2d>();
+        robot.targetid = -1;
+        robot.destination = Point2d(-1, -1);
+        LOGI("尋路失敗", robot);
+        return true;
+    }
+
+    // 状态为 (t, 格子)，每一步代价为 1（等待也是），启发式为精确的静态距离，f 相同时优先扩展 t 大的状态
+    GridSearchWorkspace &ws = cooperativeWorkspace;
+    ws.prepare(static_cast<size_t>(horizon + 1) * cells);
+    auto priority = [&](int t, int cell)
+    { return (t + field[cell]) * (horizon + 1) + (horizon - t); };
+    IndexedDaryHeap<4> &frontier = cooperativeFrontier;
+    frontier.reset(static_cast<size_t>(horizon + 1) * cells);
+    ws.visit(start, -1, 0);
+    frontier.put(start, priority(0, start));
+
+    int found = -1, expansions = 0;
+    while (!frontier.empty())
+    {
+        int state = frontier.get();
+        int t = state / cells, cell = state % cells;
+        if (cell == goal || t == horizon)
+        {
+            found = state;
+            break;
+        }
+        if (++expansions > CooperativeExpansionLimit)
+            break;
+        Point2d cur(cell / cols, cell % cols);
+        bool curInMainRoad = map.isInMainRoad(cur);
+        for (int k = 0; k <= 4; ++k)
+        {
+            Point2d next = k < 4 ? cur + Map::DIRS[k] : cur;
+            if (!map.inBounds(next) || !map.staticPassable(next))
+                continue;
+            int nextCell = next.x * cols + next.y;
+            int nextState = (t + 1) * cells + nextCell;
+            if (ws.visited(nextState) || field[nextCell] == DistanceTensor::UNREACHABLE)
+                continue;
+            if (t == 0 && !cooperativeFirstStepAllowed(map, singleLaneManager, robot, next))
+                continue;
+            bool nextInMainRoad = map.isInMainRoad(next);
+            if (!reservations.canMove(cell, nextCell, t + 1, robot.id, nextInMainRoad, nextInMainRoad && curInMainRoad))
+                continue;
+            ws.visit(nextState, state, t + 1);
+            frontier.put(nextState, priority(t + 1, nextCell));
+        }
+    }
+    if (found == -1)
+        return false;
+
+    // 路径倒序存储：先放窗口外沿距离场下降到终点的部分，再放窗口内的部分
+    windowCells.clear();
+    for (int cell = found % cells; field[cell] > 0;)
+    {
+        Point2d cur(cell / cols, cell % cols);
+        for (const Point2d &dir : Map::DIRS)
+        {
+            Point2d next = cur + dir;
+            if (map.inBounds(next) && field[next.x * cols + next.y] == field[cell] - 1)
+            {
+                cell = next.x * cols + next.y;
+                break;
+            }
+        }
+        windowCells.push_back(cell);
+    }
+    robot.path.clear();
+    for (auto it = windowCells.rbegin(); it != windowCells.rend(); ++it)
+        robot.path.emplace_back(*it / cols, *it % cols);
+    for (int state = found; ws.cameFrom[state] != -1; state = ws.cameFrom[state])
+        robot.path.emplace_back(state % cells / cols, state % cells % cols);
+    return true;
+}
+
+void RobotController::reserveRobotPath(const Map &map, const Robot &robot)
+{
+    Point2d cur = robot.pos;
+    const int size = robot.path.size();
+    for (int t = 1; t <= ReservationHorizon; ++t)
+    {
+        if (t <= size)
+            cur = robot.path[size - t];
+        reservations.reserve(cur.x * map.cols + cur.y, t, robot.id);
+    }
+}
+
+const uint16_t *RobotController::getGoalDistanceField(const Map &map, const Robot &robot)
+{
+    if (goalFieldTargets.size() <= static_cast<size_t>(robot.id))
+        goalFieldTargets.resize(robot.id + 1, Point2d(-1, -1));
+    uint16_t *field = goalDistanceFields.layer(robot.id);
+    if (goalFieldTargets[robot.id] != robot.destination)
+    {
+        map.computeLandDistanceField(robot.destination, field, fieldQueue);
+        goalFieldTargets[robot.id] = robot.destination;
+    }
+    return field;
+}
@@ -1,8 +1,18 @@
 #pragma once
-#include <set>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+#include <tuple>
+#include <algorithm>
+#include <memory>
 #include "robot.h"
 #include "utils.h"
 #include "singleLaneManager.h"
+#include "reservationTable.h"
+#include "pathFinder.h"
+#include "params.h"
+#include "threadPool.h"
+#include "frameArena.h"
 #include "log.h"
 
 class RobotController
@@ -30,13 +40,6 @@ public:
         }
     };
 
-    struct CollisionEventCompare {
-        // set 中使用
-        bool operator()(const CollisionEvent& lhs, const CollisionEvent& rhs) const {
-        return lhs.type < rhs.type;
-        }
-    };
-
     // 解决冲突方法
     struct ResolutionAction
     {
@@ -56,6 +59,8 @@ public:
 public:
     RobotController(std::vector<Robot> &robots) : robots(robots) {}
 
+    void setParameter(const Params &params);
+
     // 为所有需要寻路算法的机器人调用寻路算法
     // 更新所有机器人下一步位置
     // while
@@ -65,7 +70,24 @@ public:
     // 确定下一步所有机器人的行动
     void runController(Map &map, const SingleLaneManager &singleLaneManager);
 
+    // 检测机器人之间是否冲突，输出冲突的机器人 ID (对)，不考虑地图障碍物的情况
+    // 每对机器人最多一个事件，按冲突优先级从低到高排列
+    FrameVector<CollisionEvent> detectNextFrameConflict(const Map &map, const SingleLaneManager &singleLaneManager);
+
 private:
+    // 协同寻路模式：按优先级在时空预约表上依次规划，只有计划失效的机器人才重新规划，不再需要事后的冲突处理
+    void runCooperativeController(Map &map, const SingleLaneManager &singleLaneManager);
+    // 机器人现有路径在预约表上是否仍然有效
+    bool cooperativePlanValid(const Map &map, const SingleLaneManager &singleLaneManager, const Robot &robot);
+    // 在 horizon 帧窗口内做时空 A*，窗口外沿距离场走到终点，失败时返回 false
+    bool planCooperativePath(const Map &map, const SingleLaneManager &singleLaneManager, Robot &robot);
+    // 把机器人未来 horizon 帧的位置写入预约表
+    void reserveRobotPath(const Map &map, const Robot &robot);
+    // 下一帧从 from 移动到 to 是否合法：进入加锁的单行路、与未规划的机器人冲突、同时进入同一条单行路
+    bool cooperativeFirstStepAllowed(const Map &map, const SingleLaneManager &singleLaneManager, const Robot &robot, const Point2d &to);
+    // 机器人终点的距离场，终点不变时复用
+    const uint16_t *getGoalDistanceField(const Map &map, const Robot &robot);
+
     void reset(){
         robotResolutionActions.clear();
     }
@@ -75,8 +97,6 @@ private:
     bool needPathfinding(const Robot &robot);
 
 
-    // 检测机器人之间是否冲突，输出冲突的机器人 ID (对)，不考虑地图障碍物的情况
-    std::set<CollisionEvent, CollisionEventCompare> detectNextFrameConflict(const Map &map, const SingleLaneManager &singleLaneManager);
 
     // 尝试为所有机器人分配新状态解决冲突
     void tryResolveConflict(Map &map, const CollisionEvent &event);
@@ -103,6 +123,10 @@ private:
     Point2d moveAsideRobot(const Map &map, Robot &robot);
     // 让一个机器人寻路
     void runPathfinding(const Map &map, Robot &robot);
+    // 寻路阶段地图不变，各机器人只写自己的路径，需要寻路的机器人足够多时分给线程池并行
+    void runPathfindingBatch(const Map &map);
+    // 设置所有机器人之后寻路的截止时刻
+    void setSearchDeadline(std::chrono::steady_clock::time_point deadline);
 
 
     // 判断点是否在运行轨迹内
@@ -111,5 +135,45 @@ private:
     
 private:
     std::vector<Robot> &robots;
-    std::unordered_map<int, std::vector<ResolutionAction>> robotResolutionActions;
+    // 冲突处理动作每轮清空重建，节点内存由池资源回收复用
+    std::pmr::unsynchronized_pool_resource actionPool;
+    std::pmr::unordered_map<int, std::pmr::vector<ResolutionAction>> robotResolutionActions{&actionPool};
+
+    // 冲突检测的辅助数组，按格子索引，每次检测后只恢复用到的格子
+    std::vector<int> nextPosHead;  // 下一帧位于该格子的机器人链表头
+    std::vector<int> nextPosLink;  // 同一格子中的下一个机器人
+    std::vector<int> posOwner;     // 当前位于该格子的机器人
+    std::vector<int> touchedCells;
+    // 以下按机器人下标连续存放，每次检测开始时从 robots 中收集一次
+    std::vector<int> currentCell, nextCell; // 行主序格子编号，越界为 -1
+    std::vector<int> currentLane, nextLane;
+    std::vector<char> nextInMainRoad, lockedEntry;
+    std::vector<std::pair<int, int>> laneEntries; // (单行路 ID, 机器人下标)
+
+    // 前往泊位时沿距离场下降代替 A*，重新寻路时先局部修复原路径
+    bool DistanceFieldFollowing = true;
+    bool RobotPathRepair = true;
+    int RobotRepairWindow = 6;
+
+    // 批量并行寻路，单核或关闭时线程池为空
+    std::unique_ptr<ThreadPool> pathfindingPool;
+    int ParallelPathfindingMinBatch = 4;
+    std::vector<int> pathfindingBatch; // 本帧需要寻路的机器人下标
+    int pathfindingRotation = 0;       // 每帧轮换批内第一个寻路的机器人，超时时不总是同一批机器人拿不到时间
+    int RobotPathTimeoutLimit = 8;     // 连续超时这么多次后放弃目标，交给调度器重新分配
+
+    // 协同寻路
+    bool CooperativePathfinding = false;
+    int ReservationHorizon = 16;
+    int CooperativeExpansionLimit = 4000;
+    ReservationTable reservations;
+    GridSearchWorkspace cooperativeWorkspace;
+    IndexedDaryHeap<4> cooperativeFrontier;
+    DistanceTensor goalDistanceFields;       // 每个机器人一层，终点的距离场
+    std::vector<Point2d> goalFieldTargets;   // 每层距离场对应的终点
+    std::vector<int> fieldQueue;
+    std::vector<int> planOrder;
+    std::vector<char> planned;               // 本帧已经写入预约表的机器人
+    std::vector<std::pair<int, int>> cooperativeLaneEntries; // 本帧下一步进入单行路的 (单行路 ID, 进入点格子)
+    std::vector<int> windowCells;
 };
\ No newline at end of file
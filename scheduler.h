@@ -2,6 +2,7 @@
 #include <vector>
 #include <numeric>
 #include "goods.h"
+#include "goodsStore.h"
 #include "map.h"
 #include "robot.h"
 #include "ship.h"
@@ -12,6 +13,7 @@
 enum class SchedulerName
 {
     Greedy_ROBOT_SCHEDULER,
+    Auction_ROBOT_SCHEDULER,
     Greedy_SHIP_SCHEDULER,
     Final_SHIP_SCHEDULER
 };
@@ -25,7 +27,7 @@ public:
     virtual void
     scheduleRobots(const Map &map,
                    std::vector<Robot> &robots,
-                   std::vector<Goods> &goods,
+                   GoodsStore &goods,
                    std::vector<Berth> &berths,
                    const int currentFrame) = 0;
     // 设置参数，参数定义在子类里
@@ -48,7 +50,7 @@ public:
     scheduleShips(Map &map,
                   std::vector<Ship> &ships,
                   std::vector<Berth> &berths,
-                  std::vector<Goods> &goods,
+                  GoodsStore &goods,
                   std::vector<Robot> &robots) = 0;
     // 设置参数，参数定义在子类里
     virtual void setParameter(const Params &params) = 0;
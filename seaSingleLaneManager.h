@@ -3,11 +3,11 @@
 #include <vector>
 #include <array>
 #include <string>
+#include <algorithm>
 #include <unordered_map>
 #include "utils.h"
 #include "map.h"
 #include "robot.h"
-#include <unordered_set>
 
 struct SeaSingleLaneLock
 {
@@ -47,43 +47,29 @@ struct SeaSingleLaneLock
 class SeaSingleLaneManager {
 public:
     int rows, cols;
-    std::vector<std::vector<int>> singleLaneMap;    //  标记为单行路的id(从1开始)，标记0为正常水路，标记-1为障碍
-    std::unordered_map<int,SeaSingleLaneLock> singleLaneLocks;    // 维护每个单行路的锁，标记当前是否通行
-    std::unordered_map<int,std::vector<VectorPosition>> singleLanes;   //存储单行路的路径
+    GridBuffer<int> singleLaneMap;    //  标记为单行路的id(从1开始)，标记0为正常水路，标记-1为障碍
+    std::vector<SeaSingleLaneLock> singleLaneLocks;    // 按单行路 ID 连续存储的锁，下标 0 不使用
+    std::vector<std::vector<VectorPosition>> singleLanes;   //存储单行路的路径，下标为单行路 ID
 
-    std::vector<std::vector<MapItemSpace::MapItem>> grid;    //原地图
-    std::unordered_map<Direction,std::vector<std::vector<VisitType>>> visited; // 访问过的位置(分为x,y轴两个方向)
-
-    
+    std::array<GridBuffer<uint8_t>, 4> visited; // 查找单行路时每个朝向访问过的位置，查找结束后释放
 
     int nextSingleLaneId = 1;   // 单行路id，从1开始
 
     SeaSingleLaneManager(){}
 
     SeaSingleLaneManager(const Map& map){
-        this->rows = map.rows;
-        this->cols = map.cols;
-        this->grid = map.grid;
-        singleLaneMap = std::vector<std::vector<int>>(map.rows,std::vector<int>(map.cols,-1));
-        visited[Direction::EAST] = visited[Direction::WEST] = std::vector<std::vector<VisitType>>(map.rows,std::vector<VisitType>(map.cols,VisitType::UNVISITED));
-        visited[Direction::NORTH] = visited[Direction::SOUTH] = std::vector<std::vector<VisitType>>(map.rows,std::vector<VisitType>(map.cols,VisitType::UNVISITED));
-
-        // 找到所有单行路
-        findAllSingleLanes(map);
+        init(map);
     }
 
     // 每一帧遍历船的位置，初始化地图中单行路的锁情况
     void initSeaSingleLineLock(std::vector<Ship> &ships){
         // 重置所有单行路
-        for (auto & [laneId, singleLock] : singleLaneLocks)
+        for (SeaSingleLaneLock &singleLock : singleLaneLocks)
             singleLock.reset(); //重置单行路锁的情况
         for (auto &ship: ships){
-            // 获取船所在单行路的id
-            std::unordered_set<int> laneIds = getLaneIds(ship.locAndDir);
-            // 对所在单行路进行上锁
-            for (auto &laneId : laneIds){
+            // 对船所在单行路进行上锁
+            for (int laneId : getLaneIds(ship.locAndDir))
                 singleLaneLocks[laneId].lockLane(ship);
-            }
         }
     }
 
@@ -91,14 +77,9 @@ public:
     // 如果船不位于单行路内，返回true
     // 如果船位于单行路内，判断是否可以通行
     bool canEnterSingleLane(Ship &ship){
-        // 获取船所处的单行路id集合
-        std::unordered_set<int> laneIds = getLaneIds(ship.nextLocAndDir);
-        // 如果集合为空，表明船不位于单行路，返回true
-        if (laneIds.size() == 0) return true;
-        
-        // 遍历所处单行路（可能有多个），判断单行路是否被其他船上锁
-        for(auto &landId : laneIds){
-            bool flag = singleLaneLocks[landId].lockLane(ship);
+        // 遍历船所处的单行路（可能有多个），判断单行路是否被其他船上锁，不位于单行路时直接通行
+        for(int laneId : getLaneIds(ship.nextLocAndDir)){
+            bool flag = singleLaneLocks[laneId].lockLane(ship);
             // 上锁失败，不可通行
             if (!flag) 
                 return false;
@@ -106,32 +87,35 @@ public:
         return true;
     }
 
-    // 传入船的核心点位置，返回所处的单行路id
-    std::unordered_set<int> getLaneIds(VectorPosition &vecPos){
+    // 传入船的核心点位置，返回所处的单行路id（不重复），结果在下一次调用前有效
+    const std::vector<int> &getLaneIds(const VectorPosition &vecPos){
         std::pair<Point2d, Point2d> shipSpace = SpatialUtils::getShipOccupancyRect(vecPos);
-        std::unordered_set<int> laneIds;
-        
+        laneIds.clear();
         for (int x = shipSpace.first.x; x <= shipSpace.second.x; x++){
             for (int y = shipSpace.first.y; y <= shipSpace.second.y; y++){
-                if (singleLaneMap[x][y] > 0) laneIds.insert(singleLaneMap[x][y]);
+                int laneId = singleLaneMap[x][y];
+                if (laneId > 0 && std::find(laneIds.begin(), laneIds.end(), laneId) == laneIds.end())
+                    laneIds.push_back(laneId);
             }
         }
-
         return laneIds;
     }
 
     void init(const Map& map){
         this->rows = map.rows;
         this->cols = map.cols;
-        // 拷贝复制
-        this->grid = std::vector<std::vector<MapItemSpace::MapItem>>(map.grid);
-        singleLaneMap = std::vector<std::vector<int>>(map.rows,std::vector<int>(map.cols,-1));
-        visited[Direction::EAST] = visited[Direction::WEST] = std::vector<std::vector<VisitType>>(map.rows,std::vector<VisitType>(map.cols,VisitType::UNVISITED));
-        visited[Direction::NORTH] = visited[Direction::SOUTH] = std::vector<std::vector<VisitType>>(map.rows,std::vector<VisitType>(map.cols,VisitType::UNVISITED));
+        singleLaneMap = GridBuffer<int>(map.rows, map.cols, -1);
+        for (GridBuffer<uint8_t> &layer : visited)
+            layer = GridBuffer<uint8_t>(map.rows, map.cols, VisitType::UNVISITED);
+        singleLaneLocks.assign(1, SeaSingleLaneLock());
+        singleLanes.assign(1, std::vector<VectorPosition>());
+        nextSingleLaneId = 1;
         // 初始化地图
         initMap(map);
         // 找到所有单行路
         findAllSingleLanes(map);
+        for (GridBuffer<uint8_t> &layer : visited)
+            layer = GridBuffer<uint8_t>();
     }
 
     bool isValid(const Point2d& pos) { return pos.x >= 0 && pos.x < rows && pos.y >= 0 && pos.y < cols; }
@@ -206,7 +190,7 @@ public:
     // 是否属于单行路
     // 传入核心点，判断该路是否仅容纳一艘船通过
     int canAccommodateSingleShip(const Map &map, VectorPosition &vecPos){
-        // visited[vecPos.direction][vecPos.pos.x][vecPos.pos.y] = VisitType::VISITED;
+        // visited[static_cast<int>(vecPos.direction)][vecPos.pos.x][vecPos.pos.y] = VisitType::VISITED;
         // 判断当前位置是否可通行
         if (!canSeaPass(map, vecPos)) return false;
         
@@ -230,7 +214,7 @@ public:
             }
             // else LOGI("核心点偏移坐标：", corePoint.pos, "不可通行");
             // todo 缩小搜索空间
-            if(map.inBounds(corePoint.pos)) visited[vecPos.direction][corePoint.pos.x][corePoint.pos.y] = VisitType::VISITED;
+            if(map.inBounds(corePoint.pos)) visited[static_cast<int>(vecPos.direction)][corePoint.pos.x][corePoint.pos.y] = VisitType::VISITED;
         }
         // LOGI("通行数量：",num);
         if(num >= 2) return false;
@@ -240,8 +224,8 @@ public:
     // 只有两个障碍就是可以通行
     void findSingleLaneFromPoint(const Map &map, VectorPosition vecPos, std::vector<VectorPosition>& path,bool flag) {
         // 路到尽头了
-        if (!map.inBounds(vecPos.pos) || visited[vecPos.direction][vecPos.pos.x][vecPos.pos.y] == VisitType::VISITED) return;
-        visited[vecPos.direction][vecPos.pos.x][vecPos.pos.y] = VisitType::VISITED;
+        if (!map.inBounds(vecPos.pos) || visited[static_cast<int>(vecPos.direction)][vecPos.pos.x][vecPos.pos.y] == VisitType::VISITED) return;
+        visited[static_cast<int>(vecPos.direction)][vecPos.pos.x][vecPos.pos.y] = VisitType::VISITED;
         // 在主航道上
         if (map.isInSealane(vecPos.pos)) return;
         
@@ -260,7 +244,7 @@ public:
         SpatialUtils::clockwiseRotation(vecPos), SpatialUtils::anticlockwiseRotation(vecPos)};  // 前进一格、顺时针、逆时针，不考虑后退
 
         for (const auto& nextPos : nextSteps) {
-            if (map.inBounds(nextPos.pos) && canSeaPass(map, nextPos) && visited[nextPos.direction][nextPos.pos.x][nextPos.pos.y] == VisitType::UNVISITED) {
+            if (map.inBounds(nextPos.pos) && canSeaPass(map, nextPos) && visited[static_cast<int>(nextPos.direction)][nextPos.pos.x][nextPos.pos.y] == VisitType::UNVISITED) {
                 int temp_size = path.size();
                 findSingleLaneFromPoint(map, nextPos, path,flag);
                 if(temp_size != path.size()) flag = !flag;
@@ -344,21 +328,21 @@ public:
             for (int y = 0; y < cols; ++y) {
                 auto start = std::chrono::steady_clock::now();
                 for (auto &nowDirection : searchDirections){
-                if (canSeaPass(map, VectorPosition({x, y},Direction::EAST)) && visited[Direction::EAST][x][y] == VisitType::UNVISITED) {
+                if (canSeaPass(map, VectorPosition({x, y},Direction::EAST)) && visited[static_cast<int>(Direction::EAST)][x][y] == VisitType::UNVISITED) {
                     // LOGI("坐标：",x," ",y,",正在访问");
                     std::vector<VectorPosition> path;
                     findSingleLaneFromPoint(map, VectorPosition({x, y}, Direction::EAST), path,true);
                     // LOGI("路径长度：", path.size());
                     if (path.size() != 0) {
                         int laneId = nextSingleLaneId++;
-                        singleLanes[laneId] = path; // 保存找到的单行路路径
+                        singleLanes.push_back(path); // 保存找到的单行路路径
                         // singleLaneLocks[laneId] = SeaSingleLaneLock(path[0],path.back()); // 默认锁为解锁状态
                         // 对单行路地图进行标记
                         // LOGI("单行路", laneId,"-------------------");
                         markSingleLaneIdToMap(map, path, laneId);
 
                         // 获取单行路两边边界，并初始化锁
-                        singleLaneLocks[laneId] = SeaSingleLaneLock(getBorderPos(map, path.front()), getBorderPos(map, path.back()));
+                        singleLaneLocks.emplace_back(getBorderPos(map, path.front()), getBorderPos(map, path.back()));
                     }
                 }
                 auto end = std::chrono::steady_clock::now();
@@ -370,4 +354,6 @@ public:
         LOGI("寻找水路单行路循环完毕！");
     }   
 
+private:
+    std::vector<int> laneIds; // getLaneIds 的结果
 };
\ No newline at end of file
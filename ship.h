@@ -2,10 +2,13 @@
 
 #include <string>
 #include <mutex>
+#include <memory>
+#include <algorithm>
 #include "utils.h"
 #include "log.h"
 #include "map.h"
 #include "pathFinder.h"
+#include "bidirectionalAStar.h"
 #include "assert.h"
 
 namespace ShipStatusSpace{
@@ -18,6 +21,15 @@ namespace ShipStatusSpace{
     };
 }
 
+// 船舶下一帧的移动动作
+enum class ShipMoveType
+{
+    STAY,          // 不动
+    FORWARD,       // 前进
+    CLOCKWISE,     // 顺时针旋转
+    ANTICLOCKWISE  // 逆时针旋转
+};
+
 struct pair_hash
 {
     template <class T1, class T2>
@@ -29,16 +41,94 @@ struct pair_hash
     }
 };
 
+// 航线只读视图，指向 SeaRoute 内部存储，不拷贝路径
+struct SeaRouteView
+{
+    const VectorPosition *first = nullptr; // 路径起始地址，逆序存储，第一个元素是终点
+    size_t length = 0;                     // 路径长度
+    int cost = 0;                          // 考虑主航道减速的路径代价
+
+    inline bool empty() const { return length == 0; }
+    inline size_t size() const { return length; }
+    inline const VectorPosition *begin() const { return first; }
+    inline const VectorPosition *end() const { return first + length; }
+    inline const VectorPosition &operator[](size_t i) const { return first[i]; }
+};
+
+// 航线存储区，按块分配，已分配的路径地址在程序运行期间保持不变
+class SeaRouteArena
+{
+public:
+    const VectorPosition *store(const VectorPosition *path, size_t length)
+    {
+        if (blocks.empty() || blockUsed + length > blockCapacity)
+        {
+            blockCapacity = std::max(BLOCK_SIZE, length);
+            blocks.emplace_back(new VectorPosition[blockCapacity]);
+            blockUsed = 0;
+        }
+        VectorPosition *dst = blocks.back().get() + blockUsed;
+        std::copy(path, path + length, dst);
+        blockUsed += length;
+        return dst;
+    }
+
+private:
+    static constexpr size_t BLOCK_SIZE = 1 << 14;
+    std::vector<std::unique_ptr<VectorPosition[]>> blocks;
+    size_t blockCapacity = 0;
+    size_t blockUsed = 0;
+};
+
 class SeaRoute
 {
 private:
-    std::unordered_map<std::pair<VectorPosition, VectorPosition>, std::vector<VectorPosition>, pair_hash> seaRoutes;
-    AStarPathfinder<VectorPosition, Map> pathFinder;
+    using RouteKey = std::pair<VectorPosition, VectorPosition>; // 起点位姿，终点位姿
+    using CellKey = std::pair<VectorPosition, Point2d>;         // 起点位姿，终点坐标（不区分朝向）
+    // 航线按起点哈希分片存储，同一起点的精确索引和按终点坐标的索引位于同一分片
+    struct RouteShard
+    {
+        std::mutex mutex;
+        SeaRouteArena arena;
+        std::unordered_map<RouteKey, SeaRouteView, pair_hash> routes;
+        std::unordered_map<CellKey, std::pair<Direction, SeaRouteView>, pair_hash> cheapestRoutes; // 到达该坐标代价最小的朝向
+    };
+    static constexpr size_t SHARD_NUM = 16;
+    std::array<RouteShard, SHARD_NUM> shards;
+    BidirectionalAStarPathfinder<VectorPosition, Map> pathFinder;
 
     SeaRoute() {}
     SeaRoute(const SeaRoute &) = delete;
     SeaRoute &operator=(const SeaRoute &) = delete;
 
+    static RouteShard &getShard(const VectorPosition &start)
+    {
+        return getInstance().shards[std::hash<VectorPosition>{}(start) % SHARD_NUM];
+    }
+
+    // 在持有分片锁时存入一条航线，已存在时忽略
+    static void storeRoute(RouteShard &shard, const VectorPosition &start, const VectorPosition &destination,
+                           const VectorPosition *path, size_t length, int cost)
+    {
+        RouteKey key(start, destination);
+        if (shard.routes.find(key) != shard.routes.end())
+            return;
+        SeaRouteView view{shard.arena.store(path, length), length, cost};
+        shard.routes.emplace(key, view);
+        auto [it, inserted] = shard.cheapestRoutes.try_emplace(CellKey(start, destination.pos), destination.direction, view);
+        if (!inserted && cost < it->second.second.cost)
+            it->second = {destination.direction, view};
+    }
+
+    // 计算路径代价，处在主航道的一步代价为 2
+    static int computePathCost(const Map &map, const std::vector<VectorPosition> &path)
+    {
+        int cost = 0;
+        for (const auto &step : path)
+            cost += map.isShipInSeaLane(step) ? 2 : 1;
+        return cost;
+    }
+
 public:
     static SeaRoute &getInstance()
     {
@@ -49,18 +139,23 @@ public:
     // 寻路并存储
     static bool findPath(const Map &map, const VectorPosition &start, const VectorPosition &destination)
     {
-        static std::mutex seaRoutesMutex;
-        if (getInstance().seaRoutes.find(std::make_pair(start, destination)) !=
-            getInstance().seaRoutes.end())
-            return true;
+        RouteKey key(start, destination);
+        RouteShard &shard = getShard(start);
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (shard.routes.find(key) != shard.routes.end())
+                return true;
+        }
 
         // LOGI("Start: ",start," target: ", destination);
+        // 寻路和计算代价不持锁，每个线程使用各自的 A* 缓冲区
         std::variant<Path<VectorPosition>, PathfindingFailureReason> path = getInstance().pathFinder.findPath(start, destination, map);
         if (std::holds_alternative<Path<VectorPosition>>(path))
         {
-            Path<VectorPosition> route = std::get<Path<VectorPosition>>(path);
-            std::lock_guard<std::mutex> lock(seaRoutesMutex);
-            getInstance().seaRoutes[std::make_pair(start, destination)] = route;
+            const Path<VectorPosition> &route = std::get<Path<VectorPosition>>(path);
+            int cost = computePathCost(map, route);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            storeRoute(shard, start, destination, route.data(), route.size(), cost);
             return true;
         }
         else
@@ -71,51 +166,69 @@ public:
         }
     }
 
-    // 获取航线路径
-    static std::vector<VectorPosition> getPath(const Map &map, const VectorPosition &start, VectorPosition &destination)
+    // 直接存入一条已知的航线，用于从预计算文件恢复
+    static void insertRoute(const VectorPosition &start, const VectorPosition &destination,
+                            const VectorPosition *path, size_t length, int cost)
     {
-        // std::vector<VectorPosition> path;
-        // if (getInstance().seaRoutes.find(std::make_pair(start, destination)) !=
-        //     getInstance().seaRoutes.end())
-        //     path = getInstance().seaRoutes[std::make_pair(start, destination)];
-        // return path;
-        std::vector<VectorPosition> path;
-        if (getInstance().seaRoutes.find(std::make_pair(start, destination)) !=
-            getInstance().seaRoutes.end())
-            path = getInstance().seaRoutes[std::make_pair(start, destination)];
-        if (!path.empty()) return path;
-        std::vector<Direction> directions = std::vector<Direction>{Direction::EAST,  Direction::WEST, Direction::NORTH, Direction::SOUTH};
-        // todo 选取当前最短的路径
-        for(auto &direction : directions){
-            destination.direction = direction;
-            if (getInstance().seaRoutes.find(std::make_pair(start, destination)) !=
-            getInstance().seaRoutes.end())
-            path = getInstance().seaRoutes[std::make_pair(start, destination)];
-            if (!path.empty()) return path;
+        RouteShard &shard = getShard(start);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        storeRoute(shard, start, destination, path, length, cost);
+    }
+
+    // 清空航线索引，用于快照读取到一半失败后重新计算；存储区不回收，已取得的视图仍然有效
+    static void clear()
+    {
+        for (RouteShard &shard : getInstance().shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.routes.clear();
+            shard.cheapestRoutes.clear();
         }
-        return path;
     }
-    
-    // 获取航线长度
-    // 考虑主航道内的速度
-    static int getPathLength(Map &map, const VectorPosition &start, const VectorPosition &destination)
+
+    // 遍历所有航线，visit(起点, 终点, 航线)，用于保存预计算结果
+    template <typename Visitor>
+    static void forEachRoute(Visitor visit)
     {
-        int length = 0;
-        if (getInstance().seaRoutes.find(std::make_pair(start, destination)) !=
-            getInstance().seaRoutes.end()){
-                std::vector<VectorPosition> path = getInstance().seaRoutes[std::make_pair(start, destination)];
-                // 遍历路径，获取实际的路径代价
-                for (auto &step: path){
-                    if(map.isShipInSeaLane(step))
-                        length += 2;
-                    else
-                        length += 1;
-                }
-                // LOGI("路径长度:", path.size(), ",实际路径代价：", length);
-                // length = getInstance().seaRoutes[std::make_pair(start, destination)].size();
-            }
-            
-        return length;
+        for (RouteShard &shard : getInstance().shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const auto &[key, view] : shard.routes)
+                visit(key.first, key.second, view);
+        }
+    }
+
+    // 获取航线路径，终点朝向没有预存航线时，返回到达该坐标代价最小的航线，并修改 destination 的朝向
+    static SeaRouteView getPath(const VectorPosition &start, VectorPosition &destination)
+    {
+        RouteShard &shard = getShard(start);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.routes.find(RouteKey(start, destination));
+        if (it != shard.routes.end())
+            return it->second;
+        auto cheapest = shard.cheapestRoutes.find(CellKey(start, destination.pos));
+        if (cheapest == shard.cheapestRoutes.end())
+            return SeaRouteView();
+        destination.direction = cheapest->second.first;
+        return cheapest->second.second;
+    }
+
+    // 获取航线长度，考虑主航道内的速度，没有预存航线返回 0
+    static int getPathLength(const VectorPosition &start, const VectorPosition &destination)
+    {
+        RouteShard &shard = getShard(start);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.routes.find(RouteKey(start, destination));
+        return it == shard.routes.end() ? 0 : it->second.cost;
+    }
+
+    // 获取到达 destination 坐标的最短航线长度（任意朝向），没有预存航线返回 0
+    static int getPathLength(const VectorPosition &start, const Point2d &destination)
+    {
+        RouteShard &shard = getShard(start);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.cheapestRoutes.find(CellKey(start, destination));
+        return it == shard.cheapestRoutes.end() ? 0 : it->second.second.cost;
     }
 };
 
@@ -141,10 +254,11 @@ public:
 
 public:
     VectorPosition nextLocAndDir;     // 船舶下一帧位姿
+    // 以上为每帧都要读写的状态，以下的路径和寻路器只在移动和寻路时访问
     std::vector<VectorPosition> path; // 船舶运行路径
     int avoidNum = 0;                 //  避让的次数
 private:
-    AStarPathfinder<VectorPosition, Map> pathFinder;
+    GridAStarPathfinder<VectorPosition, Map> pathFinder;
 
 public:
     Ship(int id)
@@ -190,57 +304,6 @@ public:
         stillnessFrames = 0;
     }
 
-    //  购买船只
-    static std::string lboat(const Point2d &pos)
-    {
-        using namespace std::string_literals;
-        return "lboat "s + std::to_string(pos.x) + " "s + std::to_string(pos.y);
-    }
-
-    // 重置船只到主航道
-    std::string dept()
-    {
-        using namespace std::string_literals;
-#ifdef DEBUG
-        // 船不在恢复状态
-        assert(state != 1);
-#endif
-        return "dept "s + std::to_string(id);
-    }
-
-    // 尝试将对应船靠泊到泊位上，会导致船进入恢复状态。
-    std::string berth()
-    {
-        using namespace std::string_literals;
-#ifdef DEBUG
-        // 船不在恢复状态
-        assert(state != 1);
-#endif
-        return "berth "s + std::to_string(id);
-    }
-
-    // 旋转命令
-    std::string rot(RotationDirection rotDirection)
-    {
-        using namespace std::string_literals;
-#ifdef DEBUG
-        // 船在正常行驶状态
-        assert(state != 1);
-#endif
-        return "rot "s + std::to_string(id) + " " + std::to_string(static_cast<int>(rotDirection));
-    }
-
-    // 前进命令
-    std::string ship()
-    {
-        using namespace std::string_literals;
-#ifdef DEBUG
-        // 船在正常行驶状态
-        assert(state != 1);
-#endif
-        return "ship "s + std::to_string(id);
-    }
-
     // 装货,并返回转货的数量
     int loadGoods(int num)
     {
@@ -291,10 +354,10 @@ public:
     {
         LOGI("船舶寻路 from ", locAndDir, " to ", dst);
         destination = dst;
-        Path<VectorPosition> route = SeaRoute::getPath(map, locAndDir, destination);
+        SeaRouteView route = SeaRoute::getPath(locAndDir, destination);
         if(!route.empty())
         {
-            this->path = route;
+            this->path.assign(route.begin(), route.end());
             return true;
         }
         // 如果没有寻找到预先存储的路径，则需要调用寻路算法
@@ -420,29 +483,21 @@ public:
         nextLocAndDir = tempPos;
     }
 
-    // 移动到 nextLocAndDir
-    std::string movetoNextPosture()
+    // 移动到 nextLocAndDir 需要的动作
+    ShipMoveType nextMoveType() const
     {
         // LOGI("下一帧位置：", nextLocAndDir);
         if (nextLocAndDir == SpatialUtils::moveForward(locAndDir))
-        {
-            return ship();
-        }
+            return ShipMoveType::FORWARD;
         else if (nextLocAndDir == SpatialUtils::clockwiseRotation(locAndDir))
-        {
-            return rot(RotationDirection::Clockwise);
-        }
+            return ShipMoveType::CLOCKWISE;
         else if (nextLocAndDir == SpatialUtils::anticlockwiseRotation(locAndDir))
-        {
-            return rot(RotationDirection::AntiClockwise);
-        }
+            return ShipMoveType::ANTICLOCKWISE;
         else if (nextLocAndDir == locAndDir)
-        {
-            return "";
-        }
+            return ShipMoveType::STAY;
 
         LOGW("船舶路径出错 ship ", id, " from: ", locAndDir, " to ", nextLocAndDir);
-        return "";
+        return ShipMoveType::STAY;
     }
 
     // 判断是否到达目的地
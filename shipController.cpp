@@ -1,5 +1,6 @@
 #include "shipController.h"
 #include <unordered_set>
+#include "frameDeadline.h"
 
 // 控制船的整体调度
 void ShipController::runController(Map &map,std::vector<Ship> &ships, SeaSingleLaneManager &seaSingleLaneManager){
@@ -36,12 +37,18 @@ void ShipController::runController(Map &map,std::vector<Ship> &ships, SeaSingleL
     start = std::chrono::steady_clock::now();
     int tryTime = 0;
     // 尝试次数大于 0 就出错
+    // 设置船下一帧位置为障碍，只加入一次，之后由 rePlanShipMove 按动作增量更新
+    updateTemporaryObstacles(map, ships);
+    FrameDeadline &deadline = FrameDeadline::instance();
+    deadline.startStage(DeadlineStage::SHIP_CONFLICT);
     for(; tryTime <= 2; ++tryTime){
+        if (tryTime > 0 && deadline.expired(DeadlineStage::SHIP_CONFLICT)) {
+            LOGW("船舶冲突处理超时，第 ", tryTime, " 轮后停止");
+            break;
+        }
         reset();
-        // 设置船下一帧位置为障碍
-        updateTemporaryObstacles(map, ships);
         // 考虑下一步船的行动是否会冲突
-        std::set<CollisionEvent, CollisionEventCompare> collisions = detectNextFrameConflict(map, ships, seaSingleLaneManager);
+        FrameSet<CollisionEvent, CollisionEventCompare> collisions = detectNextFrameConflict(map, ships, seaSingleLaneManager);
         if(collisions.empty())
             break;
 
@@ -62,8 +69,6 @@ void ShipController::runController(Map &map,std::vector<Ship> &ships, SeaSingleL
 
         // 权衡船舶的规划，设置设定合理的指令
         rePlanShipMove(map, ships);
-
-        map.clearTemporaryObstacles();
         // 直至解决冲突
     }
 
@@ -138,7 +143,8 @@ void ShipController::tryResolveConflict(Map &map, std::vector<Ship> &ships, cons
             makeShipWait(ship1);
         }
         // 让优先级低的等待，优先级高的重新寻路
-        else if (ship1.comparePriority(map, ship2)){
+        // 两船已停了几帧说明优先的船绕不开（例如贴着岸边无法转向），交换角色让另一艘船绕行，不会一直互相等待
+        else if (ship1.comparePriority(map, ship2) != (std::max(ship1.stillnessFrames, ship2.stillnessFrames) >= STALL_SWAP_FRAMES)){
             // 船2优先级低
             LOGI("让船",ship1.id, "重新寻路", ship1);
             LOGI("，船", ship2.id, "等待", ship2);
@@ -176,10 +182,10 @@ void ShipController::tryResolveConflict(Map &map, std::vector<Ship> &ships, cons
 
 // 根据船的 ShipResolutionActions 权衡合理的规划逻辑
 void ShipController::rePlanShipMove(Map &map, std::vector<Ship> &ships){
-    std::vector<std::pair<int, ResolutionAction>> refindPathActions; // 存储需要重新寻路的动作及其船舶ID
+    FrameVector<std::pair<int, ResolutionAction>> refindPathActions(FrameArena::resource()); // 存储需要重新寻路的动作及其船舶ID
     // 排序
     for (auto& [key, value] : shipResolutionActions) {
-        std::vector<ResolutionAction>& actions = value;
+        auto &actions = value;
         std::sort(actions.begin(), actions.end(), [](const ResolutionAction& a, const ResolutionAction& b) {
             return a.method < b.method; // 直接根据枚举值的整数比较进行排序,小的优先级高
         });
@@ -237,9 +243,9 @@ void ShipController::updateTemporaryObstacles(Map &map, std::vector<Ship> &ships
 }
 
 // 检测船之间是否冲突，输出冲突的船 ID (对)，不考虑地图障碍物的情况
-std::set<ShipController::CollisionEvent, ShipController::CollisionEventCompare> 
+FrameSet<ShipController::CollisionEvent, ShipController::CollisionEventCompare>
 ShipController::detectNextFrameConflict(Map &map, std::vector<Ship> &ships, SeaSingleLaneManager &seaSingleLaneManager){
-    std::set<CollisionEvent, CollisionEventCompare> collision; // 使用 set 保证输出的机器人对不重复
+    FrameSet<CollisionEvent, CollisionEventCompare> collision(FrameArena::resource()); // 使用 set 保证输出的机器人对不重复
     for(size_t i = 0; i < ships.size(); ++i){
         Ship& ship1 = ships[i];
         // 检测水路单行路冲突
@@ -272,7 +278,7 @@ void ShipController::makeShipWait(const Ship &ship){
         it->second.push_back(ResolutionAction::Wait);
     } else {
         // 未找到则创建新的向量，并添加解决方案
-        shipResolutionActions[ship.id] = std::vector<ResolutionAction>{ResolutionAction::Wait};
+        shipResolutionActions[ship.id].assign(1, ResolutionAction::Wait);
     }
 }
 
@@ -283,7 +289,7 @@ void ShipController::makeShipRefindPath(const Ship &ship){
         it->second.push_back(ResolutionAction::RefindPath);
     } else {
         // 未找到则创建新的向量，并添加解决方案
-        shipResolutionActions[ship.id] = std::vector<ResolutionAction>{ResolutionAction::RefindPath};
+        shipResolutionActions[ship.id].assign(1, ResolutionAction::RefindPath);
     }
 }
 
@@ -294,7 +300,7 @@ void ShipController::makeShipDept(const Ship &ship){
         it->second.push_back(ResolutionAction::Dept);
     } else {
         // 未找到则创建新的向量，并添加解决方案
-        shipResolutionActions[ship.id] = std::vector<ResolutionAction>{ResolutionAction::Dept};
+        shipResolutionActions[ship.id].assign(1, ResolutionAction::Dept);
     }
 }
 
@@ -1,8 +1,11 @@
 #pragma once
+#include <memory_resource>
+#include <unordered_map>
 #include <set>
 #include "ship.h"
 #include "utils.h"
 #include "seaSingleLaneManager.h"
+#include "frameArena.h"
 #include "log.h"
 
 class ShipController
@@ -79,7 +82,7 @@ private:
 
 
     // 检测船之间是否冲突，输出冲突的船 ID (对)，不考虑地图障碍物的情况
-    std::set<CollisionEvent, CollisionEventCompare> detectNextFrameConflict(Map &map, std::vector<Ship> &ships, SeaSingleLaneManager &seaSingleLaneManager);
+    FrameSet<CollisionEvent, CollisionEventCompare> detectNextFrameConflict(Map &map, std::vector<Ship> &ships, SeaSingleLaneManager &seaSingleLaneManager);
 
     // 尝试为所有船分配新状态解决冲突
     void tryResolveConflict(Map &map, std::vector<Ship> &ships, const CollisionEvent &event);
@@ -141,5 +144,9 @@ private:
     
 private:
     // std::vector<Ship> &ships;
-    std::unordered_map<int, std::vector<ResolutionAction>> shipResolutionActions;
+    // 冲突处理动作每轮清空重建，节点内存由池资源回收复用
+    std::pmr::unsynchronized_pool_resource actionPool;
+    std::pmr::unordered_map<int, std::pmr::vector<ResolutionAction>> shipResolutionActions{&actionPool};
+    // 互相挡路的两船停了这么多帧后交换让行角色，需小于 SHIP_STILL_FRAMES_LIMIE，阻塞帧数超过它会被清零
+    static constexpr int STALL_SWAP_FRAMES = 3;
 };
\ No newline at end of file
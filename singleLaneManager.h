@@ -3,11 +3,13 @@
 #include <vector>
 #include <array>
 #include <string>
-#include <unordered_map>
+#include <atomic>
+#include <cstdint>
 #include "utils.h"
 #include "map.h"
 #include "robot.h"
 
+// 单行路的锁。两端是否加锁和路内机器人数量打包在一个原子变量里，同向的多个机器人可以同时在路内
 struct SingleLaneLock
 {
     Point2d startPos;
@@ -15,45 +17,53 @@ struct SingleLaneLock
     Point2d entrance;   //startPos往外扩展一格
     Point2d exit;   //endPos的往外扩展一格
 
-    bool startLock;
-    bool endLock;
-    int count;
-    SingleLaneLock(Point2d start,Point2d end):startPos(start),endPos(end),startLock(false),endLock(false),count(0){}
+    static constexpr uint32_t START_LOCK = 1; // startPos 一端加锁
+    static constexpr uint32_t END_LOCK = 2;   // endPos 一端加锁
+    static constexpr uint32_t COUNT_ONE = 4;  // 低两位之上为路内机器人数量
+    std::atomic<uint32_t> state{0};
+
+    SingleLaneLock(Point2d start,Point2d end):startPos(start),endPos(end){}
     SingleLaneLock(){}
+    SingleLaneLock(const SingleLaneLock &other)
+        : startPos(other.startPos), endPos(other.endPos), entrance(other.entrance), exit(other.exit),
+          state(other.state.load(std::memory_order_relaxed)) {}
+    SingleLaneLock &operator=(const SingleLaneLock &other)
+    {
+        startPos = other.startPos;
+        endPos = other.endPos;
+        entrance = other.entrance;
+        exit = other.exit;
+        state.store(other.state.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
 
     inline bool isDeadEnd() const {
         return endPos == Point2d(-1, -1);
     }
+    inline bool startLock() const { return state.load(std::memory_order_acquire) & START_LOCK; }
+    inline bool endLock() const { return state.load(std::memory_order_acquire) & END_LOCK; }
+    inline int count() const { return state.load(std::memory_order_acquire) / COUNT_ONE; }
 
     // 加锁函数，参数指明是从startPos进入还是从endPos进入
     void lock(bool fromStart) {
-        if (isDeadEnd()) {
-            // 对于死路，无论从哪个方向进入，都只锁定startLock
-            startLock = true;
-        }
-        // 给进入的另一端加锁
-        else {
-            if (fromStart)
-                endLock = true;
-            else
-                startLock = true;
-        }
-        count++; // 增加在单行道内的机器人数量
+        // 对于死路，无论从哪个方向进入，都只锁定startLock；否则给进入的另一端加锁
+        uint32_t bit = (isDeadEnd() || !fromStart) ? START_LOCK : END_LOCK;
+        uint32_t old = state.load(std::memory_order_relaxed);
+        // 增加在单行道内的机器人数量
+        while (!state.compare_exchange_weak(old, (old | bit) + COUNT_ONE, std::memory_order_acq_rel))
+            ;
     }
 
     // 释放锁函数，参数指明是从startPos退出还是从endPos退出
     void unlock(bool fromStart) {
-        count--; // 减少在单行道内的机器人数量
-        if (count == 0) { // 如果单行道为空，则解锁两端
-            startLock = false;
-            endLock = false;
-        }
-        else if (count < 0) {
-            startLock = false;
-            endLock = false;
+        uint32_t old = state.load(std::memory_order_relaxed), next;
+        do {
+            // 单行道为空时解锁两端
+            next = old / COUNT_ONE <= 1 ? 0 : old - COUNT_ONE;
+        } while (!state.compare_exchange_weak(old, next, std::memory_order_acq_rel));
+        if (old / COUNT_ONE == 0) {
             // 机器人可能就出生在单行道内
-            LOGE("错误的释放单行路锁, count: ", count);
-            count = 0;
+            LOGE("错误的释放单行路锁, count: ", -1);
         }
     }
 };
@@ -62,61 +72,65 @@ struct SingleLaneLock
 
 class SingleLaneManager {
 public:
-    int rows, cols;
-    std::vector<std::vector<int>> singleLaneMap;    //  标记为单行路的id(从1开始)，标记0为度大于2，标记-1为障碍
-    std::unordered_map<int,SingleLaneLock> singleLaneLocks;    // 维护每个单行路的锁，标记当前是否通行
-    std::unordered_map<int,std::vector<Point2d>> singleLanes;   //存储单行路的路径
+    // 格子在单行路上的端点标记
+    static constexpr uint8_t START_ENDPOINT = 1;
+    static constexpr uint8_t END_ENDPOINT = 2;
 
-    std::vector<std::vector<MapItemSpace::MapItem>> grid;    //原地图
-    std::vector<std::vector<VisitType>> visited; // 访问过的位置
+    int rows, cols;
+    GridBuffer<int> singleLaneMap;    //  标记为单行路的id(从1开始)，标记0为度大于2，标记-1为障碍
+    GridBuffer<uint8_t> laneEndpoints;   // 格子是否是所在单行路的 startPos / endPos
+    std::vector<SingleLaneLock> singleLaneLocks;    // 按单行路 ID 连续存储的锁，下标 0 不使用
+    std::vector<std::vector<Point2d>> singleLanes;   //存储单行路的路径，下标为单行路 ID
 
-    
+    GridBuffer<uint8_t> visited; // 查找单行路时访问过的位置，查找结束后释放
 
     int nextSingleLaneId = 1;   // 单行路的路径
 
     SingleLaneManager(){}
 
     SingleLaneManager(const Map& map){
-        this->rows = map.rows;
-        this->cols = map.cols;
-        this->grid = map.grid;
-        singleLaneMap = std::vector<std::vector<int>>(map.rows,std::vector<int>(map.cols,-1));
-        visited = std::vector<std::vector<VisitType>>(map.rows,std::vector<VisitType>(map.cols,VisitType::UNVISITED));
+        init(map);
+    }
 
-        // 找到所有单行路
-        findAllSingleLanes(map);
+    inline bool isValidLaneId(int laneId) const {
+        return laneId >= 1 && laneId < static_cast<int>(singleLaneLocks.size());
+    }
+
+    // 返回 entryPoint 作为 laneId 的端点标记，不是端点返回 0
+    inline uint8_t getEndpoint(int laneId, const Point2d& entryPoint) const {
+        if (getSingleLaneId(entryPoint) != laneId)
+            return 0;
+        return laneEndpoints[entryPoint.x][entryPoint.y];
     }
 
     void lock(int laneId, const Point2d& entryPoint) {
-        if (singleLaneLocks.find(laneId) != singleLaneLocks.end()) {
-            SingleLaneLock& lock = singleLaneLocks.at(laneId);
-            // 不对死路进行特殊处理
-            if (entryPoint == lock.startPos)
-                lock.lock(true);
-            else if (entryPoint == lock.endPos)
-                lock.lock(false);
-            else
-                LOGW("传入错误的加锁位置, pos: ", entryPoint);
-        }
-        else {
+        if (!isValidLaneId(laneId)) {
             LOGE("尝试从singleLaneLocks获取不存在的锁的情况 laneId: ", laneId);
+            return;
         }
+        // 不对死路进行特殊处理
+        uint8_t endpoint = getEndpoint(laneId, entryPoint);
+        if (endpoint & START_ENDPOINT)
+            singleLaneLocks[laneId].lock(true);
+        else if (endpoint & END_ENDPOINT)
+            singleLaneLocks[laneId].lock(false);
+        else
+            LOGW("传入错误的加锁位置, pos: ", entryPoint);
     }
 
     void unlock(int laneId, const Point2d& entryPoint) {
-        if (singleLaneLocks.find(laneId) != singleLaneLocks.end()) {
-            SingleLaneLock& lock = singleLaneLocks.at(laneId);
-            // 不对死路进行特殊处理
-            if (entryPoint == lock.startPos)
-                lock.unlock(true);
-            else if (entryPoint == lock.endPos)
-                lock.unlock(false);
-            else
-                LOGW("传入错误的解锁位置, pos: ", entryPoint);
-        }
-        else {
+        if (!isValidLaneId(laneId)) {
             LOGE("尝试从singleLaneLocks获取不存在的锁的情况 laneId: ", laneId);
+            return;
         }
+        // 不对死路进行特殊处理
+        uint8_t endpoint = getEndpoint(laneId, entryPoint);
+        if (endpoint & START_ENDPOINT)
+            singleLaneLocks[laneId].unlock(true);
+        else if (endpoint & END_ENDPOINT)
+            singleLaneLocks[laneId].unlock(false);
+        else
+            LOGW("传入错误的解锁位置, pos: ", entryPoint);
     }
 
     inline int getSingleLaneId(const Point2d& point) const {
@@ -127,38 +141,23 @@ public:
     }
 
     // 根据提供的位置，判断是否在单行道的入口处
-    bool isEnteringSingleLane(int laneId, const Point2d& entryPoint) const {
-        if (singleLaneLocks.find(laneId) != singleLaneLocks.end()) {
-            const SingleLaneLock& lock = singleLaneLocks.at(laneId);
-            // 不对死路进行特殊处理
-            if(entryPoint == lock.startPos || entryPoint == lock.endPos)
-                return true;
-        }
-        else {
-            LOGE("尝试从singleLaneLocks获取不存在的锁的情况 laneId: ", laneId);
-        }
-        return false;
+    inline bool isEnteringSingleLane(int laneId, const Point2d& entryPoint) const {
+        // 不对死路进行特殊处理
+        return getEndpoint(laneId, entryPoint) != 0;
     }
     // 提供单行路的进入点，检查单行路是否被锁定
-    bool isLocked(int laneId, const Point2d& entryPoint) const {
-        if (singleLaneLocks.find(laneId) != singleLaneLocks.end()) {
-            const SingleLaneLock& lock = singleLaneLocks.at(laneId);
-            if (lock.isDeadEnd()) {
-                // 对于死路，只检查startLock
-                return lock.startLock;
-            } 
-            else {
-                // 检查进入方向是否被加锁
-                if (lock.startPos == entryPoint && lock.startLock)
-                    return true;
-                if (lock.endPos == entryPoint && lock.endLock)
-                    return true;
-            }
-        }
-        else {
-            LOGE("尝试从singleLaneLocks获取不存在的锁的情况 laneId: ", laneId);
-        }
-        return false;
+    inline bool isLocked(int laneId, const Point2d& entryPoint) const {
+        if (!isValidLaneId(laneId))
+            return false;
+        const SingleLaneLock& lock = singleLaneLocks[laneId];
+        uint32_t state = lock.state.load(std::memory_order_acquire);
+        // 对于死路，只检查startLock
+        if (lock.isDeadEnd())
+            return state & SingleLaneLock::START_LOCK;
+        // 检查进入方向是否被加锁
+        uint8_t endpoint = getEndpoint(laneId, entryPoint);
+        return ((endpoint & START_ENDPOINT) && (state & SingleLaneLock::START_LOCK)) ||
+               ((endpoint & END_ENDPOINT) && (state & SingleLaneLock::END_LOCK));
     }
 
     SingleLaneLock& getLock(int laneId) {
@@ -168,17 +167,28 @@ public:
     void init(const Map& map){
         this->rows = map.rows;
         this->cols = map.cols;
-        // 拷贝复制
-        this->grid = std::vector<std::vector<MapItemSpace::MapItem>>(map.grid);
-        singleLaneMap = std::vector<std::vector<int>>(map.rows,std::vector<int>(map.cols,-1));
-        visited = std::vector<std::vector<VisitType>>(map.rows,std::vector<VisitType>(map.cols,VisitType::UNVISITED));
+        singleLaneMap = GridBuffer<int>(map.rows, map.cols, -1);
+        visited = GridBuffer<uint8_t>(map.rows, map.cols, VisitType::UNVISITED);
+        singleLaneLocks.assign(1, SingleLaneLock());
+        singleLanes.assign(1, std::vector<Point2d>());
+        nextSingleLaneId = 1;
         // 初始化地图
         initMap(map);
         // 找到所有单行路
         findAllSingleLanes(map);
+        // 预先标记每条单行路的端点
+        laneEndpoints = GridBuffer<uint8_t>(map.rows, map.cols, 0);
+        for (int laneId = 1; laneId < static_cast<int>(singleLaneLocks.size()); ++laneId) {
+            const SingleLaneLock& lock = singleLaneLocks[laneId];
+            if (isValid(lock.startPos))
+                laneEndpoints[lock.startPos.x][lock.startPos.y] |= START_ENDPOINT;
+            if (isValid(lock.endPos))
+                laneEndpoints[lock.endPos.x][lock.endPos.y] |= END_ENDPOINT;
+        }
+        visited = GridBuffer<uint8_t>();
     }
 
-    bool isValid(const Point2d& pos) { return pos.x >= 0 && pos.x < rows && pos.y >= 0 && pos.y < cols; }
+    bool isValid(const Point2d& pos) const { return pos.x >= 0 && pos.x < rows && pos.y >= 0 && pos.y < cols; }
 
     bool canPass(const Map &map, const Point2d& pos) {
         // return grid[pos.x][pos.y] == MapItemSpace::MapItem::SPACE || grid[pos.x][pos.y] == MapItemSpace::MapItem::BERTH;
@@ -329,8 +339,8 @@ public:
                     if(path.size() == 1){
                         if(!isCorner(path[0]) && countObstacle(map, path[0]) == 2){
                             int laneId = nextSingleLaneId++;
-                            singleLanes[laneId] = path; // 保存找到的单行路路径
-                            singleLaneLocks[laneId] = SingleLaneLock(path[0],path.back()); // 默认锁为解锁状态
+                            singleLanes.push_back(path); // 保存找到的单行路路径
+                            singleLaneLocks.emplace_back(path[0],path.back()); // 默认锁为解锁状态
                             // 对单行路地图进行标记
                             for(auto& point : path){
                                 singleLaneMap[point.x][point.y] = laneId;
@@ -345,8 +355,8 @@ public:
                             continue;
                         }
                         int laneId = nextSingleLaneId++;
-                        singleLanes[laneId] = path; // 保存找到的单行路路径
-                        singleLaneLocks[laneId] = SingleLaneLock(path[0],path.back()); // 默认锁为解锁状态
+                        singleLanes.push_back(path); // 保存找到的单行路路径
+                        singleLaneLocks.emplace_back(path[0],path.back()); // 默认锁为解锁状态
                         // 对单行路地图进行标记
                         for(auto& point : path){
                             singleLaneMap[point.x][point.y] = laneId;
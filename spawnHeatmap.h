@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include "utils.h"
+#include "decayedCounter.h"
+
+// 货物生成热力图：地图按 tileSize * tileSize 划分为粗粒度区域，每个区域记录按半衰期衰减的生成数量和价值
+// 每次生成 O(1) 更新，读取区域的近期价值速率也是 O(1)，用于预测之后哪里会出现货物
+class SpawnHeatmap
+{
+public:
+    struct Tile
+    {
+        DecayedCounter spawned;             // 区域内生成的货物
+        Point2d lastSpawn = Point2d(-1, -1); // 最近一次生成的位置，一定是能到达泊位的陆地，作为区域的代表点
+        BerthID nearestBerth = -1;           // 最近一次生成的货物的最近泊位
+    };
+
+    // tileSize 不为正时不记录
+    void init(int rows, int cols, int tileSize)
+    {
+        this->tileSize = tileSize;
+        if (tileSize <= 0)
+            return;
+        tileRows = (rows + tileSize - 1) / tileSize;
+        tileCols = (cols + tileSize - 1) / tileSize;
+        tiles.assign(tileRows * tileCols, Tile());
+    }
+
+    // 记录一次货物生成，没有可达泊位的货物不会被搬运，不记录
+    void add(const Point2d &pos, int frame, int value, BerthID nearestBerth)
+    {
+        if (tiles.empty() || nearestBerth < 0)
+            return;
+        Tile &tile = tiles[tileOf(pos)];
+        tile.spawned.add(frame, value);
+        tile.lastSpawn = pos;
+        tile.nearestBerth = nearestBerth;
+    }
+
+    inline bool enabled() const { return !tiles.empty(); }
+    inline int tileOf(const Point2d &pos) const { return pos.x / tileSize * tileCols + pos.y / tileSize; }
+    inline int size() const { return static_cast<int>(tiles.size()); }
+    inline const Tile &operator[](int index) const { return tiles[index]; }
+
+private:
+    int tileSize = 0;
+    int tileRows = 0, tileCols = 0;
+    std::vector<Tile> tiles; // 按行优先存储
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+
+// 固定线程数的线程池，线程数默认与硬件并发数一致，避免为每个任务创建线程
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t threadNum = std::thread::hardware_concurrency())
+    {
+        threadNum = std::max<size_t>(1, threadNum);
+        workers.reserve(threadNum);
+        for (size_t i = 0; i < threadNum; ++i)
+            workers.emplace_back([this]()
+                                 { workerLoop(); });
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        taskCondition.notify_all();
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // 提交一个任务
+    void submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push(std::move(task));
+            ++pendingTasks;
+        }
+        taskCondition.notify_one();
+    }
+
+    // 阻塞直到所有已提交的任务执行完毕
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        doneCondition.wait(lock, [this]()
+                           { return pendingTasks == 0; });
+    }
+
+    size_t size() const { return workers.size(); }
+
+private:
+    void workerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                taskCondition.wait(lock, [this]()
+                                   { return stopping || !tasks.empty(); });
+                if (tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--pendingTasks == 0)
+                    doneCondition.notify_all();
+            }
+        }
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskCondition; // 有新任务或线程池关闭
+    std::condition_variable doneCondition; // 所有任务完成
+    size_t pendingTasks = 0;               // 已提交但未执行完的任务数
+    bool stopping = false;
+};
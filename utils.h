@@ -5,6 +5,8 @@
 #include <unordered_map>
 #include <vector>
 #include <climits>
+#include <utility>
+#include <array>
 
 #define DEBUG
 
@@ -193,72 +195,130 @@ namespace std
 class SpatialUtils
 {
 public:
-    // 给定船的核心点和朝向，返回该船舶占用空间的矩形的左上角和右下角坐标，船舶大小为2*3
+    // 格子偏移，constexpr 查表用
+    struct Offset
+    {
+        int dx, dy;
+    };
+    // 船体矩形相对核心点的左上角和右下角偏移，船舶大小为2*3
+    struct RectOffset
+    {
+        Offset topLeft, bottomRight;
+    };
+    static constexpr int SHIP_CELLS = 6;
+
+    // 核心点坐标和朝向到船占据的矩形的映射表，按 Direction 下标
+    static constexpr std::array<RectOffset, 4> SHIP_RECT = {{
+        {{0, 0}, {1, 2}},   // EAST: 左上角偏移(0,0)，右下角偏移(1,2)
+        {{-1, -2}, {0, 0}}, // WEST: 左上角偏移(-1,-2)，右下角偏移(0,0)
+        {{-2, 0}, {0, 1}},  // NORTH: 左上角偏移(-2,0)，右下角偏移(0,1)
+        {{0, -1}, {2, 0}}   // SOUTH: 左上角偏移(0,-1)，右下角偏移(2,0)
+    }};
+
+    // 船体占据的 6 个格子相对核心点的偏移，由 SHIP_RECT 展开
+    static constexpr std::array<std::array<Offset, SHIP_CELLS>, 4> SHIP_FOOTPRINT = []()
+    {
+        std::array<std::array<Offset, SHIP_CELLS>, 4> table{};
+        for (int d = 0; d < 4; ++d)
+        {
+            int k = 0;
+            for (int dx = SHIP_RECT[d].topLeft.dx; dx <= SHIP_RECT[d].bottomRight.dx; ++dx)
+                for (int dy = SHIP_RECT[d].topLeft.dy; dy <= SHIP_RECT[d].bottomRight.dy; ++dy)
+                    table[d][k++] = {dx, dy};
+        }
+        return table;
+    }();
+
+    // 前进一格后核心点的偏移
+    static constexpr std::array<Offset, 4> FORWARD_STEP = {{
+        {0, 1},  // 右
+        {0, -1}, // 左
+        {-1, 0}, // 上
+        {1, 0}   // 下
+    }};
+
+    // 逆时针旋转一次后的方向
+    static constexpr std::array<Direction, 4> ANTICLOCKWISE_DIRECTION = {
+        Direction::NORTH, // 右旋转到上
+        Direction::SOUTH, // 左旋转到下
+        Direction::WEST,  // 上旋转到左
+        Direction::EAST   // 下旋转到右
+    };
+    // 逆时针旋转一次后核心点的偏移
+    static constexpr std::array<Offset, 4> ANTICLOCKWISE_PIVOT = {{
+        {1, 1},   // 右
+        {-1, -1}, // 左
+        {-1, 1},  // 上
+        {1, -1}   // 下
+    }};
+
+    // 顺时针旋转一次后的方向
+    static constexpr std::array<Direction, 4> CLOCKWISE_DIRECTION = {
+        Direction::SOUTH, // 右旋转到下
+        Direction::NORTH, // 左旋转到上
+        Direction::EAST,  // 上旋转到右
+        Direction::WEST   // 下旋转到左
+    };
+    // 顺时针旋转一次后核心点的偏移
+    static constexpr std::array<Offset, 4> CLOCKWISE_PIVOT = {{
+        {0, 2},  // 右
+        {0, -2}, // 左
+        {-2, 0}, // 上
+        {2, 0}   // 下
+    }};
+
+    // 给定船的核心点和朝向，返回该船舶占用空间的矩形的左上角和右下角坐标
     static std::pair<Point2d, Point2d> getShipOccupancyRect(const VectorPosition &e)
     {
-        // 核心点坐标和朝向到船占据的矩形的映射表
-        static const std::array<std::pair<Point2d, Point2d>, 4> occupancyOffsetTable = {
-            {{{0, 0}, {1, 2}},   // EAST: 左上角偏移(0,0)，右下角偏移(1,2)
-             {{-1, -2}, {0, 0}}, // WEST: 左上角偏移(-1,-2)，右下角偏移(0,0)
-             {{-2, 0}, {0, 1}},  // NORTH: 左上角偏移(-2,0)，右下角偏移(0,1)
-             {{0, -1}, {2, 0}}}  // SOUTH: 左上角偏移(0,-1)，右下角偏移(2,0)
-        };
-        const auto &offsets = occupancyOffsetTable[static_cast<int>(e.direction)];
-        Point2d topLeft = {e.pos.x + offsets.first.x, e.pos.y + offsets.first.y};
-        Point2d bottomRight = {e.pos.x + offsets.second.x, e.pos.y + offsets.second.y};
+        const RectOffset &offsets = SHIP_RECT[static_cast<int>(e.direction)];
+        Point2d topLeft = {e.pos.x + offsets.topLeft.dx, e.pos.y + offsets.topLeft.dy};
+        Point2d bottomRight = {e.pos.x + offsets.bottomRight.dx, e.pos.y + offsets.bottomRight.dy};
         return {topLeft, bottomRight};
     }
     // 返回前进一格后的核心点位置和方向
-    static VectorPosition moveForward(const VectorPosition &vp)
-    {
-        // 前进一格后的位置
-        static const std::array<Point2d, 4> moveOneStep = {{
-            {0, 1},  // 右
-            {0, -1}, // 左
-            {-1, 0}, // 上
-            {1, 0}   // 下
-        }};
-        return {vp.pos + moveOneStep[static_cast<int>(vp.direction)], vp.direction};
+    static inline VectorPosition moveForward(const VectorPosition &vp)
+    {
+        const Offset &step = FORWARD_STEP[static_cast<int>(vp.direction)];
+        return {vp.pos.x + step.dx, vp.pos.y + step.dy, vp.direction};
     }
 
     // 返回逆时针旋转一次后的核心点位置和方向
-    static VectorPosition anticlockwiseRotation(const VectorPosition &vp)
-    {
-        // 逆时针旋转一次后的方向
-        static const std::array<Direction, 4> directionChange = {
-            Direction::NORTH, // 右旋转到上
-            Direction::SOUTH, // 左旋转到下
-            Direction::WEST,  // 上旋转到左
-            Direction::EAST   // 下旋转到右
-        };
-        // 逆时针旋转一次后核心点的位置
-        static const std::array<Point2d, 4> corePositionChange = {{
-            {1, 1},   // 右
-            {-1, -1}, // 左
-            {-1, 1},  // 上
-            {1, -1}   // 下
-        }};
-        return {vp.pos + corePositionChange[static_cast<int>(vp.direction)], directionChange[static_cast<int>(vp.direction)]};
+    static inline VectorPosition anticlockwiseRotation(const VectorPosition &vp)
+    {
+        const int d = static_cast<int>(vp.direction);
+        const Offset &pivot = ANTICLOCKWISE_PIVOT[d];
+        return {vp.pos.x + pivot.dx, vp.pos.y + pivot.dy, ANTICLOCKWISE_DIRECTION[d]};
     }
 
     // 返回顺时针旋转一次后的核心点位置和方向
     static inline VectorPosition clockwiseRotation(const VectorPosition &vp)
     {
-        // 顺时针旋转一次后的方向
-        static const std::array<Direction, 4> directionChange = {
-            Direction::SOUTH, // 右旋转到下
-            Direction::NORTH, // 左旋转到上
-            Direction::EAST,  // 上旋转到右
-            Direction::WEST   // 下旋转到左
-        };
-        // 顺时针旋转一次后核心点的位置
-        static const std::array<Point2d, 4> corePositionChange = {{
-            {0, 2},  // 右
-            {0, -2}, // 左
-            {-2, 0}, // 上
-            {2, 0}   // 下
-        }};
-        return {vp.pos + corePositionChange[static_cast<int>(vp.direction)], directionChange[static_cast<int>(vp.direction)]};
+        const int d = static_cast<int>(vp.direction);
+        const Offset &pivot = CLOCKWISE_PIVOT[d];
+        return {vp.pos.x + pivot.dx, vp.pos.y + pivot.dy, CLOCKWISE_DIRECTION[d]};
+    }
+
+    // 以下为上面三种动作的逆动作，返回执行该动作后到达 vp 的位姿，用于反向搜索
+    static inline VectorPosition moveBackward(const VectorPosition &vp)
+    {
+        const Offset &step = FORWARD_STEP[static_cast<int>(vp.direction)];
+        return {vp.pos.x - step.dx, vp.pos.y - step.dy, vp.direction};
+    }
+
+    // 逆时针旋转前的位姿，旋转前的朝向就是 vp 顺时针转一次的朝向
+    static inline VectorPosition anticlockwiseRotationInverse(const VectorPosition &vp)
+    {
+        const Direction from = CLOCKWISE_DIRECTION[static_cast<int>(vp.direction)];
+        const Offset &pivot = ANTICLOCKWISE_PIVOT[static_cast<int>(from)];
+        return {vp.pos.x - pivot.dx, vp.pos.y - pivot.dy, from};
+    }
+
+    // 顺时针旋转前的位姿
+    static inline VectorPosition clockwiseRotationInverse(const VectorPosition &vp)
+    {
+        const Direction from = ANTICLOCKWISE_DIRECTION[static_cast<int>(vp.direction)];
+        const Offset &pivot = CLOCKWISE_PIVOT[static_cast<int>(from)];
+        return {vp.pos.x - pivot.dx, vp.pos.y - pivot.dy, from};
     }
 
 };